@@ -0,0 +1,34 @@
+/***************************************************************
+ *
+ * (c) 2009-2010 Markus Dittrich 
+ *
+ * This program is free software; you can redistribute it 
+ * and/or modify it under the terms of the GNU General Public 
+ * License Version 3 as published by the Free Software Foundation. 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License Version 3 for more details.
+ *
+ * You should have received a copy of the GNU General Public 
+ * License along with this program; if not, write to the Free 
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, 
+ * Boston, MA 02111-1307, USA.
+ *
+ ****************************************************************/
+
+/****************************************************************
+ * paths used by the unit tests; these point into the source
+ * tree so the tests run without installing sconcho first
+ ****************************************************************/
+
+#ifndef TEST_CONFIG_H
+#define TEST_CONFIG_H
+
+#define TEST_SYMBOL_PATH QString("@CMAKE_SOURCE_DIR@/symbols")
+#define TEST_FILE_PATH QString("@CMAKE_SOURCE_DIR@/test/test_files")
+#define LEGACY_TEST_FILE_PATH QString("@CMAKE_SOURCE_DIR@/../test/test_files")
+
+
+#endif
@@ -57,10 +57,42 @@ const int PATTERN_KEY_CANVAS_TYPE = 4;
 const int KNITTING_PATTERN_ITEM_TYPE = 5;
 const int LEGEND_LABEL_TYPE = 6;
 const int LEGEND_ITEM_TYPE = 7;
+const int CHART_GRID_ITEM_TYPE = 8;
+const int CHART_SELECTION_ITEM_TYPE = 9;
 
 /* the size (in pixels) of a grid cell */
 const int GRID_CELL_WIDTH  = 30;
 const int GRID_CELL_HEIGHT = 30;
 
+/* grids with more cells than this are drawn by a single
+ * ChartGridItem instead of one PatternGridItem per cell */
+const int VIRTUAL_GRID_THRESHOLD = 40000;
+
+/* default memory budget (in kB) for rasterized knitting
+ * symbols and the largest edge (in device pixels) we still
+ * rasterize; larger symbols are drawn straight from the svg */
+const int SYMBOL_PIXMAP_CACHE_BUDGET = 16384;
+const int SYMBOL_PIXMAP_MAX_EDGE = 512;
+
+/* minimum time (in ms) between two updates of the selection
+ * preview while dragging the rubber band, i.e., about one
+ * frame */
+const int SELECTION_PREVIEW_INTERVAL = 16;
+
+/* default memory budget (in kB) for the undo history */
+const int UNDO_JOURNAL_BUDGET = 8192;
+
+/* maximum time (in ms) between two edits of the same kind on
+ * the same cells that are undone as one step */
+const int UNDO_MERGE_INTERVAL = 1000;
+
+/* number of canvas items read between progress updates
+ * while loading a project */
+const int READ_PROGRESS_INTERVAL = 1024;
+
+/* largest chart (in unit cells) we are willing to create
+ * from the dimensions stored in a project file */
+const int MAX_CHART_CELLS = 4096 * 4096;
+
 
 #endif
@@ -0,0 +1,781 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* C++ headers */
+#include <cstring>
+
+/* Qt headers */
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFont>
+#include <QMap>
+#include <QProgressDialog>
+#include <QSettings>
+#include <QtEndian>
+
+/* local headers */
+#include "basicDefs.h"
+#include "binaryProject.h"
+#include "chartModel.h"
+#include "graphicsScene.h"
+#include "legendItem.h"
+#include "legendLabel.h"
+#include "settings.h"
+#include "symbolCatalog.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+namespace
+{
+/* file header */
+const quint32 BINARY_PROJECT_MAGIC = 0x53434f42;
+const quint16 BINARY_PROJECT_VERSION = 1;
+
+/* sizes of the header, a directory entry and a unit cell
+ * record in bytes */
+const qint64 BINARY_HEADER_SIZE = 8;
+const qint64 BINARY_DIRECTORY_ENTRY_SIZE = 20;
+const qint64 BINARY_CELL_RECORD_SIZE = 6;
+};
+
+
+
+//---------------------------------------------------------------
+//
+//
+// class BinaryProjectWriter
+//
+//
+//---------------------------------------------------------------
+
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+BinaryProjectWriter::BinaryProjectWriter( const GraphicsScene* scene,
+    const QList<QColor>& colors, const QSettings& settings,
+    const QString& theName )
+    :
+    ourScene_( scene ),
+    projectColors_( colors ),
+    settings_( settings ),
+    fileName_( theName ),
+    filePtr_( 0 )
+{
+  status_ = SUCCESSFULLY_CONSTRUCTED;
+}
+
+
+//-------------------------------------------------------------
+// destructor
+//-------------------------------------------------------------
+BinaryProjectWriter::~BinaryProjectWriter()
+{
+  if ( filePtr_ != 0 ) {
+    filePtr_->close();
+    delete filePtr_;
+  }
+}
+
+
+//--------------------------------------------------------------
+// main initialization routine; an existing file is not
+// truncated here since save() may update it in place
+//--------------------------------------------------------------
+bool BinaryProjectWriter::Init()
+{
+  if ( status_ != SUCCESSFULLY_CONSTRUCTED ) {
+    return false;
+  }
+
+  filePtr_ = new QFile( fileName_ );
+  if ( !filePtr_->open( QFile::ReadWrite ) ) {
+    delete filePtr_;
+    filePtr_ = 0;
+    return false;
+  }
+
+  return true;
+}
+
+
+//--------------------------------------------------------------
+// save content of canvas;
+// returns true on success or false on failure
+//--------------------------------------------------------------
+bool BinaryProjectWriter::save()
+{
+  sections_.clear();
+  sections_.push_back( qMakePair( quint32( GRID_SECTION ),
+                                  encode_grid_() ) );
+  sections_.push_back( qMakePair( quint32( COLORS_SECTION ),
+                                  encode_colors_() ) );
+  sections_.push_back( qMakePair( quint32( LEGEND_SECTION ),
+                                  encode_legend_() ) );
+  sections_.push_back( qMakePair( quint32( SETTINGS_SECTION ),
+                                  encode_settings_() ) );
+
+  /* if the file on disk has the same layout we only need to
+   * touch the sections that changed */
+  QList<int> dirtySections;
+  bool status;
+  if ( find_dirty_sections_( dirtySections ) ) {
+    status = write_sections_( dirtySections );
+  } else {
+    status = write_all_sections_();
+  }
+
+  return status && filePtr_->flush()
+         && filePtr_->error() == QFile::NoError;
+}
+
+
+
+/**************************************************************
+ *
+ * PRIVATE FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// encode the header and section directory for the current
+// sections; sections follow the directory back to back
+//-------------------------------------------------------------
+QByteArray BinaryProjectWriter::encode_header_() const
+{
+  QByteArray header;
+  QDataStream out( &header, QIODevice::WriteOnly );
+  out.setVersion( QDataStream::Qt_4_5 );
+
+  out << BINARY_PROJECT_MAGIC << BINARY_PROJECT_VERSION
+      << quint16( sections_.size() );
+
+  qint64 offset = BINARY_HEADER_SIZE
+                  + sections_.size() * BINARY_DIRECTORY_ENTRY_SIZE;
+  for ( int index = 0; index < sections_.size(); ++index ) {
+    qint64 length = sections_.at( index ).second.size();
+    out << sections_.at( index ).first << offset << length;
+    offset += length;
+  }
+
+  return header;
+}
+
+
+
+//-------------------------------------------------------------
+// encode the chart; the symbol table is followed by one
+// record per unit cell in row-major order
+//-------------------------------------------------------------
+QByteArray BinaryProjectWriter::encode_grid_() const
+{
+  const ChartModel& chart = ourScene_->chart_model();
+
+  QHash<const KnittingSymbol*, quint16> symbolIds;
+  QList<KnittingSymbolPtr> symbols;
+  QByteArray records;
+  QDataStream recordStream( &records, QIODevice::WriteOnly );
+  recordStream.setVersion( QDataStream::Qt_4_5 );
+
+  for ( int row = 0; row < chart.num_rows(); ++row ) {
+    for ( int col = 0; col < chart.num_columns(); ++col ) {
+      KnittingSymbolPtr symbol = chart.symbol( col, row );
+      QHash<const KnittingSymbol*, quint16>::const_iterator pos =
+        symbolIds.constFind( symbol.get() );
+
+      quint16 symbolId;
+      if ( pos != symbolIds.constEnd() ) {
+        symbolId = pos.value();
+      } else {
+        symbolId = symbols.size();
+        symbolIds[symbol.get()] = symbolId;
+        symbols.push_back( symbol );
+      }
+
+      quint16 width = 0;
+      if ( chart.origin_column( col, row ) == col ) {
+        width = chart.width( col, row );
+      }
+
+      recordStream << symbolId << quint16( chart.color_index( col, row ) )
+                   << width;
+    }
+  }
+
+  QByteArray grid;
+  QDataStream out( &grid, QIODevice::WriteOnly );
+  out.setVersion( QDataStream::Qt_4_5 );
+
+  out << qint32( chart.num_columns() ) << qint32( chart.num_rows() );
+  out << qint32( symbols.size() );
+  foreach( KnittingSymbolPtr symbol, symbols ) {
+    out << symbol->category() << symbol->patternName();
+  }
+  out.writeRawData( records.constData(), records.size() );
+
+  return grid;
+}
+
+
+
+//-------------------------------------------------------------
+// encode the cell color table and the project colors
+//-------------------------------------------------------------
+QByteArray BinaryProjectWriter::encode_colors_() const
+{
+  QByteArray colors;
+  QDataStream out( &colors, QIODevice::WriteOnly );
+  out.setVersion( QDataStream::Qt_4_5 );
+
+  const QVector<QRgb>& palette = ourScene_->chart_model().palette();
+  out << qint32( palette.size() );
+  foreach( QRgb aColor, palette ) {
+    out << quint32( aColor );
+  }
+
+  out << qint32( projectColors_.size() );
+  foreach( QColor aColor, projectColors_ ) {
+    out << quint32( aColor.rgb() );
+  }
+
+  return colors;
+}
+
+
+
+//-------------------------------------------------------------
+// encode the positions and texts of all legend entries
+//-------------------------------------------------------------
+QByteArray BinaryProjectWriter::encode_legend_() const
+{
+  QByteArray legend;
+  QDataStream out( &legend, QIODevice::WriteOnly );
+  out.setVersion( QDataStream::Qt_4_5 );
+
+  QMap<QString, LegendEntry> allEntries(
+    ourScene_->get_legend_entries() );
+  out << qint32( allEntries.size() );
+
+  QMapIterator<QString, LegendEntry> iter( allEntries );
+  while ( iter.hasNext() ) {
+    iter.next();
+
+    LegendItem* item  = iter.value().first;
+    LegendLabel* label = iter.value().second;
+    out << iter.key()
+        << item->pos().x() << item->pos().y()
+        << label->pos().x() << label->pos().y()
+        << label->toPlainText();
+  }
+
+  return legend;
+}
+
+
+
+//-------------------------------------------------------------
+// encode the grid cell dimensions and text font
+//-------------------------------------------------------------
+QByteArray BinaryProjectWriter::encode_settings_() const
+{
+  QByteArray settings;
+  QDataStream out( &settings, QIODevice::WriteOnly );
+  out.setVersion( QDataStream::Qt_4_5 );
+
+  QSize cellDimensions = extract_cell_dimensions_from_settings( settings_ );
+  out << qint32( cellDimensions.width() )
+      << qint32( cellDimensions.height() )
+      << extract_font_from_settings( settings_ ).toString();
+
+  return settings;
+}
+
+
+
+//-------------------------------------------------------------
+// compare the sections with the ones in the file on disk.
+// Returns false if the file's layout differs and it has to
+// be rewritten as a whole; otherwise dirtySections holds the
+// indices of all sections that changed
+//-------------------------------------------------------------
+bool BinaryProjectWriter::find_dirty_sections_( QList<int>& dirtySections )
+{
+  QByteArray header = encode_header_();
+  qint64 fileSize = header.size();
+  for ( int index = 0; index < sections_.size(); ++index ) {
+    fileSize += sections_.at( index ).second.size();
+  }
+
+  if ( filePtr_->size() != fileSize ) {
+    return false;
+  }
+
+  uchar* mapped = filePtr_->map( 0, fileSize );
+  if ( mapped == 0 ) {
+    return false;
+  }
+
+  /* identical headers mean identical section offsets */
+  bool sameLayout =
+    ( memcmp( mapped, header.constData(), header.size() ) == 0 );
+  if ( sameLayout ) {
+    qint64 offset = header.size();
+    for ( int index = 0; index < sections_.size(); ++index ) {
+      const QByteArray& data = sections_.at( index ).second;
+      if ( memcmp( mapped + offset, data.constData(), data.size() ) != 0 ) {
+        dirtySections.push_back( index );
+      }
+      offset += data.size();
+    }
+  }
+
+  filePtr_->unmap( mapped );
+  return sameLayout;
+}
+
+
+
+//-------------------------------------------------------------
+// replace the content of the file with header, directory and
+// all sections
+//-------------------------------------------------------------
+bool BinaryProjectWriter::write_all_sections_()
+{
+  if ( !filePtr_->resize( 0 ) || !filePtr_->seek( 0 ) ) {
+    return false;
+  }
+
+  QByteArray header = encode_header_();
+  if ( filePtr_->write( header ) != header.size() ) {
+    return false;
+  }
+
+  for ( int index = 0; index < sections_.size(); ++index ) {
+    const QByteArray& data = sections_.at( index ).second;
+    if ( filePtr_->write( data ) != data.size() ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// overwrite the given sections in place
+//-------------------------------------------------------------
+bool BinaryProjectWriter::write_sections_( const QList<int>& dirtySections )
+{
+  qint64 offset = BINARY_HEADER_SIZE
+                  + sections_.size() * BINARY_DIRECTORY_ENTRY_SIZE;
+  for ( int index = 0; index < sections_.size(); ++index ) {
+    const QByteArray& data = sections_.at( index ).second;
+    if ( dirtySections.contains( index ) ) {
+      if ( !filePtr_->seek( offset )
+           || filePtr_->write( data ) != data.size() ) {
+        return false;
+      }
+    }
+    offset += data.size();
+  }
+
+  return true;
+}
+
+
+
+//---------------------------------------------------------------
+//
+//
+// class BinaryProjectReader
+//
+//
+//---------------------------------------------------------------
+
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+BinaryProjectReader::BinaryProjectReader( const QString& theName,
+    const SymbolCatalog& syms, QSettings& settings )
+    :
+    ProjectReader( syms, settings ),
+    fileName_( theName ),
+    filePtr_( 0 ),
+    mapped_( 0 ),
+    mappedSize_( 0 )
+{
+  status_ = SUCCESSFULLY_CONSTRUCTED;
+}
+
+
+//-------------------------------------------------------------
+// destructor
+//-------------------------------------------------------------
+BinaryProjectReader::~BinaryProjectReader()
+{
+  if ( filePtr_ != 0 ) {
+    filePtr_->unmap( const_cast<uchar*>( mapped_ ) );
+    filePtr_->close();
+    delete filePtr_;
+  }
+}
+
+
+//--------------------------------------------------------------
+// main initialization routine; opens and maps the file
+//--------------------------------------------------------------
+bool BinaryProjectReader::Init()
+{
+  if ( status_ != SUCCESSFULLY_CONSTRUCTED ) {
+    return false;
+  }
+
+  filePtr_ = new QFile( fileName_ );
+  if ( filePtr_->open( QFile::ReadOnly ) ) {
+    mappedSize_ = filePtr_->size();
+    mapped_ = filePtr_->map( 0, mappedSize_ );
+  }
+
+  if ( mapped_ == 0 ) {
+    delete filePtr_;
+    filePtr_ = 0;
+    return false;
+  }
+
+  return true;
+}
+
+
+//--------------------------------------------------------------
+// read content of canvas; returns true on success or false
+// on failure or if the user canceled. Settings are only
+// applied once everything was read successfully.
+//--------------------------------------------------------------
+bool BinaryProjectReader::read( QProgressDialog* progress )
+{
+  canceled_ = false;
+  if ( progress != 0 ) {
+    progress->setRange( 0, mappedSize_ );
+  }
+
+  if ( !read_directory_() ) {
+    qDebug() << "ERROR: invalid binary project file" << fileName_;
+    return false;
+  }
+
+  QSize cellDimensions;
+  QString fontName;
+  if ( !read_colors_() || !read_grid_( progress ) || !read_legend_()
+       || !read_settings_( cellDimensions, fontName ) ) {
+    return false;
+  }
+
+  apply_settings_( cellDimensions, fontName );
+
+  if ( progress != 0 ) {
+    progress->setValue( progress->maximum() );
+  }
+
+  return true;
+}
+
+
+
+/**************************************************************
+ *
+ * PRIVATE FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// check the header and read the section directory
+//-------------------------------------------------------------
+bool BinaryProjectReader::read_directory_()
+{
+  QByteArray data = QByteArray::fromRawData(
+                      reinterpret_cast<const char*>( mapped_ ), mappedSize_ );
+  QDataStream in( data );
+  in.setVersion( QDataStream::Qt_4_5 );
+
+  quint32 magic;
+  quint16 version;
+  quint16 numSections;
+  in >> magic >> version >> numSections;
+  if ( in.status() != QDataStream::Ok || magic != BINARY_PROJECT_MAGIC
+       || version != BINARY_PROJECT_VERSION ) {
+    return false;
+  }
+
+  for ( int index = 0; index < numSections; ++index ) {
+    quint32 id;
+    qint64 offset;
+    qint64 length;
+    in >> id >> offset >> length;
+    if ( in.status() != QDataStream::Ok || offset < 0 || length < 0
+         || offset + length > mappedSize_ ) {
+      return false;
+    }
+
+    sections_[id] = qMakePair( offset, length );
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// point data at the section with the given id inside the
+// mapping. Returns false if the file has no such section.
+//-------------------------------------------------------------
+bool BinaryProjectReader::section_( quint32 id, QByteArray& data ) const
+{
+  QHash<quint32, QPair<qint64, qint64> >::const_iterator pos =
+    sections_.constFind( id );
+  if ( pos == sections_.constEnd() ) {
+    return false;
+  }
+
+  data = QByteArray::fromRawData(
+           reinterpret_cast<const char*>( mapped_ + pos.value().first ),
+           pos.value().second );
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// read the cell color table and the project colors
+//-------------------------------------------------------------
+bool BinaryProjectReader::read_colors_()
+{
+  QByteArray data;
+  if ( !section_( COLORS_SECTION, data ) ) {
+    qDebug() << "ERROR: binary project file lacks colors section";
+    return false;
+  }
+
+  QDataStream in( data );
+  in.setVersion( QDataStream::Qt_4_5 );
+
+  qint32 numColors;
+  in >> numColors;
+  for ( int index = 0; index < numColors && in.status() == QDataStream::Ok;
+        ++index ) {
+    quint32 rgb;
+    in >> rgb;
+    cellColors_.push_back( QColor( rgb ) );
+  }
+
+  qint32 numProjectColors;
+  in >> numProjectColors;
+  for ( int index = 0;
+        index < numProjectColors && in.status() == QDataStream::Ok;
+        ++index ) {
+    quint32 rgb;
+    in >> rgb;
+    projectColors_.push_back( QColor( rgb ) );
+  }
+
+  return ( in.status() == QDataStream::Ok );
+}
+
+
+
+//-------------------------------------------------------------
+// read the chart. Rows are fixed width records so we walk
+// them right inside the mapping without copying anything
+//-------------------------------------------------------------
+bool BinaryProjectReader::read_grid_( QProgressDialog* progress )
+{
+  QByteArray data;
+  if ( !section_( GRID_SECTION, data ) ) {
+    qDebug() << "ERROR: binary project file lacks grid section";
+    return false;
+  }
+
+  QDataStream in( data );
+  in.setVersion( QDataStream::Qt_4_5 );
+
+  qint32 numCols;
+  qint32 numRows;
+  qint32 numSymbols;
+  in >> numCols >> numRows >> numSymbols;
+
+  QList<KnittingSymbolPtr> symbols;
+  for ( int index = 0; index < numSymbols && in.status() == QDataStream::Ok;
+        ++index ) {
+    QString category;
+    QString name;
+    in >> category >> name;
+
+    KnittingSymbolPtr symbolPtr;
+    if ( !allSymbols_.find( category, name, symbolPtr ) ) {
+      qDebug() << "ERROR: failed to load symbol" << name
+      << "in category" << category;
+      return false;
+    }
+    symbols.push_back( symbolPtr );
+  }
+
+  /* the rest of the section are the cell records */
+  qint64 recordsStart = in.device()->pos();
+  qint64 rowSize = qint64( numCols ) * BINARY_CELL_RECORD_SIZE;
+  if ( in.status() != QDataStream::Ok
+       || !ChartModel::valid_dimensions( numCols, numRows )
+       || data.size() - recordsStart != rowSize * numRows ) {
+    qDebug() << "ERROR: corrupt grid section";
+    return false;
+  }
+
+  /* the records go straight into the chart. Each row has to
+   * be covered exactly, i.e., we have to find a chart cell at
+   * every origin we step to and the unit cells it covers have
+   * to be marked with a width of 0 */
+  chart_.reset( numCols, numRows );
+  const uchar* records =
+    reinterpret_cast<const uchar*>( data.constData() ) + recordsStart;
+  int progressInterval = qMax( 1, READ_PROGRESS_INTERVAL / numCols );
+  for ( int row = 0; row < numRows; ++row ) {
+    const uchar* record = records + row * rowSize;
+    int col = 0;
+    while ( col < numCols ) {
+      const uchar* cell = record + col * BINARY_CELL_RECORD_SIZE;
+      quint16 width = qFromBigEndian<quint16>( cell + 4 );
+      quint16 symbolId = qFromBigEndian<quint16>( cell );
+      quint16 colorId = qFromBigEndian<quint16>( cell + 2 );
+      if ( width == 0 || width > numCols - col
+           || symbolId >= symbols.size() || colorId >= cellColors_.size() ) {
+        qDebug() << "ERROR: invalid cell record at (" << col << ","
+        << row << ")";
+        return false;
+      }
+
+      for ( int covered = col + 1; covered < col + width; ++covered ) {
+        const uchar* coveredCell = record + covered * BINARY_CELL_RECORD_SIZE;
+        if ( qFromBigEndian<quint16>( coveredCell + 4 ) != 0 ) {
+          qDebug() << "ERROR: overlapping cell records at (" << covered
+          << "," << row << ")";
+          return false;
+        }
+      }
+
+      chart_.set_cell( col, row, width, symbols.at( symbolId ),
+                       cellColors_.at( colorId ) );
+      col += width;
+    }
+
+    if ( progress != 0 && ( row + 1 ) % progressInterval == 0 ) {
+      progress->setValue( record + rowSize - mapped_ );
+      if ( progress->wasCanceled() ) {
+        canceled_ = true;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// read the legend entries (if present)
+//-------------------------------------------------------------
+bool BinaryProjectReader::read_legend_()
+{
+  QByteArray data;
+  if ( !section_( LEGEND_SECTION, data ) ) {
+    return true;
+  }
+
+  QDataStream in( data );
+  in.setVersion( QDataStream::Qt_4_5 );
+
+  qint32 numEntries;
+  in >> numEntries;
+  for ( int index = 0; index < numEntries && in.status() == QDataStream::Ok;
+        ++index ) {
+    QString entryID;
+    double itemXPos;
+    double itemYPos;
+    double labelXPos;
+    double labelYPos;
+    QString labelText;
+    in >> entryID >> itemXPos >> itemYPos >> labelXPos >> labelYPos
+       >> labelText;
+
+    if ( in.status() == QDataStream::Ok ) {
+      add_legend_entry_( entryID, itemXPos, itemYPos, labelXPos, labelYPos,
+                         labelText );
+    }
+  }
+
+  return ( in.status() == QDataStream::Ok );
+}
+
+
+
+//-------------------------------------------------------------
+// read the grid cell dimensions and text font (if present)
+//-------------------------------------------------------------
+bool BinaryProjectReader::read_settings_( QSize& cellDimensions,
+    QString& fontName )
+{
+  QByteArray data;
+  if ( !section_( SETTINGS_SECTION, data ) ) {
+    return true;
+  }
+
+  QDataStream in( data );
+  in.setVersion( QDataStream::Qt_4_5 );
+
+  qint32 width;
+  qint32 height;
+  in >> width >> height >> fontName;
+  if ( in.status() != QDataStream::Ok ) {
+    return false;
+  }
+
+  cellDimensions = QSize( width, height );
+  return true;
+}
+
+
+
+QT_END_NAMESPACE
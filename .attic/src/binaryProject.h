@@ -0,0 +1,181 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef BINARY_PROJECT_H
+#define BINARY_PROJECT_H
+
+/* QT includes */
+#include <QByteArray>
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSize>
+#include <QString>
+
+/* local includes */
+#include "projectFormat.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* forward declarations */
+class QFile;
+
+
+/*******************************************************************
+ *
+ * The binary project format (.sconchob) is a container made up
+ * of a header, a section directory and the sections themselves:
+ *
+ *   header:    magic, version, number of sections
+ *   directory: (section id, offset, length) per section
+ *
+ * The grid section holds the chart dimensions and the symbol
+ * table followed by one fixed width record per chart row. Each
+ * unit cell takes BINARY_CELL_RECORD_SIZE bytes (symbol id,
+ * color id and cell width; the width is 0 for unit cells
+ * covered by a chart cell to their left) so any row can be
+ * located without looking at the ones before it.
+ *
+ * Files are read through a memory mapping. The directory tells
+ * us where each section lives and the cell records of the grid
+ * section are decoded straight from the mapping into the chart.
+ * Sections with unknown ids are skipped.
+ *
+ ******************************************************************/
+enum BinarySectionId {
+  GRID_SECTION = 1,
+  COLORS_SECTION = 2,
+  LEGEND_SECTION = 3,
+  SETTINGS_SECTION = 4
+};
+
+
+
+/*******************************************************************
+ *
+ * BinaryProjectWriter writes the content of our canvas to a
+ * binary project file. If the file already exists with the same
+ * section layout only sections whose content changed are
+ * written.
+ *
+ ******************************************************************/
+class BinaryProjectWriter
+    :
+    public ProjectWriter
+{
+
+public:
+
+  explicit BinaryProjectWriter( const GraphicsScene* theScene,
+                                const QList<QColor>& activeColors,
+                                const QSettings& settings,
+                                const QString& fileName );
+  ~BinaryProjectWriter();
+  bool Init();
+
+  /* save content of canvas */
+  bool save();
+
+
+private:
+
+  /* status variable */
+  int status_;
+
+  /* variables */
+  const GraphicsScene* ourScene_;
+  const QList<QColor>& projectColors_;
+  const QSettings& settings_;
+  QString fileName_;
+  QFile* filePtr_;
+
+  /* encoded sections in the order they are written */
+  QList<QPair<quint32, QByteArray> > sections_;
+
+  /* helper functions */
+  QByteArray encode_header_() const;
+  QByteArray encode_grid_() const;
+  QByteArray encode_colors_() const;
+  QByteArray encode_legend_() const;
+  QByteArray encode_settings_() const;
+  bool find_dirty_sections_( QList<int>& dirtySections );
+  bool write_all_sections_();
+  bool write_sections_( const QList<int>& dirtySections );
+};
+
+
+
+/*******************************************************************
+ *
+ * BinaryProjectReader reads a binary project file through a
+ * memory mapping of the file
+ *
+ ******************************************************************/
+class BinaryProjectReader
+    :
+    public ProjectReader
+{
+
+public:
+
+  explicit BinaryProjectReader( const QString& fileName,
+                                const SymbolCatalog& allSymbols,
+                                QSettings& settings );
+  ~BinaryProjectReader();
+  bool Init();
+
+  /* read content of canvas */
+  bool read( QProgressDialog* progress = 0 );
+
+
+private:
+
+  /* status variable */
+  int status_;
+
+  /* variables */
+  QString fileName_;
+  QFile* filePtr_;
+  const uchar* mapped_;
+  qint64 mappedSize_;
+
+  /* location (offset, length) of each section in the file */
+  QHash<quint32, QPair<qint64, qint64> > sections_;
+
+  /* color table referenced by the cell records */
+  QList<QColor> cellColors_;
+
+  /* helper functions */
+  bool read_directory_();
+  bool section_( quint32 id, QByteArray& data ) const;
+  bool read_colors_();
+  bool read_grid_( QProgressDialog* progress );
+  bool read_legend_();
+  bool read_settings_( QSize& cellDimensions, QString& fontName );
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,52 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QColor>
+
+/* local headers */
+#include "cellStyle.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+CellStyle::CellStyle( const QSize& cellDimensions,
+                      const ChartModel& chart )
+    :
+    cellDimensions_( cellDimensions ),
+    chart_( chart )
+{
+  pen_.setWidthF( 1.0 );
+  pen_.setColor( Qt::black );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,80 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+
+#ifndef CELL_STYLE_H
+#define CELL_STYLE_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QPen>
+#include <QSize>
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* forward declarations */
+class ChartModel;
+
+
+/***************************************************************
+ *
+ * CellStyle holds the appearance shared by all chart cells of
+ * a scene, i.e., the outline pen, the size of a unit cell and
+ * the chart model the cells look up their colors in.
+ * Cells only keep a reference to it so a change of the cell
+ * size only touches the scene's cell dimensions and a palette
+ * edit only touches the chart model.
+ *
+ ***************************************************************/
+class CellStyle
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  CellStyle( const QSize& cellDimensions, const ChartModel& chart );
+
+  /* size of a unit cell */
+  const QSize& cell_size() const { return cellDimensions_; }
+
+  /* the chart holding the cells' colors */
+  const ChartModel& chart() const { return chart_; }
+
+  /* pen for drawing cell outlines */
+  const QPen& pen() const { return pen_; }
+
+
+private:
+
+  const QSize& cellDimensions_;
+  const ChartModel& chart_;
+  QPen pen_;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,247 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QDataStream>
+#include <QHash>
+#include <QVector>
+
+/* local headers */
+#include "basicDefs.h"
+#include "chartClipboard.h"
+#include "io.h"
+#include "symbolCatalog.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+namespace
+{
+/* payload header */
+const quint32 CHART_CELLS_MAGIC = 0x53434e43;
+const quint16 CHART_CELLS_VERSION = 1;
+
+/* symbols and colors are referred to by quint16 indices */
+const int MAX_TABLE_SIZE = 65536;
+};
+
+
+
+//---------------------------------------------------------------
+// add a cell to a copy object
+//---------------------------------------------------------------
+void append_copy_cell( CopyObject& cells, const KnittingSymbolPtr symbol,
+                       const QColor& color, int column, int row,
+                       int width )
+{
+  /* extend the last run if we continue it */
+  if ( !cells.runs.empty() ) {
+    CopyObjectRun& last = cells.runs.last();
+    if ( last.row == row
+         && last.column + last.count * last.width == column
+         && last.width == width
+         && last.symbol == symbol
+         && last.backColor.rgb() == color.rgb() ) {
+      ++last.count;
+      return;
+    }
+  }
+
+  CopyObjectRun run;
+  run.symbol    = symbol;
+  run.backColor = color;
+  run.row       = row;
+  run.column    = column;
+  run.count     = 1;
+  run.width     = width;
+  cells.runs.push_back( run );
+}
+
+
+
+//---------------------------------------------------------------
+// encode a copy object as clipboard payload
+//---------------------------------------------------------------
+QByteArray encode_copy_object( const CopyObject& cells )
+{
+  /* intern symbols and colors and collect the runs of each row */
+  QList<KnittingSymbolPtr> symbols;
+  QHash<const KnittingSymbol*, quint16> symbolLookup;
+  QList<QRgb> colors;
+  QHash<QRgb, quint16> colorLookup;
+  QVector<QList<int> > rows( cells.height );
+
+  for ( int index = 0; index < cells.runs.size(); ++index ) {
+    const CopyObjectRun& run = cells.runs.at( index );
+    const KnittingSymbol* symbolKey = run.symbol.get();
+    if ( !symbolLookup.contains( symbolKey ) ) {
+      if ( symbols.size() == MAX_TABLE_SIZE ) {
+        return QByteArray();
+      }
+      symbolLookup[symbolKey] = symbols.size();
+      symbols.push_back( run.symbol );
+    }
+
+    QRgb rgb = run.backColor.rgb();
+    if ( !colorLookup.contains( rgb ) ) {
+      if ( colors.size() == MAX_TABLE_SIZE ) {
+        return QByteArray();
+      }
+      colorLookup[rgb] = colors.size();
+      colors.push_back( rgb );
+    }
+
+    rows[run.row].push_back( index );
+  }
+
+  /* write it all out */
+  QByteArray data;
+  QDataStream out( &data, QIODevice::WriteOnly );
+  out.setVersion( QDataStream::Qt_4_5 );
+
+  out << CHART_CELLS_MAGIC << CHART_CELLS_VERSION
+      << qint32( cells.width ) << qint32( cells.height );
+
+  out << qint32( symbols.size() );
+  foreach( KnittingSymbolPtr symbol, symbols ) {
+    out << symbol->category() << symbol->patternName();
+  }
+
+  out << qint32( colors.size() );
+  foreach( QRgb rgb, colors ) {
+    out << quint32( rgb );
+  }
+
+  foreach( QList<int> rowRuns, rows ) {
+    out << qint32( rowRuns.size() );
+    foreach( int index, rowRuns ) {
+      const CopyObjectRun& run = cells.runs.at( index );
+      out << qint32( run.column ) << qint32( run.count )
+          << qint32( run.width )
+          << symbolLookup.value( run.symbol.get() )
+          << colorLookup.value( run.backColor.rgb() );
+    }
+  }
+
+  return data;
+}
+
+
+
+//---------------------------------------------------------------
+// decode a clipboard payload into a copy object
+//---------------------------------------------------------------
+bool decode_copy_object( const QByteArray& data,
+                         const SymbolCatalog& allSymbols,
+                         CopyObject& cells )
+{
+  QDataStream in( data );
+  in.setVersion( QDataStream::Qt_4_5 );
+
+  quint32 magic;
+  quint16 version;
+  qint32 width;
+  qint32 height;
+  in >> magic >> version >> width >> height;
+  if ( in.status() != QDataStream::Ok || magic != CHART_CELLS_MAGIC
+       || version != CHART_CELLS_VERSION || width <= 0 || height <= 0
+       || qint64( width ) * height > MAX_CHART_CELLS ) {
+    return false;
+  }
+
+  /* symbol table */
+  qint32 numSymbols;
+  in >> numSymbols;
+  QList<KnittingSymbolPtr> symbols;
+  for ( int index = 0; index < numSymbols && in.status() == QDataStream::Ok;
+        ++index ) {
+    QString category;
+    QString name;
+    in >> category >> name;
+
+    KnittingSymbolPtr symbol = emptyKnittingSymbol;
+    if ( name != ""
+         && !allSymbols.find( category, name, symbol ) ) {
+      return false;
+    }
+    symbols.push_back( symbol );
+  }
+
+  /* color table */
+  qint32 numColors;
+  in >> numColors;
+  QList<QColor> colors;
+  for ( int index = 0; index < numColors && in.status() == QDataStream::Ok;
+        ++index ) {
+    quint32 rgb;
+    in >> rgb;
+    colors.push_back( QColor( rgb ) );
+  }
+
+  if ( in.status() != QDataStream::Ok ) {
+    return false;
+  }
+
+  /* rows */
+  QVector<CopyObjectRun> runs;
+  for ( int row = 0; row < height; ++row ) {
+    qint32 numRuns;
+    in >> numRuns;
+    if ( in.status() != QDataStream::Ok ) {
+      return false;
+    }
+
+    for ( int runIndex = 0; runIndex < numRuns; ++runIndex ) {
+      qint32 column;
+      qint32 count;
+      qint32 runWidth;
+      quint16 symbolIndex;
+      quint16 colorIndex;
+      in >> column >> count >> runWidth >> symbolIndex >> colorIndex;
+      if ( in.status() != QDataStream::Ok
+           || symbolIndex >= symbols.size()
+           || colorIndex >= colors.size()
+           || runWidth <= 0 || count <= 0 || column < 0
+           || column >= width
+           || count > ( width - column ) / runWidth ) {
+        return false;
+      }
+
+      CopyObjectRun run;
+      run.symbol    = symbols.at( symbolIndex );
+      run.backColor = colors.at( colorIndex );
+      run.row       = row;
+      run.column    = column;
+      run.count     = count;
+      run.width     = runWidth;
+      runs.push_back( run );
+    }
+  }
+
+  cells.runs = runs;
+  cells.width = width;
+  cells.height = height;
+  return true;
+}
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,109 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef CHART_CLIPBOARD_H
+#define CHART_CLIPBOARD_H
+
+/* QT includes */
+#include <QByteArray>
+#include <QColor>
+#include <QString>
+#include <QVector>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* forward declarations */
+class SymbolCatalog;
+
+
+/* MIME type of chart cells on the system clipboard */
+const QString CHART_CELLS_MIME_TYPE( "application/x-sconcho-cells" );
+
+
+
+/****************************************************************
+ *
+ * definitions of copy object
+ *
+ ***************************************************************/
+/* a run of count identical adjacent cells within a row */
+struct CopyObjectRun {
+  KnittingSymbolPtr symbol;
+  QColor backColor;
+  int row;
+  int column;   // column of the first cell of the run
+  int count;    // number of cells in the run
+  int width;    // width of each cell in columns
+};
+
+
+struct CopyObject {
+  QVector<CopyObjectRun> runs;
+  int width;    // width of copy object in columns
+  int height;   // height of copy object in rows
+};
+
+
+
+//---------------------------------------------------------------
+// add a cell to a copy object; it extends the last run if it
+// continues it.
+// NOTE: cells are expected row by row in order of increasing
+// column
+//---------------------------------------------------------------
+void append_copy_cell( CopyObject& cells, const KnittingSymbolPtr symbol,
+                       const QColor& color, int column, int row,
+                       int width );
+
+
+
+//---------------------------------------------------------------
+// encode a copy object as CHART_CELLS_MIME_TYPE payload. Each
+// row is stored as its runs referring to interned symbol and
+// color tables.
+// Returns an empty QByteArray if there are more distinct symbols
+// or colors than the payload can index.
+//---------------------------------------------------------------
+QByteArray encode_copy_object( const CopyObject& cells );
+
+
+
+//---------------------------------------------------------------
+// decode a CHART_CELLS_MIME_TYPE payload into a copy object
+// using the knitting symbols in allSymbols. Returns false if
+// the payload is corrupt, refers to unknown symbols or covers
+// more than MAX_CHART_CELLS cells. The runs are kept as they
+// are so the size of the copy object follows the size of the
+// payload.
+//---------------------------------------------------------------
+bool decode_copy_object( const QByteArray& data,
+                         const SymbolCatalog& allSymbols,
+                         CopyObject& cells );
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,184 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+/* C++ headers */
+#include <cmath>
+
+/* Qt headers */
+#include <QColor>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+/* local headers */
+#include "chartGridItem.h"
+#include "chartModel.h"
+#include "symbolPixmapCache.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+ChartGridItem::ChartGridItem( const ChartModel& aChart,
+                              const QPoint& anOrigin,
+                              const CellStyle& aStyle )
+    :
+    QGraphicsItem(),
+    chart_( aChart ),
+    origin_( anOrigin ),
+    style_( aStyle ),
+    cellDimensions_( aStyle.cell_size() )
+{
+  status_ = SUCCESSFULLY_CONSTRUCTED;
+}
+
+
+
+//--------------------------------------------------------------
+// main initialization routine
+//--------------------------------------------------------------
+bool ChartGridItem::Init()
+{
+  if ( status_ != SUCCESSFULLY_CONSTRUCTED ) {
+    return false;
+  }
+
+  /* we need the exposed rectangle for painting */
+  setFlags( QGraphicsItem::ItemUsesExtendedStyleOption );
+
+  /* materialized PatternGridItems are drawn on top of us */
+  setZValue( -1.0 );
+
+  return true;
+}
+
+
+
+//--------------------------------------------------------------
+// return our custom type
+//--------------------------------------------------------------
+int ChartGridItem::type() const
+{
+  return Type;
+}
+
+
+
+//------------------------------------------------------------
+// our bounding rectangle covers the whole pattern grid
+//------------------------------------------------------------
+QRectF ChartGridItem::boundingRect() const
+{
+  qreal penWidth = style_.pen().widthF();
+  return QRectF( origin_.x() - penWidth * 0.25,
+                 origin_.y() - penWidth * 0.25,
+                 cellDimensions_.width() * chart_.num_columns()
+                 + penWidth * 0.5,
+                 cellDimensions_.height() * chart_.num_rows()
+                 + penWidth * 0.5 );
+}
+
+
+
+//------------------------------------------------------------
+// paint all chart cells intersecting the exposed rectangle
+//------------------------------------------------------------
+void ChartGridItem::paint( QPainter *painter,
+                           const QStyleOptionGraphicsItem *option,
+                           QWidget *widget )
+{
+  Q_UNUSED( widget );
+
+  if ( chart_.num_columns() == 0 || chart_.num_rows() == 0 ) {
+    return;
+  }
+
+  /* figure out which cells are exposed */
+  QRectF exposed = option->exposedRect;
+  double cellWidth = cellDimensions_.width();
+  double cellHeight = cellDimensions_.height();
+
+  int firstCol = static_cast<int>(
+                   floor(( exposed.left() - origin_.x() ) / cellWidth ) );
+  int lastCol = static_cast<int>(
+                  floor(( exposed.right() - origin_.x() ) / cellWidth ) );
+  int firstRow = static_cast<int>(
+                   floor(( exposed.top() - origin_.y() ) / cellHeight ) );
+  int lastRow = static_cast<int>(
+                  floor(( exposed.bottom() - origin_.y() ) / cellHeight ) );
+
+  firstCol = qMax( firstCol, 0 );
+  lastCol = qMin( lastCol, chart_.num_columns() - 1 );
+  firstRow = qMax( firstRow, 0 );
+  lastRow = qMin( lastRow, chart_.num_rows() - 1 );
+
+  painter->setPen( style_.pen() );
+  painter->setBrush( Qt::NoBrush );
+  for ( int row = firstRow; row <= lastRow; ++row ) {
+    int col = chart_.origin_column( firstCol, row );
+    while ( col <= lastCol ) {
+      int width = chart_.width( col, row );
+      QRectF cellRect( origin_.x() + col * cellWidth,
+                       origin_.y() + row * cellHeight,
+                       width * cellWidth, cellHeight );
+
+      SymbolPixmapCache::instance().draw( painter, chart_.symbol( col, row ),
+                                          cellRect,
+                                          QColor( chart_.color( col, row ) ) );
+      painter->drawRect( cellRect );
+
+      col += width;
+    }
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// let the scene know that our size changed
+//-------------------------------------------------------------
+void ChartGridItem::update_geometry()
+{
+  prepareGeometryChange();
+  update();
+}
+
+
+
+//-------------------------------------------------------------
+// schedule a repaint of a span of cells
+//-------------------------------------------------------------
+void ChartGridItem::update_cells( int col, int row, int width )
+{
+  update( origin_.x() + col * cellDimensions_.width(),
+          origin_.y() + row * cellDimensions_.height(),
+          width * cellDimensions_.width(), cellDimensions_.height() );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,96 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+#ifndef CHART_GRID_ITEM_H
+#define CHART_GRID_ITEM_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QGraphicsItem>
+
+/* local includes */
+#include "basicDefs.h"
+#include "cellStyle.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* a few forward declarations */
+class ChartModel;
+class QPainter;
+class QStyleOptionGraphicsItem;
+
+
+/***************************************************************
+ *
+ * ChartGridItem draws the complete pattern grid straight from
+ * the ChartModel. Only the cells inside the exposed rectangle
+ * are painted so the cost of a repaint depends on what is
+ * visible, not on the size of the chart. It is used for large
+ * charts in place of one PatternGridItem per cell.
+ *
+ ***************************************************************/
+class ChartGridItem
+    :
+    public QGraphicsItem,
+    public boost::noncopyable
+{
+
+public:
+
+  explicit ChartGridItem( const ChartModel& chart, const QPoint& origin,
+                          const CellStyle& style );
+  bool Init();
+
+  /* return our object type; needed for qgraphicsitem_cast */
+  enum { Type = UserType + CHART_GRID_ITEM_TYPE };
+  int type() const;
+
+  /* reimplement pure virtual base class methods */
+  QRectF boundingRect() const;
+  void paint( QPainter *painter,
+              const QStyleOptionGraphicsItem *option, QWidget *widget );
+
+  /* call after the grid dimensions or cell size changed */
+  void update_geometry();
+
+  /* repaint width cells starting at col, row */
+  void update_cells( int col, int row, int width = 1 );
+
+
+private:
+
+  /* some tracking variables */
+  int status_;
+
+  /* the chart we are drawing */
+  const ChartModel& chart_;
+  QPoint origin_;
+  const CellStyle& style_;
+  const QSize& cellDimensions_;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
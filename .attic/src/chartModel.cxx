@@ -0,0 +1,696 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+/* Qt headers */
+#include <QDebug>
+#include <QtAlgorithms>
+
+/* local headers */
+#include "basicDefs.h"
+#include "chartModel.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+namespace
+{
+/* color of cells that were never painted */
+const QRgb EMPTY_CELL_COLOR = 0xffffffff;
+
+
+//-------------------------------------------------------------
+// rebuild a row-major array of numCols x numRows with count
+// columns of value inserted in front of col in every row.
+// This is a single pass over the data regardless of count.
+//-------------------------------------------------------------
+template<typename T>
+void insert_columns_into( QVector<T>& data, int numCols, int numRows,
+                          int col, int count, const T& value )
+{
+  int newCols = numCols + count;
+  QVector<T> newData( numRows * newCols, value );
+
+  for ( int row = 0; row < numRows; ++row ) {
+    const T* source = data.constData() + row * numCols;
+    T* target = newData.data() + row * newCols;
+    qCopy( source, source + col, target );
+    qCopy( source + col, source + numCols, target + col + count );
+  }
+
+  data = newData;
+}
+
+
+
+//-------------------------------------------------------------
+// rebuild a row-major array of numCols x numRows with count
+// columns starting at col removed from every row
+//-------------------------------------------------------------
+template<typename T>
+void delete_columns_from( QVector<T>& data, int numCols, int numRows,
+                          int col, int count )
+{
+  int newCols = numCols - count;
+  QVector<T> newData( numRows * newCols );
+
+  for ( int row = 0; row < numRows; ++row ) {
+    const T* source = data.constData() + row * numCols;
+    T* target = newData.data() + row * newCols;
+    qCopy( source, source + col, target );
+    qCopy( source + col + count, source + numCols, target + col );
+  }
+
+  data = newData;
+}
+};
+
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+ChartModel::ChartModel( int numCols, int numRows )
+    :
+    numCols_( 0 ),
+    numRows_( 0 )
+{
+  status_ = SUCCESSFULLY_CONSTRUCTED;
+
+  /* the empty knitting symbol always has id 0 */
+  symbolTable_.push_back( emptyKnittingSymbol );
+  symbolLookup_[emptyKnittingSymbol.get()] = 0;
+
+  reset( numCols, numRows );
+}
+
+
+
+//--------------------------------------------------------------
+// main initialization routine
+//--------------------------------------------------------------
+bool ChartModel::Init()
+{
+  if ( status_ != SUCCESSFULLY_CONSTRUCTED ) {
+    return false;
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// throw away the current content and create an empty grid
+// of unit cells
+//-------------------------------------------------------------
+void ChartModel::reset( int numCols, int numRows )
+{
+  assert( numCols >= 0 );
+  assert( numRows >= 0 );
+
+  numCols_ = numCols;
+  numRows_ = numRows;
+
+  /* the empty cell color always has id 0 */
+  palette_.clear();
+  paletteLookup_.clear();
+  colorUses_.clear();
+  freeColorIds_.clear();
+  intern_color_( EMPTY_CELL_COLOR );
+
+  int numCells = numCols_ * numRows_;
+  colorUses_[0] = numCells;
+  symbolIds_.fill( 0, numCells );
+  colorIds_.fill( 0, numCells );
+  spans_.fill( 1, numCells );
+  items_.fill( 0, numCells );
+}
+
+
+
+//-------------------------------------------------------------
+// check dimensions coming from outside (e.g. a project file)
+// before they are handed to reset(); the product is computed
+// in 64 bits since it must not overflow
+//-------------------------------------------------------------
+bool ChartModel::valid_dimensions( int numCols, int numRows )
+{
+  return numCols > 0 && numRows > 0
+         && qint64( numCols ) * numRows <= MAX_CHART_CELLS;
+}
+
+
+
+//-------------------------------------------------------------
+// returns true if col, row is inside the grid
+//-------------------------------------------------------------
+bool ChartModel::contains( int col, int row ) const
+{
+  return ( col >= 0 && col < numCols_ && row >= 0 && row < numRows_ );
+}
+
+
+
+//-------------------------------------------------------------
+// store a new chart cell. Whatever chart cells were previously
+// covering the span are overwritten, so callers have to take
+// care of their items before.
+//-------------------------------------------------------------
+void ChartModel::set_cell( int col, int row, int aWidth,
+                           const KnittingSymbolPtr symbol,
+                           const QColor& aColor, PatternGridItem* anItem )
+{
+  assert( contains( col, row ) );
+  assert( aWidth >= 1 );
+  assert( col + aWidth <= numCols_ );
+
+  quint16 symbolId = intern_symbol_( symbol );
+  quint16 colorId = intern_color_( aColor.rgb() );
+  colorUses_[colorId] += aWidth;
+
+  int origin = index_( col, row );
+  for ( int offset = 0; offset < aWidth; ++offset ) {
+    int index = origin + offset;
+    release_color_( colorIds_[index] );
+    symbolIds_[index] = symbolId;
+    colorIds_[index] = colorId;
+    spans_[index] = ( offset == 0 ) ? aWidth : -offset;
+    items_[index] = anItem;
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// turn the chart cell covering col, row into empty unit cells
+//-------------------------------------------------------------
+void ChartModel::clear_cell( int col, int row )
+{
+  assert( contains( col, row ) );
+
+  int origin = origin_index_( col, row );
+  int cellWidth = spans_[origin];
+  for ( int offset = 0; offset < cellWidth; ++offset ) {
+    clear_unit_cell_( origin + offset );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// change the color of the chart cell covering col, row
+//-------------------------------------------------------------
+void ChartModel::set_color( int col, int row, const QColor& aColor )
+{
+  assert( contains( col, row ) );
+
+  int origin = origin_index_( col, row );
+  int cellWidth = spans_[origin];
+  quint16 colorId = intern_color_( aColor.rgb() );
+  colorUses_[colorId] += cellWidth;
+  for ( int offset = 0; offset < cellWidth; ++offset ) {
+    release_color_( colorIds_[origin + offset] );
+    colorIds_[origin + offset] = colorId;
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// recolor all cells of oldColor. If newColor isn't in the
+// palette yet we simply change the palette entry, otherwise
+// (or if oldColor is the empty cell color, which has to stay
+// put) the cells are moved over to the entry of newColor so
+// palette entries stay unique.
+//-------------------------------------------------------------
+void ChartModel::replace_color( const QColor& oldColor,
+                                const QColor& newColor )
+{
+  QRgb oldRgb = oldColor.rgb();
+  QRgb newRgb = newColor.rgb();
+  if ( oldRgb == newRgb || !paletteLookup_.contains( oldRgb ) ) {
+    return;
+  }
+
+  quint16 oldId = paletteLookup_.value( oldRgb );
+  if ( oldId != 0 && !paletteLookup_.contains( newRgb ) ) {
+    palette_[oldId] = newRgb;
+    paletteLookup_.remove( oldRgb );
+    paletteLookup_[newRgb] = oldId;
+    return;
+  }
+
+  quint16 newId = intern_color_( newRgb );
+  quint16* ids = colorIds_.data();
+  for ( int index = 0; index < colorIds_.size(); ++index ) {
+    if ( ids[index] == oldId ) {
+      ids[index] = newId;
+    }
+  }
+
+  int numMoved = colorUses_[oldId];
+  colorUses_[newId] += numMoved;
+  release_color_( oldId, numMoved );
+}
+
+
+
+//-------------------------------------------------------------
+// change the item displaying the chart cell covering col, row
+//-------------------------------------------------------------
+void ChartModel::set_item( int col, int row, PatternGridItem* anItem )
+{
+  assert( contains( col, row ) );
+
+  int origin = origin_index_( col, row );
+  int cellWidth = spans_[origin];
+  for ( int offset = 0; offset < cellWidth; ++offset ) {
+    items_[origin + offset] = anItem;
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// return the column of the origin of the chart cell covering
+// col, row
+//-------------------------------------------------------------
+int ChartModel::origin_column( int col, int row ) const
+{
+  assert( contains( col, row ) );
+
+  int span = spans_[index_( col, row )];
+  return ( span > 0 ) ? col : col + span;
+}
+
+
+
+//-------------------------------------------------------------
+// return the width of the chart cell covering col, row
+//-------------------------------------------------------------
+int ChartModel::width( int col, int row ) const
+{
+  assert( contains( col, row ) );
+
+  return spans_[origin_index_( col, row )];
+}
+
+
+
+//-------------------------------------------------------------
+// return the knitting symbol of the chart cell covering col, row
+//-------------------------------------------------------------
+KnittingSymbolPtr ChartModel::symbol( int col, int row ) const
+{
+  assert( contains( col, row ) );
+
+  return symbolTable_.at( symbolIds_[index_( col, row )] );
+}
+
+
+
+//-------------------------------------------------------------
+// returns true if col, row is an empty unit cell, i.e., no
+// chart cell was ever placed there
+//-------------------------------------------------------------
+bool ChartModel::is_empty( int col, int row ) const
+{
+  assert( contains( col, row ) );
+
+  return symbolIds_[index_( col, row )] == 0;
+}
+
+
+
+//-------------------------------------------------------------
+// return the color of the chart cell covering col, row
+//-------------------------------------------------------------
+QRgb ChartModel::color( int col, int row ) const
+{
+  assert( contains( col, row ) );
+
+  return palette_[colorIds_[index_( col, row )]];
+}
+
+
+
+//-------------------------------------------------------------
+// return the palette index of the color of the chart cell
+// covering col, row
+//-------------------------------------------------------------
+int ChartModel::color_index( int col, int row ) const
+{
+  assert( contains( col, row ) );
+
+  return colorIds_[index_( col, row )];
+}
+
+
+
+//-------------------------------------------------------------
+// return the PatternGridItem displaying the chart cell covering
+// col, row (or 0 if there is none)
+//-------------------------------------------------------------
+PatternGridItem* ChartModel::item( int col, int row ) const
+{
+  assert( contains( col, row ) );
+
+  return items_[index_( col, row )];
+}
+
+
+
+//-------------------------------------------------------------
+// return all items in a row ordered by column
+//-------------------------------------------------------------
+QList<PatternGridItem*> ChartModel::row_items( int row ) const
+{
+  assert( row >= 0 && row < numRows_ );
+
+  QList<PatternGridItem*> rowItems;
+  int index = index_( 0, row );
+  int rowEnd = index + numCols_;
+  while ( index < rowEnd ) {
+    if ( items_[index] != 0 ) {
+      rowItems.push_back( items_[index] );
+    }
+    index += spans_[index];
+  }
+
+  return rowItems;
+}
+
+
+
+//-------------------------------------------------------------
+// return all items with their origin in the given column
+// ordered by row
+//-------------------------------------------------------------
+QList<PatternGridItem*> ChartModel::column_items( int col ) const
+{
+  assert( col >= 0 && col < numCols_ );
+
+  QList<PatternGridItem*> colItems;
+  for ( int index = col; index < spans_.size(); index += numCols_ ) {
+    if ( spans_[index] > 0 && items_[index] != 0 ) {
+      colItems.push_back( items_[index] );
+    }
+  }
+
+  return colItems;
+}
+
+
+
+//-------------------------------------------------------------
+// return all items in the grid in row-major order
+//-------------------------------------------------------------
+QList<PatternGridItem*> ChartModel::all_items() const
+{
+  QList<PatternGridItem*> allItems;
+  for ( int index = 0; index < spans_.size(); index += spans_[index] ) {
+    if ( items_[index] != 0 ) {
+      allItems.push_back( items_[index] );
+    }
+  }
+
+  return allItems;
+}
+
+
+
+//-------------------------------------------------------------
+// returns true if all chart cells in the column have unit
+// width, i.e., the column can be removed without cutting
+// through a wider cell
+//-------------------------------------------------------------
+bool ChartModel::is_unit_column( int col ) const
+{
+  assert( col >= 0 && col < numCols_ );
+
+  for ( int index = col; index < spans_.size(); index += numCols_ ) {
+    if ( spans_[index] != 1 ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// returns true if a chart cell starts at col in every row,
+// i.e., a column can be inserted in front of col without
+// cutting through a wider cell. The left and right edges
+// of the grid are always boundaries.
+//-------------------------------------------------------------
+bool ChartModel::is_column_boundary( int col ) const
+{
+  assert( col >= 0 && col <= numCols_ );
+
+  if ( col == 0 || col == numCols_ ) {
+    return true;
+  }
+
+  for ( int index = col; index < spans_.size(); index += numCols_ ) {
+    if ( spans_[index] <= 0 ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// insert count empty rows in front of row
+//-------------------------------------------------------------
+void ChartModel::insert_rows( int row, int count )
+{
+  assert( row >= 0 && row <= numRows_ );
+  assert( count >= 0 );
+
+  int index = index_( 0, row );
+  int numCells = count * numCols_;
+  symbolIds_.insert( index, numCells, 0 );
+  colorIds_.insert( index, numCells, 0 );
+  colorUses_[0] += numCells;
+  spans_.insert( index, numCells, 1 );
+  items_.insert( index, numCells, 0 );
+  numRows_ += count;
+}
+
+
+
+//-------------------------------------------------------------
+// remove count rows starting at row from the grid
+//-------------------------------------------------------------
+void ChartModel::delete_rows( int row, int count )
+{
+  assert( row >= 0 && row + count <= numRows_ );
+  assert( count >= 0 );
+
+  int index = index_( 0, row );
+  int numCells = count * numCols_;
+  release_colors_( index, numCells );
+  symbolIds_.remove( index, numCells );
+  colorIds_.remove( index, numCells );
+  spans_.remove( index, numCells );
+  items_.remove( index, numCells );
+  numRows_ -= count;
+}
+
+
+
+//-------------------------------------------------------------
+// insert count empty columns in front of col
+// NOTE: the caller has to make sure that col is a column
+// boundary (see is_column_boundary)
+//-------------------------------------------------------------
+void ChartModel::insert_columns( int col, int count )
+{
+  assert( is_column_boundary( col ) );
+  assert( count >= 0 );
+
+  insert_columns_into( symbolIds_, numCols_, numRows_, col, count,
+                       static_cast<quint16>( 0 ) );
+  insert_columns_into( colorIds_, numCols_, numRows_, col, count,
+                       static_cast<quint16>( 0 ) );
+  colorUses_[0] += count * numRows_;
+  insert_columns_into( spans_, numCols_, numRows_, col, count, 1 );
+  insert_columns_into( items_, numCols_, numRows_, col, count,
+                       static_cast<PatternGridItem*>( 0 ) );
+  numCols_ += count;
+}
+
+
+
+//-------------------------------------------------------------
+// remove count columns starting at col from the grid
+// NOTE: the caller has to make sure that no chart cell
+// sticks out of the removed block, i.e., col and col + count
+// are column boundaries (see is_column_boundary)
+//-------------------------------------------------------------
+void ChartModel::delete_columns( int col, int count )
+{
+  assert( count >= 0 );
+  assert( is_column_boundary( col ) );
+  assert( is_column_boundary( col + count ) );
+
+  for ( int row = 0; row < numRows_; ++row ) {
+    release_colors_( index_( col, row ), count );
+  }
+  delete_columns_from( symbolIds_, numCols_, numRows_, col, count );
+  delete_columns_from( colorIds_, numCols_, numRows_, col, count );
+  delete_columns_from( spans_, numCols_, numRows_, col, count );
+  delete_columns_from( items_, numCols_, numRows_, col, count );
+  numCols_ -= count;
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// return the array index of the origin of the chart cell
+// covering col, row
+//-------------------------------------------------------------
+int ChartModel::origin_index_( int col, int row ) const
+{
+  int index = index_( col, row );
+  int span = spans_[index];
+  return ( span > 0 ) ? index : index + span;
+}
+
+
+
+//-------------------------------------------------------------
+// return the id of a knitting symbol, adding it to the
+// symbol table if we haven't seen it before
+//-------------------------------------------------------------
+quint16 ChartModel::intern_symbol_( const KnittingSymbolPtr symbol )
+{
+  const KnittingSymbol* key = symbol.get();
+  if ( symbolLookup_.contains( key ) ) {
+    return symbolLookup_.value( key );
+  }
+
+  assert( symbolTable_.size() < 0xffff );
+  quint16 newId = static_cast<quint16>( symbolTable_.size() );
+  symbolTable_.push_back( symbol );
+  symbolLookup_[key] = newId;
+
+  return newId;
+}
+
+
+
+//-------------------------------------------------------------
+// return the palette id of a color, adding it to the palette
+// if it isn't in use yet. Ids released earlier are recycled
+// before the palette grows. New ids have no uses; the caller
+// has to account for the cells it gives the color.
+//-------------------------------------------------------------
+quint16 ChartModel::intern_color_( QRgb aColor )
+{
+  QHash<QRgb, quint16>::const_iterator pos =
+    paletteLookup_.constFind( aColor );
+  if ( pos != paletteLookup_.constEnd() ) {
+    return pos.value();
+  }
+
+  quint16 newId;
+  if ( !freeColorIds_.empty() ) {
+    newId = freeColorIds_.last();
+    freeColorIds_.remove( freeColorIds_.size() - 1 );
+    palette_[newId] = aColor;
+  } else {
+    assert( palette_.size() < 0xffff );
+    newId = static_cast<quint16>( palette_.size() );
+    palette_.push_back( aColor );
+    colorUses_.push_back( 0 );
+  }
+  paletteLookup_[aColor] = newId;
+
+  return newId;
+}
+
+
+
+//-------------------------------------------------------------
+// drop count uses of a palette id. Once no cell uses it any
+// more its color leaves the lookup and the id can be handed
+// out again; the empty cell color always stays.
+//-------------------------------------------------------------
+void ChartModel::release_color_( quint16 colorId, int count )
+{
+  colorUses_[colorId] -= count;
+  assert( colorUses_[colorId] >= 0 );
+
+  if ( colorUses_[colorId] == 0 && colorId != 0 ) {
+    paletteLookup_.remove( palette_[colorId] );
+    freeColorIds_.push_back( colorId );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// drop the uses of the count unit cells starting at index,
+// e.g. before they are deleted
+//-------------------------------------------------------------
+void ChartModel::release_colors_( int index, int count )
+{
+  const quint16* ids = colorIds_.constData() + index;
+  for ( int offset = 0; offset < count; ++offset ) {
+    release_color_( ids[offset] );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// reset a single unit cell to its empty state
+//-------------------------------------------------------------
+void ChartModel::clear_unit_cell_( int index )
+{
+  release_color_( colorIds_[index] );
+  ++colorUses_[0];
+  symbolIds_[index] = 0;
+  colorIds_[index] = 0;
+  spans_[index] = 1;
+  items_[index] = 0;
+}
+
+
+
+QT_END_NAMESPACE
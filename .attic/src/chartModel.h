@@ -0,0 +1,179 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+#ifndef CHART_MODEL_H
+#define CHART_MODEL_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* a few forward declarations */
+class PatternGridItem;
+
+
+/***************************************************************
+ *
+ * ChartModel holds the content of the pattern grid independent
+ * of the QGraphicsItems used to display it. Cells are stored
+ * row-major in flat arrays (symbol id, color id, span) so that
+ * looking up a cell, a row or a column is a matter of index
+ * arithmetic instead of a walk over all scene items.
+ *
+ * Colors are kept in a palette of distinct colors and cells
+ * only store their palette index. Entry 0 is the color of
+ * empty cells.
+ *
+ * Each cell in the grid belongs to exactly one chart cell. The
+ * origin (leftmost unit cell) of a chart cell stores its width
+ * in the span array, all other unit cells covered by it store
+ * the negative offset to their origin.
+ *
+ ***************************************************************/
+class ChartModel
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  explicit ChartModel( int numCols = 0, int numRows = 0 );
+  bool Init();
+
+  /* nuke the current content and start over with an empty
+   * grid of the requested size */
+  void reset( int numCols, int numRows );
+
+  /* returns true if a chart of numCols x numRows is not
+   * empty and small enough to be created, i.e., has at
+   * most MAX_CHART_CELLS unit cells */
+  static bool valid_dimensions( int numCols, int numRows );
+
+  /* basic dimensions */
+  int num_columns() const { return numCols_; }
+  int num_rows() const { return numRows_; }
+  bool contains( int col, int row ) const;
+
+  /* place a chart cell of the given width with its origin
+   * at col, row */
+  void set_cell( int col, int row, int width,
+                 const KnittingSymbolPtr symbol, const QColor& color,
+                 PatternGridItem* item = 0 );
+
+  /* turn the chart cell covering col, row back into empty
+   * unit cells */
+  void clear_cell( int col, int row );
+
+  /* change the color of the chart cell covering col, row */
+  void set_color( int col, int row, const QColor& color );
+
+  /* give all cells of color oldColor the color newColor. This
+   * is a single palette edit unless newColor is already in use
+   * or oldColor is the empty cell color */
+  void replace_color( const QColor& oldColor, const QColor& newColor );
+
+  /* attach or detach the item displaying the chart cell
+   * covering col, row */
+  void set_item( int col, int row, PatternGridItem* item );
+
+  /* per cell queries; all of them work for any unit cell
+   * covered by a chart cell */
+  int origin_column( int col, int row ) const;
+  int width( int col, int row ) const;
+  KnittingSymbolPtr symbol( int col, int row ) const;
+  bool is_empty( int col, int row ) const;
+  QRgb color( int col, int row ) const;
+  int color_index( int col, int row ) const;
+  PatternGridItem* item( int col, int row ) const;
+
+  /* the palette indexed by color_index. Ids of colors no
+   * cell uses any more are handed out again, until then their
+   * entries are stale */
+  const QVector<QRgb>& palette() const { return palette_; }
+
+  /* row and column queries */
+  QList<PatternGridItem*> row_items( int row ) const;
+  QList<PatternGridItem*> column_items( int col ) const;
+  QList<PatternGridItem*> all_items() const;
+  bool is_unit_column( int col ) const;
+  bool is_column_boundary( int col ) const;
+
+  /* structural changes on blocks of count rows or columns;
+   * newly created unit cells are empty and the caller is
+   * responsible for filling them */
+  void insert_rows( int row, int count = 1 );
+  void delete_rows( int row, int count = 1 );
+  void insert_columns( int col, int count = 1 );
+  void delete_columns( int col, int count = 1 );
+
+
+private:
+
+  /* construction status variable */
+  int status_;
+
+  /* grid dimensions */
+  int numCols_;
+  int numRows_;
+
+  /* row-major cell storage */
+  QVector<quint16> symbolIds_;
+  QVector<quint16> colorIds_;
+  QVector<int> spans_;
+  QVector<PatternGridItem*> items_;
+
+  /* symbol table; id 0 is the empty symbol */
+  QList<KnittingSymbolPtr> symbolTable_;
+  QHash<const KnittingSymbol*, quint16> symbolLookup_;
+
+  /* color palette; id 0 is the empty cell color. colorUses_
+   * counts the unit cells of each id so ids can be recycled
+   * as soon as their color is gone from the chart */
+  QVector<QRgb> palette_;
+  QHash<QRgb, quint16> paletteLookup_;
+  QVector<int> colorUses_;
+  QVector<quint16> freeColorIds_;
+
+  /* helper functions */
+  int index_( int col, int row ) const { return row * numCols_ + col; }
+  int origin_index_( int col, int row ) const;
+  quint16 intern_symbol_( const KnittingSymbolPtr symbol );
+  quint16 intern_color_( QRgb color );
+  void release_color_( quint16 colorId, int count = 1 );
+  void release_colors_( int index, int count );
+  void clear_unit_cell_( int index );
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,284 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QtAlgorithms>
+
+/* local headers */
+#include "basicDefs.h"
+#include "chartModel.h"
+#include "chartSelection.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+ChartSelection::ChartSelection( const ChartModel& aChart )
+    :
+    chart_( aChart ),
+    numCells_( 0 )
+{
+  status_ = SUCCESSFULLY_CONSTRUCTED;
+}
+
+
+
+//--------------------------------------------------------------
+// main initialization routine
+//--------------------------------------------------------------
+bool ChartSelection::Init()
+{
+  if ( status_ != SUCCESSFULLY_CONSTRUCTED ) {
+    return false;
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// deselect everything. The rows are only allocated again on
+// the next selection so we always match the current chart.
+//-------------------------------------------------------------
+void ChartSelection::clear()
+{
+  rows_.clear();
+  numCells_ = 0;
+}
+
+
+
+//-------------------------------------------------------------
+// apply mode to all chart cells touching the rectangle
+// spanned by firstCol, firstRow and lastCol, lastRow. Parts
+// outside the chart are ignored.
+//-------------------------------------------------------------
+void ChartSelection::select_rectangle( int firstCol, int firstRow,
+                                       int lastCol, int lastRow,
+                                       Mode mode )
+{
+  firstCol = qMax( firstCol, 0 );
+  firstRow = qMax( firstRow, 0 );
+  lastCol  = qMin( lastCol, chart_.num_columns() - 1 );
+  lastRow  = qMin( lastRow, chart_.num_rows() - 1 );
+  if ( firstCol > lastCol || firstRow > lastRow ) {
+    return;
+  }
+
+  if ( rows_.size() != chart_.num_rows() ) {
+    assert( numCells_ == 0 );
+    rows_.resize( chart_.num_rows() );
+  }
+
+  for ( int row = firstRow; row <= lastRow; ++row ) {
+    int start = chart_.origin_column( firstCol, row );
+    int lastOrigin = chart_.origin_column( lastCol, row );
+    int end = lastOrigin + chart_.width( lastOrigin, row );
+    combine_row_( row, start, end, mode );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// convenience wrappers around select_rectangle
+//-------------------------------------------------------------
+void ChartSelection::select_row( int row, Mode mode )
+{
+  select_rectangle( 0, row, chart_.num_columns() - 1, row, mode );
+}
+
+
+void ChartSelection::select_column( int col, Mode mode )
+{
+  select_rectangle( col, 0, col, chart_.num_rows() - 1, mode );
+}
+
+
+void ChartSelection::select_all( Mode mode )
+{
+  select_rectangle( 0, 0, chart_.num_columns() - 1,
+                    chart_.num_rows() - 1, mode );
+}
+
+
+void ChartSelection::toggle_cell( int col, int row )
+{
+  select_rectangle( col, row, col, row, Toggle );
+}
+
+
+
+//-------------------------------------------------------------
+// check if the unit cell at col, row is selected
+//-------------------------------------------------------------
+bool ChartSelection::is_selected( int col, int row ) const
+{
+  foreach( SelectionRun run, row_runs( row ) ) {
+    if ( col < run.first ) {
+      return false;
+    } else if ( col < run.first + run.second ) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+
+//-------------------------------------------------------------
+// return the selected runs of row ordered by column
+//-------------------------------------------------------------
+const SelectionRuns& ChartSelection::row_runs( int row ) const
+{
+  if ( row < 0 || row >= rows_.size() ) {
+    return noRuns_;
+  }
+
+  return rows_.at( row );
+}
+
+
+
+//-------------------------------------------------------------
+// the selection is a rectangle if all rows between the first
+// and last one with selected cells have exactly the same
+// single run
+//-------------------------------------------------------------
+bool ChartSelection::bounding_rectangle( QRect& bounds ) const
+{
+  int firstRow = -1;
+  int lastRow  = -1;
+  for ( int row = 0; row < rows_.size(); ++row ) {
+    if ( !rows_.at( row ).empty() ) {
+      if ( firstRow < 0 ) {
+        firstRow = row;
+      }
+      lastRow = row;
+    }
+  }
+
+  if ( firstRow < 0 || rows_.at( firstRow ).size() != 1 ) {
+    return false;
+  }
+
+  const SelectionRuns& topRow = rows_.at( firstRow );
+  for ( int row = firstRow + 1; row <= lastRow; ++row ) {
+    if ( rows_.at( row ) != topRow ) {
+      return false;
+    }
+  }
+
+  bounds = QRect( topRow.first().first, firstRow,
+                  topRow.first().second, lastRow - firstRow + 1 );
+  return true;
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// combine the runs of row with the unit cells [start, end)
+// according to mode. We sweep over the segments between all
+// run and range boundaries; within each segment both the old
+// and the new state are constant.
+//-------------------------------------------------------------
+void ChartSelection::combine_row_( int row, int start, int end,
+                                   Mode mode )
+{
+  const SelectionRuns& oldRuns = rows_.at( row );
+
+  QVector<int> bounds;
+  bounds.reserve( 2 * oldRuns.size() + 2 );
+  int oldCount = 0;
+  foreach( SelectionRun run, oldRuns ) {
+    bounds.push_back( run.first );
+    bounds.push_back( run.first + run.second );
+    oldCount += run.second;
+  }
+  bounds.push_back( start );
+  bounds.push_back( end );
+  qSort( bounds );
+
+  SelectionRuns newRuns;
+  int newCount = 0;
+  int runIndex = 0;
+  for ( int index = 0; index + 1 < bounds.size(); ++index ) {
+    int segStart = bounds.at( index );
+    int segEnd = bounds.at( index + 1 );
+    if ( segStart == segEnd ) {
+      continue;
+    }
+
+    while ( runIndex < oldRuns.size()
+            && oldRuns.at( runIndex ).first + oldRuns.at( runIndex ).second
+            <= segStart ) {
+      ++runIndex;
+    }
+
+    bool wasSelected = ( runIndex < oldRuns.size()
+                         && oldRuns.at( runIndex ).first <= segStart );
+    bool inRange = ( segStart >= start && segStart < end );
+
+    bool selected = wasSelected;
+    if ( mode == Select ) {
+      selected = wasSelected || inRange;
+    } else if ( mode == Deselect ) {
+      selected = wasSelected && !inRange;
+    } else {
+      selected = ( wasSelected != inRange );
+    }
+
+    if ( !selected ) {
+      continue;
+    }
+
+    /* extend the last run if we're adjacent to it */
+    if ( !newRuns.empty()
+         && newRuns.last().first + newRuns.last().second == segStart ) {
+      newRuns.last().second += segEnd - segStart;
+    } else {
+      newRuns.push_back( SelectionRun( segStart, segEnd - segStart ) );
+    }
+    newCount += segEnd - segStart;
+  }
+
+  numCells_ += newCount - oldCount;
+  rows_[row] = newRuns;
+}
+
+
+QT_END_NAMESPACE
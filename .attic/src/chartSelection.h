@@ -0,0 +1,124 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef CHART_SELECTION_H
+#define CHART_SELECTION_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QList>
+#include <QPair>
+#include <QRect>
+#include <QVector>
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* a few forward declarations */
+class ChartModel;
+
+
+/* a run of selected unit cells within a row given as
+ * ( first column, number of columns ) */
+typedef QPair<int, int> SelectionRun;
+typedef QList<SelectionRun> SelectionRuns;
+
+
+/***************************************************************
+ *
+ * ChartSelection keeps track of the selected cells of a
+ * ChartModel. Each row stores its selected cells as a sorted
+ * list of disjoint runs of unit cells, so selecting a row, a
+ * column, a rectangle or the whole chart only touches each
+ * affected row once instead of every cell in it.
+ *
+ * Rectangles are always widened to whole chart cells, i.e. if
+ * one of its unit cells is hit a chart cell spanning several
+ * columns is selected as a whole.
+ *
+ ***************************************************************/
+class ChartSelection
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  /* how a selection request combines with what is already
+   * selected */
+  enum Mode { Select, Deselect, Toggle };
+
+  explicit ChartSelection( const ChartModel& chart );
+  bool Init();
+
+  /* the chart we are selecting from */
+  const ChartModel& chart() const { return chart_; }
+
+  /* deselect everything; needs to be called whenever the
+   * dimensions of the chart change */
+  void clear();
+
+  /* select rectangles of chart cells; firstCol/lastCol and
+   * firstRow/lastRow are inclusive */
+  void select_rectangle( int firstCol, int firstRow, int lastCol,
+                         int lastRow, Mode mode = Select );
+  void select_row( int row, Mode mode = Select );
+  void select_column( int col, Mode mode = Select );
+  void select_all( Mode mode = Select );
+  void invert() { select_all( Toggle ); }
+  void toggle_cell( int col, int row );
+
+  /* queries */
+  bool is_empty() const { return numCells_ == 0; }
+  int num_cells() const { return numCells_; }
+  bool is_selected( int col, int row ) const;
+  const SelectionRuns& row_runs( int row ) const;
+
+  /* returns true if the selection is a single rectangle of
+   * unit cells and if so sets bounds to it (in cell coordinates) */
+  bool bounding_rectangle( QRect& bounds ) const;
+
+
+private:
+
+  /* construction status variable */
+  int status_;
+
+  /* the chart we are selecting from */
+  const ChartModel& chart_;
+
+  /* selected runs per row and total number of selected
+   * unit cells */
+  QVector<SelectionRuns> rows_;
+  int numCells_;
+  SelectionRuns noRuns_;
+
+  /* helper functions */
+  void combine_row_( int row, int start, int end, Mode mode );
+};
+
+
+QT_END_NAMESPACE
+
+#endif
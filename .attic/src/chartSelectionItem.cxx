@@ -0,0 +1,226 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* C++ headers */
+#include <cmath>
+
+/* Qt headers */
+#include <QColor>
+#include <QPainter>
+#include <QRegion>
+#include <QStyleOptionGraphicsItem>
+
+/* local headers */
+#include "chartModel.h"
+#include "chartSelection.h"
+#include "chartSelectionItem.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+ChartSelectionItem::ChartSelectionItem( const ChartSelection& aSelection,
+                                        const QPoint& anOrigin,
+                                        const QSize& cellDimensions )
+    :
+    QGraphicsItem(),
+    selection_( aSelection ),
+    origin_( anOrigin ),
+    cellDimensions_( cellDimensions )
+{
+  status_ = SUCCESSFULLY_CONSTRUCTED;
+}
+
+
+
+//--------------------------------------------------------------
+// main initialization routine
+//--------------------------------------------------------------
+bool ChartSelectionItem::Init()
+{
+  if ( status_ != SUCCESSFULLY_CONSTRUCTED ) {
+    return false;
+  }
+
+  /* we need the exposed rectangle for painting */
+  setFlags( QGraphicsItem::ItemUsesExtendedStyleOption );
+
+  /* clicks go to the cells underneath */
+  setAcceptedMouseButtons( 0 );
+
+  /* above the cells but below marker rectangles */
+  setZValue( 0.5 );
+
+  brush_ = QBrush( QColor( 128, 128, 128, 160 ) );
+  previewBrush_ = QBrush( QColor( 0, 0, 255, 80 ) );
+
+  return true;
+}
+
+
+
+//--------------------------------------------------------------
+// return our custom type
+//--------------------------------------------------------------
+int ChartSelectionItem::type() const
+{
+  return Type;
+}
+
+
+
+//------------------------------------------------------------
+// our bounding rectangle covers the whole pattern grid
+//------------------------------------------------------------
+QRectF ChartSelectionItem::boundingRect() const
+{
+  const ChartModel& chart = selection_.chart();
+  return QRectF( origin_.x(), origin_.y(),
+                 cellDimensions_.width() * chart.num_columns(),
+                 cellDimensions_.height() * chart.num_rows() );
+}
+
+
+
+//------------------------------------------------------------
+// paint all selected runs intersecting the exposed rectangle
+//------------------------------------------------------------
+void ChartSelectionItem::paint( QPainter *painter,
+                                const QStyleOptionGraphicsItem *option,
+                                QWidget *widget )
+{
+  Q_UNUSED( widget );
+
+  QRectF exposed = option->exposedRect;
+  painter->setPen( Qt::NoPen );
+
+  if ( !preview_.isNull() ) {
+    painter->setBrush( previewBrush_ );
+    painter->drawRect( QRectF( scene_rect_( preview_ ) ).intersected( exposed ) );
+  }
+
+  if ( selection_.is_empty() ) {
+    return;
+  }
+
+  /* figure out which rows are exposed */
+  double cellWidth = cellDimensions_.width();
+  double cellHeight = cellDimensions_.height();
+
+  int firstRow = static_cast<int>(
+                   floor(( exposed.top() - origin_.y() ) / cellHeight ) );
+  int lastRow = static_cast<int>(
+                  floor(( exposed.bottom() - origin_.y() ) / cellHeight ) );
+  firstRow = qMax( firstRow, 0 );
+  lastRow = qMin( lastRow, selection_.chart().num_rows() - 1 );
+
+  painter->setBrush( brush_ );
+  for ( int row = firstRow; row <= lastRow; ++row ) {
+    foreach( SelectionRun run, selection_.row_runs( row ) ) {
+      QRectF runRect( origin_.x() + run.first * cellWidth,
+                      origin_.y() + row * cellHeight,
+                      run.second * cellWidth, cellHeight );
+      if ( runRect.intersects( exposed ) ) {
+        painter->drawRect( runRect );
+      }
+    }
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// let the scene know that our size changed
+//-------------------------------------------------------------
+void ChartSelectionItem::update_geometry()
+{
+  prepareGeometryChange();
+  update();
+}
+
+
+
+//-------------------------------------------------------------
+// schedule a repaint of the full width of a band of rows
+//-------------------------------------------------------------
+void ChartSelectionItem::update_rows( int firstRow, int lastRow )
+{
+  update( origin_.x(), origin_.y() + firstRow * cellDimensions_.height(),
+          selection_.chart().num_columns() * cellDimensions_.width(),
+          ( lastRow - firstRow + 1 ) * cellDimensions_.height() );
+}
+
+
+
+//-------------------------------------------------------------
+// change the previewed cells. Only the area that differs
+// between the old and the new preview is repainted.
+//-------------------------------------------------------------
+void ChartSelectionItem::set_preview( const QRect& cells )
+{
+  if ( cells == preview_ ) {
+    return;
+  }
+
+  QRegion dirty = QRegion( scene_rect_( preview_ ) )
+                  ^ QRegion( scene_rect_( cells ) );
+  preview_ = cells;
+
+  foreach( QRect dirtyRect, dirty.rects() ) {
+    update( dirtyRect );
+  }
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// convert a rectangle in cell coordinates into scene
+// coordinates
+//-------------------------------------------------------------
+QRect ChartSelectionItem::scene_rect_( const QRect& cells ) const
+{
+  if ( cells.isNull() ) {
+    return QRect();
+  }
+
+  return QRect( origin_.x() + cells.x() * cellDimensions_.width(),
+                origin_.y() + cells.y() * cellDimensions_.height(),
+                cells.width() * cellDimensions_.width(),
+                cells.height() * cellDimensions_.height() );
+}
+
+
+
+QT_END_NAMESPACE
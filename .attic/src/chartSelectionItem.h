@@ -0,0 +1,112 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef CHART_SELECTION_ITEM_H
+#define CHART_SELECTION_ITEM_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QBrush>
+#include <QGraphicsItem>
+#include <QRect>
+
+/* local includes */
+#include "basicDefs.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* a few forward declarations */
+class ChartSelection;
+class QPainter;
+class QStyleOptionGraphicsItem;
+
+
+/***************************************************************
+ *
+ * ChartSelectionItem highlights the cells of a ChartSelection.
+ * It sits on top of the pattern grid and paints one rectangle
+ * per selected run inside the exposed area, so the cells
+ * themselves don't need to know whether they are selected.
+ *
+ ***************************************************************/
+class ChartSelectionItem
+    :
+    public QGraphicsItem,
+    public boost::noncopyable
+{
+
+public:
+
+  explicit ChartSelectionItem( const ChartSelection& selection,
+                               const QPoint& origin,
+                               const QSize& cellDimensions );
+  bool Init();
+
+  /* return our object type; needed for qgraphicsitem_cast */
+  enum { Type = UserType + CHART_SELECTION_ITEM_TYPE };
+  int type() const;
+
+  /* reimplement pure virtual base class methods */
+  QRectF boundingRect() const;
+  void paint( QPainter *painter,
+              const QStyleOptionGraphicsItem *option, QWidget *widget );
+
+  /* call after the grid dimensions or cell size changed */
+  void update_geometry();
+
+  /* repaint the rows firstRow to lastRow */
+  void update_rows( int firstRow, int lastRow );
+
+  /* show a preview of a selection rectangle (in cell
+   * coordinates) on top of the selection; a null rectangle
+   * hides it */
+  void set_preview( const QRect& cells );
+
+
+private:
+
+  /* some tracking variables */
+  int status_;
+
+  /* the selection we are drawing */
+  const ChartSelection& selection_;
+  QPoint origin_;
+  const QSize& cellDimensions_;
+
+  /* currently previewed cells */
+  QRect preview_;
+
+  /* drawing related objects */
+  QBrush brush_;
+  QBrush previewBrush_;
+
+  /* helper functions */
+  QRect scene_rect_( const QRect& cells ) const;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,318 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* local headers */
+#include "basicDefs.h"
+#include "editJournal.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+EditJournal::EditJournal()
+    :
+    undoPosition_( 0 ),
+    usedBytes_( 0 ),
+    budgetBytes_( UNDO_JOURNAL_BUDGET * 1024 ),
+    openKind_( Unmergeable ),
+    stepIsOpen_( false ),
+    lastKind_( Unmergeable ),
+    mergeInterval_( UNDO_MERGE_INTERVAL )
+{
+  status_ = SUCCESSFULLY_CONSTRUCTED;
+}
+
+
+
+//--------------------------------------------------------------
+// main initialization routine
+//--------------------------------------------------------------
+bool EditJournal::Init()
+{
+  if ( status_ != SUCCESSFULLY_CONSTRUCTED ) {
+    return false;
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// change the memory budget and drop old steps if we are
+// above it
+//-------------------------------------------------------------
+void EditJournal::set_budget( int kB )
+{
+  budgetBytes_ = qMax( kB, 1 ) * 1024;
+  enforce_budget_();
+}
+
+
+
+//-------------------------------------------------------------
+// forget the whole history
+//-------------------------------------------------------------
+void EditJournal::clear()
+{
+  steps_.clear();
+  stepSizes_.clear();
+  undoPosition_ = 0;
+  usedBytes_ = 0;
+
+  openStep_.clear();
+  stepIsOpen_ = false;
+  lastKind_ = Unmergeable;
+
+  symbols_.clear();
+  symbolLookup_.clear();
+}
+
+
+
+//-------------------------------------------------------------
+// start recording a new step
+//-------------------------------------------------------------
+void EditJournal::begin_step( StepKind kind )
+{
+  assert( !stepIsOpen_ );
+
+  openStep_.clear();
+  openKind_ = kind;
+  stepIsOpen_ = true;
+}
+
+
+
+//-------------------------------------------------------------
+// add an op to the step currently being recorded
+//-------------------------------------------------------------
+void EditJournal::add_op( const JournalOp& op )
+{
+  assert( stepIsOpen_ );
+
+  openStep_.push_back( op );
+}
+
+
+
+//-------------------------------------------------------------
+// push the step currently being recorded onto the history.
+// Steps that didn't change anything are dropped and quick
+// repeats of the previous step on the same cells are merged
+// with it.
+//-------------------------------------------------------------
+void EditJournal::end_step()
+{
+  assert( stepIsOpen_ );
+
+  JournalStep step( openStep_ );
+  openStep_.clear();
+  stepIsOpen_ = false;
+
+  bool changed = false;
+  foreach( JournalOp op, step ) {
+    if ( op.type != JournalOp::Cells || op.before != op.after ) {
+      changed = true;
+      break;
+    }
+  }
+
+  if ( !changed ) {
+    return;
+  }
+
+  drop_redo_steps_();
+  if ( !merge_into_last_step_( step ) ) {
+    int size = step_size_( step );
+    steps_.push_back( step );
+    stepSizes_.push_back( size );
+    usedBytes_ += size;
+    ++undoPosition_;
+  }
+
+  lastKind_ = openKind_;
+  lastStepTime_.start();
+
+  enforce_budget_();
+}
+
+
+
+//-------------------------------------------------------------
+// return the step to be reverted next
+//-------------------------------------------------------------
+const JournalStep& EditJournal::undo_step()
+{
+  assert( can_undo() );
+
+  lastKind_ = Unmergeable;
+  --undoPosition_;
+  return steps_.at( undoPosition_ );
+}
+
+
+
+//-------------------------------------------------------------
+// return the step to be re-applied next
+//-------------------------------------------------------------
+const JournalStep& EditJournal::redo_step()
+{
+  assert( can_redo() );
+
+  lastKind_ = Unmergeable;
+  ++undoPosition_;
+  return steps_.at( undoPosition_ - 1 );
+}
+
+
+
+//-------------------------------------------------------------
+// return the journal id of symbol
+//-------------------------------------------------------------
+quint16 EditJournal::intern( const KnittingSymbolPtr symbol )
+{
+  const KnittingSymbol* key = symbol.get();
+  QHash<const KnittingSymbol*, quint16>::const_iterator pos =
+    symbolLookup_.constFind( key );
+  if ( pos != symbolLookup_.constEnd() ) {
+    return pos.value();
+  }
+
+  quint16 id = symbols_.size();
+  symbols_.push_back( symbol );
+  symbolLookup_[key] = id;
+  return id;
+}
+
+
+
+//-------------------------------------------------------------
+// return the symbol with journal id
+//-------------------------------------------------------------
+KnittingSymbolPtr EditJournal::symbol( quint16 id ) const
+{
+  return symbols_.at( id );
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// if step is of the same mergeable kind as the last step,
+// follows it within the merge interval, only changes cells
+// and covers exactly the same cells we fold it into the
+// latter. This way e.g. trying out a few colors on the same
+// selection is undone in one go.
+//-------------------------------------------------------------
+bool EditJournal::merge_into_last_step_( const JournalStep& step )
+{
+  if ( openKind_ == Unmergeable || openKind_ != lastKind_
+       || lastStepTime_.elapsed() > mergeInterval_ ) {
+    return false;
+  }
+
+  if ( steps_.empty() || steps_.last().size() != step.size() ) {
+    return false;
+  }
+
+  JournalStep& lastStep = steps_.last();
+  for ( int index = 0; index < step.size(); ++index ) {
+    const JournalOp& lastOp = lastStep.at( index );
+    const JournalOp& op = step.at( index );
+    if ( lastOp.type != JournalOp::Cells || op.type != JournalOp::Cells
+         || lastOp.row != op.row || lastOp.column != op.column
+         || lastOp.count != op.count ) {
+      return false;
+    }
+  }
+
+  for ( int index = 0; index < step.size(); ++index ) {
+    lastStep[index].after = step.at( index ).after;
+  }
+
+  int size = step_size_( lastStep );
+  usedBytes_ += size - stepSizes_.last();
+  stepSizes_.last() = size;
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// a new step invalidates everything that could be redone
+//-------------------------------------------------------------
+void EditJournal::drop_redo_steps_()
+{
+  while ( steps_.size() > undoPosition_ ) {
+    steps_.removeLast();
+    usedBytes_ -= stepSizes_.takeLast();
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// drop the oldest steps until we are within budget. The most
+// recent step is always kept.
+//-------------------------------------------------------------
+void EditJournal::enforce_budget_()
+{
+  while ( usedBytes_ > budgetBytes_ && steps_.size() > 1
+          && undoPosition_ > 1 ) {
+    steps_.removeFirst();
+    usedBytes_ -= stepSizes_.takeFirst();
+    --undoPosition_;
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// estimate the memory used by step (in bytes)
+//-------------------------------------------------------------
+int EditJournal::step_size_( const JournalStep& step ) const
+{
+  int size = 0;
+  foreach( JournalOp op, step ) {
+    size += sizeof( JournalOp )
+            + ( op.before.size() + op.after.size() ) * sizeof( JournalCell );
+  }
+
+  return size;
+}
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,169 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QTime>
+#include <QVector>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* a chart cell as recorded in the journal; symbols are
+ * interned by the journal */
+struct JournalCell {
+  qint32 width;
+  quint16 symbol;
+  QRgb color;
+};
+typedef QVector<JournalCell> JournalCells;
+
+inline bool operator==( const JournalCell& a, const JournalCell& b )
+{
+  return a.width == b.width && a.symbol == b.symbol && a.color == b.color;
+}
+
+
+/* a single change to the chart. Cells changes the chart cells
+ * in the unit columns [column, column + count) of row from
+ * before to after, the remaining types insert or delete count
+ * rows/columns at row/column. For deletes before holds the
+ * deleted cells row by row. */
+struct JournalOp {
+  enum Type { Cells, InsertRows, DeleteRows, InsertColumns,
+              DeleteColumns };
+
+  Type type;
+  int row;
+  int column;
+  int count;
+  JournalCells before;
+  JournalCells after;
+};
+typedef QList<JournalOp> JournalStep;
+
+
+
+/***************************************************************
+ *
+ * EditJournal keeps the undo/redo history of a chart as
+ * compact diffs. Each step is a list of JournalOps covering
+ * only the cells that changed. The history is capped by a
+ * memory budget; once it is exceeded the oldest steps are
+ * dropped.
+ *
+ ***************************************************************/
+class EditJournal
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  /* kinds of steps. A step is only merged into the previous
+   * one if both are of the same mergeable kind, change the
+   * same cells and follow each other within the merge
+   * interval */
+  enum StepKind { Unmergeable, PlaceSymbol, Recolor };
+
+  explicit EditJournal();
+  bool Init();
+
+  /* memory budget for the whole history (in kB) */
+  void set_budget( int kB );
+
+  /* maximum time (in ms) between two merged steps */
+  void set_merge_interval( int msecs ) { mergeInterval_ = msecs; }
+
+  /* forget the whole history */
+  void clear();
+
+  /* record a new step. Ops are added to the open step which
+   * is pushed by end_step */
+  void begin_step( StepKind kind = Unmergeable );
+  bool step_is_open() const { return stepIsOpen_; }
+  void add_op( const JournalOp& op );
+  JournalStep& open_step() { return openStep_; }
+  void end_step();
+
+  /* move through the history; the returned step has to be
+   * reverted (undo) or re-applied (redo) by the caller */
+  bool can_undo() const { return undoPosition_ > 0; }
+  bool can_redo() const { return undoPosition_ < steps_.size(); }
+  const JournalStep& undo_step();
+  const JournalStep& redo_step();
+
+  /* symbol interning */
+  quint16 intern( const KnittingSymbolPtr symbol );
+  KnittingSymbolPtr symbol( quint16 id ) const;
+
+
+private:
+
+  /* construction status variable */
+  int status_;
+
+  /* the history; steps before undoPosition_ are done, the
+   * others can be redone */
+  QList<JournalStep> steps_;
+  QList<int> stepSizes_;
+  int undoPosition_;
+  int usedBytes_;
+  int budgetBytes_;
+
+  /* step currently being recorded */
+  JournalStep openStep_;
+  StepKind openKind_;
+  bool stepIsOpen_;
+
+  /* kind and time of the most recently recorded step; reset
+   * to Unmergeable once we move through the history */
+  StepKind lastKind_;
+  QTime lastStepTime_;
+  int mergeInterval_;
+
+  /* symbol table */
+  QList<KnittingSymbolPtr> symbols_;
+  QHash<const KnittingSymbol*, quint16> symbolLookup_;
+
+  /* helper functions */
+  bool merge_into_last_step_( const JournalStep& step );
+  void drop_redo_steps_();
+  void enforce_budget_();
+  int step_size_( const JournalStep& step ) const;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
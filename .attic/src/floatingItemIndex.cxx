@@ -0,0 +1,139 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QGraphicsItem>
+
+/* local headers */
+#include "floatingItemIndex.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+FloatingItemIndex::FloatingItemIndex()
+{
+}
+
+
+
+//-------------------------------------------------------------
+// register a new item. Items are kept sorted by z value;
+// among items with equal z value the most recently inserted
+// one is on top, which matches the scene's stacking order.
+//-------------------------------------------------------------
+void FloatingItemIndex::insert( QGraphicsItem* anItem )
+{
+  int position = items_.size();
+  while ( position > 0
+          && items_.at( position - 1 )->zValue() > anItem->zValue() ) {
+    --position;
+  }
+
+  items_.insert( position, anItem );
+}
+
+
+
+//-------------------------------------------------------------
+// unregister an item
+//-------------------------------------------------------------
+void FloatingItemIndex::remove( QGraphicsItem* anItem )
+{
+  items_.removeAll( anItem );
+}
+
+
+
+//-------------------------------------------------------------
+// forget all items
+//-------------------------------------------------------------
+void FloatingItemIndex::clear()
+{
+  items_.clear();
+}
+
+
+
+//-------------------------------------------------------------
+// return all visible items containing pos
+//-------------------------------------------------------------
+QList<QGraphicsItem*> FloatingItemIndex::items_at( const QPointF& pos ) const
+{
+  QList<QGraphicsItem*> hits;
+  for ( int index = items_.size() - 1; index >= 0; --index ) {
+    if ( hit_( items_.at( index ), pos ) ) {
+      hits.push_back( items_.at( index ) );
+    }
+  }
+
+  return hits;
+}
+
+
+
+//-------------------------------------------------------------
+// return the topmost visible item containing pos; unlike
+// items_at we stop at the first hit
+//-------------------------------------------------------------
+QGraphicsItem* FloatingItemIndex::item_at( const QPointF& pos ) const
+{
+  for ( int index = items_.size() - 1; index >= 0; --index ) {
+    if ( hit_( items_.at( index ), pos ) ) {
+      return items_.at( index );
+    }
+  }
+
+  return 0;
+}
+
+
+
+/**************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// returns true if anItem is visible and its shape contains
+// pos. The cheap bounding rect test comes first so only items
+// close to pos have to map it into their coordinates.
+//-------------------------------------------------------------
+bool FloatingItemIndex::hit_( const QGraphicsItem* anItem,
+                              const QPointF& pos ) const
+{
+  return anItem->isVisible()
+         && anItem->sceneBoundingRect().contains( pos )
+         && anItem->contains( anItem->mapFromScene( pos ) );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,98 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+
+#ifndef FLOATING_ITEM_INDEX_H
+#define FLOATING_ITEM_INDEX_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QList>
+#include <QPointF>
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* forward declarations */
+class QGraphicsItem;
+
+
+/***************************************************************
+ *
+ * FloatingItemIndex keeps track of the scene items that are
+ * not tied to the chart lattice, i.e., marker rectangles and
+ * legend items and labels. Chart cells are located directly
+ * via their grid coordinates; this index answers the
+ * remaining point queries without going through
+ * the scene's BSP tree, so their cost only depends on the
+ * (small) number of floating items and not on the size of
+ * the chart.
+ *
+ * Since legend items can be dragged around we don't cache
+ * any geometry but ask the items for it at query time. An
+ * item only has to map the point into its own coordinates if
+ * its scene bounding rect contains it.
+ *
+ * Hits are tested against the items' shape(). Legend items
+ * and labels are solid; marker rectangles only consist of
+ * their line, so the cells inside of them stay clickable.
+ * Whatever this index reports at a point blocks plain clicks
+ * on the chart cell beneath.
+ *
+ ***************************************************************/
+class FloatingItemIndex
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  explicit FloatingItemIndex();
+
+  /* register or unregister an item */
+  void insert( QGraphicsItem* anItem );
+  void remove( QGraphicsItem* anItem );
+  void clear();
+
+  /* all visible items whose shape contains pos, topmost
+   * first */
+  QList<QGraphicsItem*> items_at( const QPointF& pos ) const;
+
+  /* the topmost visible item whose shape contains pos or
+   * 0 if there is none */
+  QGraphicsItem* item_at( const QPointF& pos ) const;
+
+
+private:
+
+  /* registered items in stacking order, bottom first */
+  QList<QGraphicsItem*> items_;
+
+  bool hit_( const QGraphicsItem* anItem, const QPointF& pos ) const;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
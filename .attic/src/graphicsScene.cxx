@@ -22,6 +22,8 @@
 #include <cmath>
 
 /* Qt headers */
+#include <QApplication>
+#include <QClipboard>
 #include <QDebug>
 #include <QFont>
 #include <QFontMetrics>
@@ -31,17 +33,19 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsSceneWheelEvent>
 #include <QGraphicsTextItem>
-#include <QGraphicsSvgItem>
 #include <QGraphicsView>
 #include <QKeyEvent>
 #include <QMenu>
 #include <QMessageBox>
+#include <QMimeData>
 #include <QSettings>
 #include <QSignalMapper>
 
 /* local headers */
 #include "basicDefs.h"
 #include "rowColDeleteInsertDialog.h"
+#include "chartGridItem.h"
+#include "chartSelectionItem.h"
 #include "graphicsScene.h"
 #include "helperFunctions.h"
 #include "knittingSymbol.h"
@@ -57,6 +61,14 @@
 
 QT_BEGIN_NAMESPACE
 
+
+namespace
+{
+/* legend tag of items owned by the chart */
+const QString CHART_LEGEND_TAG( "chartLegendItem" );
+};
+
+
 /**************************************************************
  *
  * PUBLIC FUNCTIONS
@@ -69,6 +81,7 @@ QT_BEGIN_NAMESPACE
 GraphicsScene::GraphicsScene( const QPoint& anOrigin,
                               const QSize& gridDim,
                               const QSettings& aSetting,
+                              const SymbolCatalog& allSymbols,
                               KnittingSymbolPtr defaultSymbol,
                               MainWindow* myParent )
     :
@@ -79,14 +92,26 @@ GraphicsScene::GraphicsScene( const QPoint& anOrigin,
     numRows_( gridDim.height() ),
     gridCellDimensions_( extract_cell_dimensions_from_settings( aSetting ) ),
     textFont_( extract_font_from_settings( aSetting ) ),
+    chartModel_( gridDim.width(), gridDim.height() ),
+    cellStyle_( gridCellDimensions_, chartModel_ ),
     selectedCol_( UNSELECTED ),
     selectedRow_( UNSELECTED ),
     settings_( aSetting ),
+    selection_( chartModel_ ),
+    selectionItem_( 0 ),
+    allSymbols_( allSymbols ),
     selectedSymbol_( emptyKnittingSymbol ),
     defaultSymbol_( defaultSymbol ),
     backgroundColor_( Qt::white ),
     defaultColor_( Qt::white ),
-    legendIsVisible_( false )
+    hoveringFloatingItem_( false ),
+    gridIsVisible_( true ),
+    legendIsVisible_( false ),
+    transactionDepth_( 0 ),
+    scenePaused_( false ),
+    pausedIndexMethod_( BspTreeIndex ),
+    virtualGrid_( false ),
+    chartGrid_( 0 )
 {
   status_ = SUCCESSFULLY_CONSTRUCTED;
 }
@@ -102,9 +127,22 @@ bool GraphicsScene::Init()
     return false;
   }
 
+  if ( !chartModel_.Init() ) {
+    return false;
+  }
+
+  if ( !selection_.Init() ) {
+    return false;
+  }
+
+  if ( !journal_.Init() ) {
+    return false;
+  }
+  journal_.set_budget( extract_undo_budget_from_settings( settings_ ) );
+
   /* build canvas */
   create_pattern_grid_();
-  create_grid_labels_();
+  update_grid_labels_();
 
   /* install signal handlers */
   connect( this,
@@ -140,13 +178,15 @@ bool GraphicsScene::Init()
 //-------------------------------------------------------------
 void GraphicsScene::reset_grid( const QSize& newSize )
 {
+  begin_transaction_( BULK_TRANSACTION );
   reset_canvas_();
 
   /* generate new grid */
   numCols_ = newSize.width();
   numRows_ = newSize.height();
   create_pattern_grid_();
-  create_grid_labels_();
+  update_grid_labels_();
+  commit_transaction_();
 }
 
 
@@ -156,38 +196,34 @@ void GraphicsScene::reset_grid( const QSize& newSize )
 // project file has been read in. It nukes the present pattern
 // and re-creates the previously saved one.
 //-------------------------------------------------------------
-void GraphicsScene::load_new_canvas(
-  const QList<PatternGridItemDescriptorPtr>& newItems )
+void GraphicsScene::load_new_canvas( const ChartModel& newChart )
 {
-  assert( newItems.size() != 0 );
-  reset_canvas_();
+  assert( newChart.num_columns() != 0 && newChart.num_rows() != 0 );
 
-  int maxCol = 0;
-  int maxRow = 0;
-  foreach( PatternGridItemDescriptorPtr rawItem, newItems ) {
-    int col = rawItem->location.x();
-    int row = rawItem->location.y();
-
-    maxCol = qMax( col, maxCol );
-    maxRow = qMax( row, maxRow );
+  begin_transaction_( BULK_TRANSACTION );
+  reset_canvas_();
 
-    PatternGridItem* item =
-      new PatternGridItem( rawItem->dimension, gridCellDimensions_, col, row,
-                           this, rawItem->backgroundColor );
-    item->Init();
-    item->setPos( compute_cell_origin_( col, row ) );
-    item->insert_knitting_symbol( rawItem->patternSymbolPtr );
+  numCols_ = newChart.num_columns();
+  numRows_ = newChart.num_rows();
+  chartModel_.reset( numCols_, numRows_ );
+  setup_grid_view_();
 
-    /* add it to our scene */
-    add_patternGridItem_( item );
+  /* unit cells the file did not cover stay empty */
+  for ( int row = 0; row < numRows_; ++row ) {
+    int col = 0;
+    while ( col < numCols_ ) {
+      int cellWidth = newChart.width( col, row );
+      if ( !newChart.is_empty( col, row ) ) {
+        place_cell_( col, row, cellWidth, newChart.symbol( col, row ),
+                     QColor( newChart.color( col, row ) ) );
+      }
+      col += cellWidth;
+    }
   }
 
-  /* adjust dimensions */
-  numCols_ = maxCol + 1;
-  numRows_ = maxRow + 1;
-
   /* add labels and rescale */
-  create_grid_labels_();
+  update_grid_labels_();
+  commit_transaction_();
 }
 
 
@@ -264,8 +300,10 @@ void GraphicsScene::reset_canvas_()
 
 
 //--------------------------------------------------------------
-// select all PatterGridItems in the region enclosed by
-// the Rectangle.
+// toggle the selection of all chart cells touching the region
+// enclosed by the Rectangle. The covered rows and columns
+// follow from the corners of the region so the cost only
+// depends on the number of rows involved.
 //
 // NOTE: The reason for the QRectF instead of QRect is
 // that we need to call this function from the PatternView
@@ -275,36 +313,31 @@ void GraphicsScene::reset_canvas_()
 //--------------------------------------------------------------
 void GraphicsScene::select_region( const QRectF& aRegion )
 {
-  QList<QGraphicsItem*> allItems( items( aRegion ) );
-
-  /* grab PatterGridItems and select them
-   * NOTE: We can not just select the cells as we find
-   * them among all items since their order is arbitrary
-   * causing the selected area to be filled improperly
-   * for larger symbols (just like randomly selecting
-   * cells in the region would). Hence we sort all cells
-   * first by index and then select them in order */
-  QMap<int, PatternGridItem*> gridItems;
-  foreach( QGraphicsItem* anItem, allItems ) {
-    PatternGridItem* cell =
-      qgraphicsitem_cast<PatternGridItem*>( anItem );
-    if ( cell != 0 ) {
-      int cellIndex = compute_cell_index_( cell );
-      gridItems[cellIndex] = cell;
-    }
+  selectionItem_->set_preview( QRect() );
+
+  /* bail if the region misses the grid */
+  QRect cells( region_to_cells_( aRegion ) );
+  if ( cells.isNull() ) {
+    return;
   }
 
-  /* disable canvas update until we're done selecting,
-   * then we update and re-enable*/
-  disable_canvas_update_();
+  selection_.select_rectangle( cells.left(), cells.top(),
+                               cells.right(), cells.bottom(),
+                               ChartSelection::Toggle );
+  selection_changed_( cells.top(), cells.bottom() );
+}
 
-  QList<PatternGridItem*> sortedItems( gridItems.values() );
-  foreach( PatternGridItem* cell, sortedItems ) {
-    cell->select();
-  }
 
-  update_active_items_();
-  enable_canvas_update_();
+
+//--------------------------------------------------------------
+// highlight the cells touching region as a preview of what
+// select_region will act on, e.g. while the user is still
+// dragging the rubber band. The selection itself is left
+// alone.
+//--------------------------------------------------------------
+void GraphicsScene::preview_region( const QRectF& aRegion )
+{
+  selectionItem_->set_preview( region_to_cells_( aRegion ) );
 }
 
 
@@ -314,14 +347,11 @@ void GraphicsScene::select_region( const QRectF& aRegion )
 //----------------------------------------------------------------
 void GraphicsScene::hide_all_but_legend()
 {
-  /* disable all non-legend items */
-  foreach( QGraphicsItem* anItem, items() ) {
-    QGraphicsSvgItem* svgItem =
-      qgraphicsitem_cast<QGraphicsSvgItem*>( anItem );
+  gridIsVisible_ = false;
 
-    if ( !svgItem ) {
-      anItem->hide();
-    }
+  /* disable all items and bring back the legend below */
+  foreach( QGraphicsItem* anItem, items() ) {
+    anItem->hide();
   }
 
   /* show legend items */
@@ -337,6 +367,8 @@ void GraphicsScene::hide_all_but_legend()
 //---------------------------------------------------------------
 void GraphicsScene::show_all_items()
 {
+  gridIsVisible_ = true;
+
   foreach( QGraphicsItem* anItem, items() ) {
     anItem->show();
   }
@@ -350,17 +382,16 @@ void GraphicsScene::show_all_items()
 //-------------------------------------------------------------
 QRectF GraphicsScene::get_visible_area() const
 {
-  QList<QGraphicsItem*> visibleItems;
-  foreach( QGraphicsItem* anItem, items() ) {
-    QGraphicsSvgItem* svgItem =
-      qgraphicsitem_cast<QGraphicsSvgItem*>( anItem );
+  QRectF visibleArea;
+  if ( gridIsVisible_ ) {
+    visibleArea = grid_extent_();
+  }
 
-    if ( !svgItem && anItem->isVisible() ) {
-      visibleItems.push_back( anItem );
-    }
+  if ( legendIsVisible_ ) {
+    visibleArea |= legend_extent_();
   }
 
-  return get_bounding_rect( visibleItems );
+  return visibleArea;
 }
 
 
@@ -424,39 +455,6 @@ void GraphicsScene::add_symbol_to_legend(
 
 
 
-//-------------------------------------------------------------
-// update the present list of grid items; if the number of
-// selected items matches the number we need based on the
-// knitting symbol and they are adjacent we either try
-// placing the symbol or color the cells.
-//
-// NOTE: placement can be temporarty disabled, e.g., if we are
-// selecting a whole range of items (e.g., via rubberband or
-// row/column wise) in order to avoid premature placement of
-// knitting symbols that don't really fit into the total
-// available space.
-//--------------------------------------------------------------
-void GraphicsScene::grid_item_selected( PatternGridItem* anItem,
-                                        bool status )
-{
-  /* compute index based on row and col */
-  int index = compute_cell_index_( anItem );
-
-  /* first update our list of currently selected items */
-  if ( status ) {
-    activeItems_[index] = anItem;
-  } else {
-    activeItems_.remove( index );
-  }
-
-  if ( updateActiveItems_ ) {
-    update_active_items_();
-  }
-
-}
-
-
-
 //------------------------------------------------------------
 //------------------------------------------------------------
 void GraphicsScene::update_selected_background_color(
@@ -467,51 +465,16 @@ void GraphicsScene::update_selected_background_color(
 
 
 
-//------------------------------------------------------------
-// rest a grid item to its original state, i.e., convert
-// it back into empty single unit cells
-//------------------------------------------------------------
-void GraphicsScene::grid_item_reset( PatternGridItem* anItem )
-{
-  /* figure out where item is and how many cells it spans */
-  QPoint origin( anItem->origin() );
-  QSize dim( anItem->dim() );
-  int column = anItem->col();
-  int row = anItem->row();
-
-  /* get rid of the old cell making sure that we punt if from
-   * the set of activeItems if present */
-  remove_patternGridItem_( anItem );
-
-  /* start filling the hole with new cells */
-  int numNewCells = dim.width();
-  for ( int i = 0; i < numNewCells; ++i ) {
-    PatternGridItem* item = new PatternGridItem( QSize( 1, 1 ), gridCellDimensions_,
-        column + i, row, this );
-    item->Init();
-    item->insert_knitting_symbol( defaultSymbol_ );
-    item->setPos( compute_cell_origin_( column + i, row ) );
-    add_patternGridItem_( item );
-  }
-
-  /* make sure to delect all items since the current item
-   * may have been part of the active items */
-  deselect_all_active_items();
-}
-
-
-
 //---------------------------------------------------------------
 // deselects all items currenty marked as active
 //---------------------------------------------------------------
 void GraphicsScene::deselect_all_active_items()
 {
-  disable_canvas_update_();
-  foreach( PatternGridItem* anItem, activeItems_ ) {
-    anItem->select();
+  selection_.clear();
+
+  if ( selectionItem_ != 0 ) {
+    selectionItem_->update();
   }
-  activeItems_.clear();
-  enable_canvas_update_();
 }
 
 
@@ -522,42 +485,21 @@ void GraphicsScene::deselect_all_active_items()
 //-------------------------------------------------------------
 void GraphicsScene::mark_active_cells_with_rectangle()
 {
-  if ( activeItems_.empty() ) {
+  if ( selection_.is_empty() ) {
     emit statusBar_error( "Nothing selected" );
     return;
   }
 
-  /* first make sure the user selected a complete rectangle */
-  QList<RowItems> rowList;
-  sort_active_items_row_wise_( rowList );
-
-  /* remove the top and bottom empty rows */
-  while ( rowList.first().empty() ) {
-    rowList.pop_front();
-  }
-
-  while ( rowList.last().empty() ) {
-    rowList.pop_back();
-  }
-  assert( !rowList.empty() );
-
-  QPair<bool, int> initialStatus = is_row_contiguous_( rowList.at( 0 ) );
-  bool status = initialStatus.first;
-  for ( int index = 1; index < rowList.size(); ++index ) {
-    QPair<bool, int> currentStatus =
-      is_row_contiguous_( rowList.at( index ) );
-    if ( currentStatus != initialStatus ) {
-      status = false;
-    }
-  }
-
-  if ( !status ) {
+  /* make sure the user selected a complete rectangle */
+  QRect cells;
+  if ( !selection_.bounding_rectangle( cells ) ) {
     emit statusBar_error( "Selected cells don't form a rectangle" );
     return;
   }
 
-  /* find bounding rectangle and create rectangle */
-  QRect boundingRect = find_bounding_rectangle_( rowList );
+  QRect boundingRect( compute_cell_origin_( cells.left(), cells.top() ),
+                      QSize( cells.width() * gridCellDimensions_.width(),
+                             cells.height() * gridCellDimensions_.height() ) );
 
   /* fire up dialog for customizing pattern grid rectangles */
   PatternGridRectangleDialog rectangleDialog;
@@ -569,6 +511,8 @@ void GraphicsScene::mark_active_cells_with_rectangle()
   marker->Init();
   marker->setZValue( 1.0 );
   addItem( marker );
+  gridRectangles_.push_back( marker );
+  floatingItems_.insert( marker );
   deselect_all_active_items();
 }
 
@@ -585,6 +529,54 @@ void GraphicsScene::load_settings()
 
 
 
+//------------------------------------------------------------
+// revert the most recent edit
+//------------------------------------------------------------
+void GraphicsScene::undo()
+{
+  if ( !journal_.can_undo() ) {
+    emit statusBar_error( tr( "Nothing to undo" ) );
+    return;
+  }
+
+  const JournalStep step( journal_.undo_step() );
+
+  deselect_all_active_items();
+  begin_transaction_();
+  for ( int index = step.size() - 1; index >= 0; --index ) {
+    revert_journal_op_( step.at( index ) );
+  }
+  commit_transaction_();
+
+  journal_changed_();
+}
+
+
+
+//------------------------------------------------------------
+// re-apply the most recently undone edit
+//------------------------------------------------------------
+void GraphicsScene::redo()
+{
+  if ( !journal_.can_redo() ) {
+    emit statusBar_error( tr( "Nothing to redo" ) );
+    return;
+  }
+
+  const JournalStep step( journal_.redo_step() );
+
+  deselect_all_active_items();
+  begin_transaction_();
+  foreach( JournalOp op, step ) {
+    apply_journal_op_( op );
+  }
+  commit_transaction_();
+
+  journal_changed_();
+}
+
+
+
 //------------------------------------------------------------
 // update our current canvas after a change in settings
 //------------------------------------------------------------
@@ -592,16 +584,17 @@ void GraphicsScene::update_after_settings_change()
 {
   int oldCellHeight = gridCellDimensions_.height();
   load_settings();
+  journal_.set_budget( extract_undo_budget_from_settings( settings_ ) );
 
-  QList<QGraphicsItem*> allItems( items() );
-  foreach( QGraphicsItem* anItem, allItems ) {
-    PatternGridItem* cell = qgraphicsitem_cast<PatternGridItem*>( anItem );
+  foreach( PatternGridItem* cell, chartModel_.all_items() ) {
+    cell->resize();
+    cell->setPos( compute_cell_origin_( cell->col(), cell->row() ) );
+  }
 
-    if ( cell != 0 ) {
-      cell->resize();
-      cell->setPos( compute_cell_origin_( cell->col(), cell->row() ) );
-    }
+  if ( chartGrid_ != 0 ) {
+    chartGrid_->update_geometry();
   }
+  selectionItem_->update_geometry();
 
   /* shift all legend items and rescale the svg containing items */
   int cellHeightChange = gridCellDimensions_.height() - oldCellHeight;
@@ -615,7 +608,7 @@ void GraphicsScene::update_after_settings_change()
   }
 
   /* update the labels */
-  create_grid_labels_();
+  update_grid_labels_();
   update_legend_labels_();
 }
 
@@ -711,73 +704,13 @@ void GraphicsScene::open_row_col_menu_()
 //-------------------------------------------------------------
 void GraphicsScene::delete_column_( int aDeadCol )
 {
-  int deadCol = numCols_ - aDeadCol;
-
   if ( !can_column_be_deleted( numCols_, aDeadCol ) ) {
     return;
   }
 
-  assert( deadCol >= 0 );
-  assert( deadCol < numCols_ );
-
-  deselect_all_active_items();
-
-  QList<QGraphicsItem*> allItems( items() );
-  QList<PatternGridItem*> gridItems;
-
-  /* go through all items and make sure that the cells
-   * of the selected rows are all unit cells and don't
-   * span multiple columns */
-  int targetColCounter = 0;
-  foreach( QGraphicsItem* anItem, allItems ) {
-    PatternGridItem* cell =
-      qgraphicsitem_cast<PatternGridItem*>( anItem );
-
-    if ( cell != 0 ) {
-      if ( cell->col() == deadCol &&
-           cell->dim().width() == 1 ) {
-        targetColCounter += 1;
-      }
-
-      gridItems.push_back( cell );
-    }
-  }
-
-  /* if we have less than numRows_ in deletedColCounter there
-   * was at least on multi column cell in the column */
-  if ( targetColCounter < numRows_ ) {
-    emit statusBar_error( "cannot delete columns with "
-                          "cells that span multiple columns" );
-    return;
-  }
-
-
-  /* go through all grid cells and
-   * - delete the ones in the selectedRow_
-   * - shift the ones in a row greater than selectedRow_
-   *   up by one
-   */
-  foreach( PatternGridItem* cell, gridItems ) {
-    if ( cell->col() == deadCol ) {
-      remove_patternGridItem_( cell );
-    } else if ( cell->col() > deadCol ) {
-      cell->reseat( cell->col() - 1, cell->row() );
-      cell->setPos( compute_cell_origin_( cell->col(), cell->row() ) );
-    }
-  }
-
-  /* update position of legend items */
-  shift_legend_items_horizontally_( deadCol, -gridCellDimensions_.width() );
-
-  /* unselect row and update row counter */
-  numCols_ = numCols_ - 1;
-
-  /* redraw the labels */
-  create_grid_labels_();
-
-  /* update sceneRect
-   * NOTE: This may be a bottleneck for large grids */
-  setSceneRect( itemsBoundingRect() );
+  begin_edit_();
+  delete_grid_columns_( numCols_ - aDeadCol, 1 );
+  commit_edit_();
 }
 
 
@@ -792,56 +725,13 @@ void GraphicsScene::delete_column_( int aDeadCol )
 //-------------------------------------------------------------
 void GraphicsScene::delete_row_( int aDeadRow )
 {
-  int deadRow = numRows_ - aDeadRow;
-
   if ( !can_row_be_deleted( numRows_, aDeadRow ) ) {
     return;
   }
 
-  deselect_all_active_items();
-
-  /* go through all grid cells and
-   * - delete the ones in aDeadRow
-   * - shift the ones in a row greater than aDeadRow
-   *   up by one
-   *
-   * Important: We can't just delete as we go since
-   * this also nukes the svg item children which
-   * we are also iterating over
-   */
-  QList<QGraphicsItem*> allItems( items() );
-  QList<PatternGridItem*> patternItems;
-  foreach( QGraphicsItem* anItem, allItems ) {
-    PatternGridItem* cell =
-      qgraphicsitem_cast<PatternGridItem*>( anItem );
-
-    if ( cell != 0 ) {
-      patternItems.push_back( cell );
-    }
-  }
-
-  foreach( PatternGridItem* patItem, patternItems ) {
-    if ( patItem->row() == deadRow ) {
-      remove_patternGridItem_( patItem );
-    } else if ( patItem->row() > deadRow ) {
-      patItem->reseat( patItem->col(), patItem->row() - 1 );
-      patItem->setPos(
-        compute_cell_origin_( patItem->col(), patItem->row() ) );
-    }
-  }
-
-  /* update position of legend items */
-  shift_legend_items_vertically_( deadRow, -gridCellDimensions_.height() );
-
-  /* unselect row and update row counter */
-  numRows_ = numRows_ - 1;
-
-  /* redraw the labels */
-  create_grid_labels_();
-
-  /* update sceneRect
-   * NOTE: This may be a bottleneck for large grids */
-  setSceneRect( itemsBoundingRect() );
+  begin_edit_();
+  delete_grid_rows_( numRows_ - aDeadRow, 1 );
+  commit_edit_();
 }
 
 
@@ -854,9 +744,9 @@ void GraphicsScene::insert_columns_( int columnCount, int pivotCol, int directio
     return;
   }
 
-  for ( int count = 0; count < columnCount; ++count ) {
-    insert_single_column_( numCols_ - pivotCol + direction );
-  }
+  begin_edit_();
+  insert_grid_columns_( numCols_ - pivotCol + direction, columnCount );
+  commit_edit_();
 }
 
 
@@ -876,9 +766,9 @@ void GraphicsScene::insert_rows_( int rowCount, int pivotRow, int direction )
     return;
   }
 
-  for ( int count = 0; count < rowCount; ++count ) {
-    insert_single_row_( numRows_ - pivotRow - direction );
-  }
+  begin_edit_();
+  insert_grid_rows_( numRows_ - pivotRow - direction + 1, rowCount );
+  commit_edit_();
 }
 
 
@@ -895,6 +785,8 @@ void GraphicsScene::mark_rectangle_for_deletion_( QObject* rectObj )
 {
   PatternGridRectangle* rect =
     qobject_cast<PatternGridRectangle*>( rectObj );
+  gridRectangles_.removeAll( rect );
+  floatingItems_.remove( rect );
   removeItem( rect );
   rect->deleteLater();
 }
@@ -935,7 +827,6 @@ void GraphicsScene::update_key_label_text_( QString labelID,
 
 
 //-------------------------------------------------------------
-// Add a symbol plus description to the legend if neccessary.
 // This function checks if the added symbol already exists
 // in the legend. If not, create it.
 // The extraTag parameter allows more fine grained control
@@ -945,67 +836,7 @@ void GraphicsScene::update_key_label_text_( QString labelID,
 void GraphicsScene::notify_legend_of_item_addition_(
   const KnittingSymbolPtr symbol, QColor aColor, QString tag )
 {
-  QString symbolName = symbol->patternName();
-  QString symbolCategory = symbol->category();
-  QString colorName  = aColor.name();
-  QString fullName = get_legend_item_name( symbolCategory,
-                     symbolName, colorName, tag );
-
-  /* update reference count */
-  int currentValue = usedKnittingSymbols_[fullName] + 1;
-  assert( currentValue > 0 );
-  usedKnittingSymbols_[fullName] = currentValue;
-
-  /* if the symbol got newly added we add a description unless
-   * it already existed previously and show it in the legend */
-  if ( currentValue == 1 ) {
-    /* compute position for next label item */
-    int xPosSym = origin_.x();
-    int yPos = get_next_legend_items_y_position_();
-
-    LegendItem* newLegendItem = new LegendItem( symbol->dim(), tag,
-        gridCellDimensions_, aColor );
-    connect( newLegendItem,
-             SIGNAL( delete_from_legend( KnittingSymbolPtr, QColor, QString ) ),
-             this,
-             SLOT( notify_legend_of_item_removal_( KnittingSymbolPtr, QColor,
-                                                   QString ) )
-           );
-    newLegendItem->Init();
-    newLegendItem->insert_knitting_symbol( symbol );
-    newLegendItem->setPos( xPosSym, yPos );
-    newLegendItem->setFlag( QGraphicsItem::ItemIsMovable );
-    newLegendItem->setZValue( 1 );
-    addItem( newLegendItem );
-
-    /* add label */
-    QString description = get_symbol_description_( symbol, colorName );
-    int xPosLabel = ( symbol->dim().width() + 0.5 ) * gridCellDimensions_.width()
-                    + origin_.x();
-
-    LegendLabel* newTextItem =
-      new LegendLabel( fullName, description );
-    newTextItem->Init();
-    newTextItem->setPos( xPosLabel, yPos );
-    newTextItem->setFont( textFont_ );
-    newTextItem->setFlag( QGraphicsItem::ItemIsMovable );
-    newTextItem->setZValue( 1 );
-    addItem( newTextItem );
-    connect( newTextItem,
-             SIGNAL( label_changed( QString, QString ) ),
-             this,
-             SLOT( update_key_label_text_( QString, QString ) )
-           );
-
-    legendEntries_[fullName] = LegendEntry( newLegendItem, newTextItem );
-
-    if ( !legendIsVisible_ ) {
-      newLegendItem->hide();
-      newTextItem->hide();
-    } else {
-      emit show_whole_scene();
-    }
-  }
+  add_legend_reference_( legendKeys_.intern( symbol, aColor, tag ) );
 }
 
 
@@ -1018,72 +849,69 @@ void GraphicsScene::notify_legend_of_item_addition_(
 void GraphicsScene::notify_legend_of_item_removal_(
   const KnittingSymbolPtr symbol, QColor aColor, QString tag )
 {
-  QString symbolName = symbol->patternName();
-  QString symbolCategory = symbol->category();
-  QString colorName  = aColor.name();
-  QString fullName = get_legend_item_name( symbolCategory,
-                     symbolName, colorName, tag );
-
-  int currentValue = usedKnittingSymbols_[fullName] - 1;
-  assert( currentValue >= 0 );
-  usedKnittingSymbols_[fullName] = currentValue;
-
-  /* remove symbol if reference count hits 0 */
-  if ( currentValue == 0 ) {
-    usedKnittingSymbols_.remove( fullName );
-
-    LegendEntry deadItem = legendEntries_[fullName];
-    removeItem( deadItem.first );
-    deadItem.first->deleteLater();
-    removeItem( deadItem.second );
-    deadItem.second->deleteLater();
-    legendEntries_.remove( fullName );
-  }
+  remove_legend_reference_( legendKeys_.intern( symbol, aColor, tag ) );
 }
 
 
 //-------------------------------------------------------------
-// this function copies the current active item selection
+// this function copies the current active item selection and
+// puts it on the system clipboard
 //-------------------------------------------------------------
 void GraphicsScene::copy_items_()
 {
-  copiedItems_.objects.clear();
+  copiedItems_.runs.clear();
   CopyRegionDimension regionDim( INT_MAX, 0, INT_MAX, 0 );
 
-  QMap<int, PatternGridItem*>::const_iterator iter =
-    activeItems_.constBegin();
-  while ( iter != activeItems_.constEnd() ) {
-
-    QPair<int, int> location = compute_from_cell_index_( iter.key() );
-    adjust_copy_region( regionDim, location );
-
-    /* copy item */
-    PatternGridItem* source = iter.value();
-    CopyObjectItemPtr item = CopyObjectItemPtr( new CopyObjectItem );
-    item->symbol    = source->get_knitting_symbol();
-    item->backColor = source->color();
-    item->size      = source->dim();
-    item->row       = source->row();
-    item->column    = source->col();
-    copiedItems_.objects.push_back( item );
-
-    ++iter;
+  for ( int row = 0; row < numRows_; ++row ) {
+    foreach( SelectionRun run, selection_.row_runs( row ) ) {
+      int column = run.first;
+      while ( column < run.first + run.second ) {
+        adjust_copy_region( regionDim, QPair<int, int>( row, column ) );
+
+        /* copy cell; identical neighbors share a run */
+        int cellWidth = chartModel_.width( column, row );
+        append_copy_cell( copiedItems_, chartModel_.symbol( column, row ),
+                          QColor( chartModel_.color( column, row ) ),
+                          column, row, cellWidth );
+
+        column += cellWidth;
+      }
+    }
   }
 
   /* now that we know the total extent we can normalize each
-   * item and compute the width and height of the copy region */
+   * run and compute the width and height of the copy region */
   int rowOrigin = regionDim.get<0>();
   int colOrigin = regionDim.get<2>();
-  foreach( CopyObjectItemPtr item, copiedItems_.objects ) {
-    item->row = item->row - rowOrigin;
-    item->column = item->column - colOrigin;
+  for ( int index = 0; index < copiedItems_.runs.size(); ++index ) {
+    CopyObjectRun& run = copiedItems_.runs[index];
+    run.row = run.row - rowOrigin;
+    run.column = run.column - colOrigin;
 
-    assert( item->row >= 0 );
-    assert( item->column >= 0 );
+    assert( run.row >= 0 );
+    assert( run.column >= 0 );
   }
 
   copiedItems_.height = regionDim.get<1>() - rowOrigin + 1;
   copiedItems_.width  = regionDim.get<3>() - colOrigin + 1;
+
+  if ( copiedItems_.runs.empty() ) {
+    return;
+  }
+
+  /* if the cells don't fit into a payload we clear the clipboard
+   * so pasting falls back to our own copy of them */
+  QByteArray payload( encode_copy_object( copiedItems_ ) );
+  if ( payload.isEmpty() ) {
+    QApplication::clipboard()->clear();
+    emit statusBar_error( tr( "Too many distinct symbols or colors "
+                              "for the system clipboard" ) );
+    return;
+  }
+
+  QMimeData* cellData = new QMimeData;
+  cellData->setData( CHART_CELLS_MIME_TYPE, payload );
+  QApplication::clipboard()->setMimeData( cellData );
 }
 
 
@@ -1095,6 +923,10 @@ void GraphicsScene::copy_items_()
 //-------------------------------------------------------------
 void GraphicsScene::paste_items_()
 {
+  if ( !fetch_copied_items_() ) {
+    return;
+  }
+
   /* make sure the copy object fits */
   if (( selectedRow_ + copiedItems_.height ) > numRows_
       || ( selectedCol_ + copiedItems_.width ) > numCols_ ) {
@@ -1104,22 +936,31 @@ void GraphicsScene::paste_items_()
     return;
   }
 
-  foreach( CopyObjectItemPtr item, copiedItems_.objects ) {
-    int targetCol = selectedCol_ + item->column;
-    int targetRow = selectedRow_ + item->row;
+  paste_copied_items_( QRect( selectedCol_, selectedRow_,
+                              copiedItems_.width, copiedItems_.height ) );
+}
+
 
-    PatternGridItem* deadItem = patternGridItem_at_( targetCol, targetRow );
-    remove_patternGridItem_( deadItem );
 
-    PatternGridItem* newItem =
-      new PatternGridItem( item->size, gridCellDimensions_, targetCol,
-                           targetRow, this, item->backColor );
+//-------------------------------------------------------------
+// this function fills the currently selected rectangle by
+// repeating whatever is in the current copy selection
+//-------------------------------------------------------------
+void GraphicsScene::paste_items_tiled_()
+{
+  if ( !fetch_copied_items_() ) {
+    return;
+  }
 
-    newItem->Init();
-    newItem->insert_knitting_symbol( item->symbol );
-    newItem->setPos( compute_cell_origin_( targetCol, targetRow ) );
-    add_patternGridItem_( newItem );
+  QRect target;
+  if ( !selection_.bounding_rectangle( target ) ) {
+    emit statusBar_error( tr( "Tiled paste needs a rectangular "
+                              "selection" ) );
+    return;
   }
+
+  deselect_all_active_items();
+  paste_copied_items_( target );
 }
 
 
@@ -1130,10 +971,72 @@ void GraphicsScene::paste_items_()
 //-------------------------------------------------------------
 void GraphicsScene::grab_color_()
 {
-  PatternGridItem* selectedItem =
-    patternGridItem_at_( selectedCol_, selectedRow_ );
+  QColor selectedColor( chartModel_.color( selectedCol_, selectedRow_ ) );
+
+  emit grabbed_color( selectedColor );
+}
+
+
+
+//-------------------------------------------------------------
+// give every cell sharing the color of the grid item under
+// the mouse the currently active color. The chart model only
+// needs to change its palette and the legend moves the
+// reference counts of the old color over as a whole. The
+// undo journal and the PatternGridItems still need the
+// affected cells though, so this stays a single pass over
+// all cells of the chart.
+//-------------------------------------------------------------
+void GraphicsScene::replace_selected_color_()
+{
+  QRgb oldColor = chartModel_.color( selectedCol_, selectedRow_ );
+  if ( oldColor == backgroundColor_.rgb() ) {
+    return;
+  }
+
+  begin_edit_();
+  for ( int row = 0; row < numRows_; ++row ) {
+    int firstCol = -1;
+    int lastCol = -1;
+    int column = 0;
+    while ( column < numCols_ ) {
+      int cellWidth = chartModel_.width( column, row );
+      if ( chartModel_.color( column, row ) == oldColor ) {
+        if ( firstCol < 0 ) {
+          firstCol = column;
+        }
+        lastCol = column + cellWidth - 1;
+
+        PatternGridItem* item = chartModel_.item( column, row );
+        if ( item != 0 ) {
+          item->update();
+        }
+      }
+      column += cellWidth;
+    }
+
+    if ( firstCol >= 0 ) {
+      journal_cells_( row, firstCol, lastCol );
+    }
+  }
+
+  /* each chart legend key of the old color holds one reference
+   * per cell, all of which now go to the new color */
+  for ( int keyId = 0; keyId < usedKnittingSymbols_.size(); ++keyId ) {
+    int numRefs = usedKnittingSymbols_[keyId];
+    if ( numRefs > 0 && legendKeys_.color( keyId ).rgb() == oldColor
+         && legendKeys_.tag( keyId ) == CHART_LEGEND_TAG ) {
+      remove_legend_reference_( keyId, numRefs );
+      add_legend_reference_( legendKeys_.intern( legendKeys_.symbol( keyId ),
+                             backgroundColor_, CHART_LEGEND_TAG ), numRefs );
+    }
+  }
 
-  emit grabbed_color( selectedItem->color() );
+  chartModel_.replace_color( QColor( oldColor ), backgroundColor_ );
+  if ( chartGrid_ != 0 ) {
+    chartGrid_->update();
+  }
+  commit_edit_();
 }
 
 
@@ -1155,6 +1058,15 @@ void GraphicsScene::mouseMoveEvent(
   /* let our parent know that we moved */
   emit mouse_moved( currentPos );
 
+  /* we keep passing events on for one more move after leaving
+   * a floating item so it sees the hover leave */
+  bool wantsEvent = wants_item_event_( currentPos );
+  if ( !wantsEvent && !hoveringFloatingItem_ ) {
+    mouseEvent->ignore();
+    return;
+  }
+  hoveringFloatingItem_ = wantsEvent;
+
   return QGraphicsScene::mouseMoveEvent( mouseEvent );
 }
 
@@ -1166,6 +1078,11 @@ void GraphicsScene::mouseMoveEvent(
 void GraphicsScene::mousePressEvent(
   QGraphicsSceneMouseEvent* mouseEvent )
 {
+  /* legend items, labels and the lines of marker rectangles
+   * sit on top of the chart and get first dibs on the click;
+   * the inside of a marker rectangle belongs to the cells */
+  bool itemWantsEvent = wants_item_event_( mouseEvent->scenePos() );
+
   if ( mouseEvent->button() == Qt::RightButton ) {
     bool handled = handle_click_on_marker_rectangle_( mouseEvent );
 
@@ -1174,6 +1091,25 @@ void GraphicsScene::mousePressEvent(
     }
   } else {
     handle_click_on_grid_labels_( mouseEvent );
+
+    /* plain left clicks toggle the cell under the mouse unless
+     * an item is in the way; with control or shift pressed we
+     * stay out of the way of panning and the rubber band */
+    if ( mouseEvent->button() == Qt::LeftButton && !itemWantsEvent
+         && !mouseEvent->modifiers().testFlag( Qt::ControlModifier )
+         && !mouseEvent->modifiers().testFlag( Qt::ShiftModifier ) ) {
+      QPair<int, int> arrayIndex( get_cell_coords_( mouseEvent->scenePos() ) );
+      if ( chartModel_.contains( arrayIndex.first, arrayIndex.second ) ) {
+        toggle_cell_selection_( arrayIndex.first, arrayIndex.second );
+      }
+    }
+  }
+
+  /* clicks on plain chart cells are of no interest to any
+   * item; ignoring them leaves them to the view's rubber band */
+  if ( !itemWantsEvent && focusItem() == 0 ) {
+    mouseEvent->ignore();
+    return;
   }
 
   return QGraphicsScene::mousePressEvent( mouseEvent );
@@ -1189,175 +1125,320 @@ void GraphicsScene::mousePressEvent(
 
 
 //-------------------------------------------------------------
-// this function inserts a single columne into the chart at
-// column aCol
+// insert count rows of default cells in front of row. All
+// cells, legend items and labels are shifted in one go and
+// the scene rect is updated once at the end so the cost does
+// not grow with count beyond creating the new cells.
 //-------------------------------------------------------------
-void GraphicsScene::insert_single_row_( int aRow )
+void GraphicsScene::insert_grid_rows_( int aRow, int count )
 {
+  assert( aRow >= 0 && aRow <= numRows_ );
+
   deselect_all_active_items();
+  journal_structure_( JournalOp::InsertRows, aRow, count );
 
-  /* shift rows to make space */
-  expand_grid_( NOSHIFT, aRow );
+  begin_transaction_( BULK_TRANSACTION );
 
-  /* now insert the new row */
-  for ( int column = 0; column < numCols_; ++column ) {
-    PatternGridItem* anItem = new PatternGridItem(
-      QSize( 1, 1 ), gridCellDimensions_, column, aRow + 1,
-      this, defaultColor_ );
+  /* make space in the chart model and move the cells below */
+  chartModel_.insert_rows( aRow, count );
+  reseat_moved_items_();
+  shift_legend_items_vertically_( aRow, count * gridCellDimensions_.height() );
+  numRows_ += count;
 
-    anItem->Init();
-    anItem->setPos( compute_cell_origin_( column, aRow + 1 ) );
-    anItem->insert_knitting_symbol( defaultSymbol_ );
-    add_patternGridItem_( anItem );
+  /* now fill the new rows */
+  for ( int row = aRow; row < aRow + count; ++row ) {
+    for ( int column = 0; column < numCols_; ++column ) {
+      place_cell_( column, row, 1, defaultSymbol_, defaultColor_ );
+    }
   }
 
-  /* redraw the labels */
-  create_grid_labels_();
+  commit_transaction_();
 
-  /* update sceneRect
-   * NOTE: This may be a bottleneck for large grids */
-  setSceneRect( itemsBoundingRect() );
+  update_grid_extent_();
 }
 
 
 
 //-------------------------------------------------------------
-// this function inserts a single columne into the chart at
-// column aCol. We go through all items and make sure that that
-// inserting the columns won't cut through any multi row cells
-// NOTE: The special case here is adding a column at the
+// insert count columns of default cells in front of column
+// aCol. We make sure that inserting the columns won't cut
+// through any multi column cells.
+// NOTE: The special case here is adding columns at the
 // right or left of the pattern grid in which case we're
-// always in good shape and the below test will actually
-// fail when adding at the right
+// always in good shape.
 //-------------------------------------------------------------
-void GraphicsScene::insert_single_column_( int aCol )
+void GraphicsScene::insert_grid_columns_( int aCol, int count )
 {
-  deselect_all_active_items();
+  assert( aCol >= 0 && aCol <= numCols_ );
 
-  if ( aCol != 0 && aCol != numCols_ ) {
-    int targetColCounter = 0;
-    QList<QGraphicsItem*> allItems( items() );
-    foreach( QGraphicsItem* anItem, allItems ) {
-      PatternGridItem* cell =
-        qgraphicsitem_cast<PatternGridItem*>( anItem );
-
-      if ( cell != 0 ) {
-        /* in order to make sure we won't cut through a wide cell, we
-         * check if the origin of the cell is in the current cell. If not,
-         * it will surely start in the cell to the left and we would cut
-         * it in this case */
-        QPointF actualOrigin( cell->scenePos() );
-        QPointF neededOrigin( compute_cell_origin_( aCol, cell->row() ) );
-
-        /* FIXME: we shouldn't be comparing QPointFs !!! */
-        if ( cell->col() == aCol && actualOrigin == neededOrigin ) {
-          targetColCounter += 1;
-        }
-      }
-    }
+  deselect_all_active_items();
 
-    /* if we have less than numCols_ in deletedColCounter there
-     * was at least on multi column cell in the column */
-    if ( targetColCounter < numRows_ ) {
-      QMessageBox::critical( 0, tr( "Invalid Column" ), tr( "cannot insert column" )
-                             + tr( "between cells that span multiple columns" ) );
-      return;
-    }
+  /* in order to make sure we won't cut through a wide cell
+   * a cell has to start at aCol in every row */
+  if ( !chartModel_.is_column_boundary( aCol ) ) {
+    QMessageBox::critical( 0, tr( "Invalid Column" ), tr( "cannot insert column" )
+                           + tr( "between cells that span multiple columns" ) );
+    return;
   }
 
+  journal_structure_( JournalOp::InsertColumns, aCol, count );
+  begin_transaction_( BULK_TRANSACTION );
 
-  /* expand the grid to make space */
-  expand_grid_( aCol, NOSHIFT );
+  /* make space in the chart model and move the cells right
+   * of it */
+  chartModel_.insert_columns( aCol, count );
+  reseat_moved_items_();
+  shift_legend_items_horizontally_( aCol, count * gridCellDimensions_.width() );
+  numCols_ += count;
 
-  /* now insert the new column */
+  /* now fill the new columns */
   for ( int row = 0; row < numRows_; ++row ) {
-    PatternGridItem* anItem = new PatternGridItem( QSize( 1, 1 ),
-        gridCellDimensions_, aCol, row, this, defaultColor_ );
-
-    anItem->Init();
-    anItem->setPos( compute_cell_origin_( aCol, row ) );
-    anItem->insert_knitting_symbol( defaultSymbol_ );
-    add_patternGridItem_( anItem );
+    for ( int column = aCol; column < aCol + count; ++column ) {
+      place_cell_( column, row, 1, defaultSymbol_, defaultColor_ );
+    }
   }
 
-  /* redraw the labels */
-  create_grid_labels_();
+  commit_transaction_();
 
-  /* update sceneRect
-   * NOTE: This may be a bottleneck for large grids */
-  setSceneRect( itemsBoundingRect() );
+  update_grid_extent_();
 }
 
 
 
 //-------------------------------------------------------------
-// this function goes through all active items and changes
-// the color of each on to the one that is currently
-// selected.
+// delete count rows starting at row aRow and shift the ones
+// below up
 //-------------------------------------------------------------
-void GraphicsScene::change_selected_cells_colors_()
+void GraphicsScene::delete_grid_rows_( int aRow, int count )
 {
-  foreach( PatternGridItem* item, activeItems_ ) {
-    /* remove us from the legend */
-    notify_legend_of_item_removal_( item->get_knitting_symbol(),
-                                    item->color(), "chartLegendItem" );
+  assert( aRow >= 0 && aRow + count <= numRows_ );
 
-    item->set_background_color( backgroundColor_ );
+  deselect_all_active_items();
+  journal_structure_( JournalOp::DeleteRows, aRow, count );
 
-    /* re-add newly colored symbol to the legend */
-    notify_legend_of_item_addition_( item->get_knitting_symbol(),
-                                     item->color(), "chartLegendItem" );
+  begin_transaction_( BULK_TRANSACTION );
 
+  /* delete the cells in the dead rows */
+  for ( int row = aRow; row < aRow + count; ++row ) {
+    int column = 0;
+    while ( column < numCols_ ) {
+      int cellWidth = chartModel_.width( column, row );
+      remove_cell_( column, row );
+      column += cellWidth;
+    }
   }
 
-  deselect_all_active_items();
+  /* shift the ones below up */
+  chartModel_.delete_rows( aRow, count );
+  reseat_moved_items_();
+  shift_legend_items_vertically_( aRow, -count * gridCellDimensions_.height() );
+  numRows_ -= count;
+
+  commit_transaction_();
+
+  update_grid_extent_();
 }
 
 
 
 //-------------------------------------------------------------
-// this function tries to place the currently active
-// knitting symbol into the selected pattern grid cells
+// delete count columns starting at column aCol and shift the
+// ones right of it over. We bail if any cell sticks out of
+// the deleted block.
 //-------------------------------------------------------------
-void GraphicsScene::try_place_knitting_symbol_()
+void GraphicsScene::delete_grid_columns_( int aCol, int count )
 {
-  /* check how many cells we need for the currently selected
-   * knitting symbol */
-  QSize size = selectedSymbol_->dim();
-  int cellsNeeded = size.width();
+  assert( aCol >= 0 && aCol + count <= numCols_ );
 
-  if ( cellsNeeded == 0 ) {
+  deselect_all_active_items();
+
+  if ( !chartModel_.is_column_boundary( aCol )
+       || !chartModel_.is_column_boundary( aCol + count ) ) {
+    emit statusBar_error( "cannot delete columns with "
+                          "cells that span multiple columns" );
     return;
   }
 
-  /* make sure the number of selected items is an integer multiple
-   * of the required item size */
-  if ( activeItems_.size() % cellsNeeded != 0 ) {
-    emit statusBar_error( tr( "Number of selected cells is"
-                              "not a multiple of the pattern size" ) );
+  journal_structure_( JournalOp::DeleteColumns, aCol, count );
+  begin_transaction_( BULK_TRANSACTION );
+
+  /* delete the cells in the dead columns */
+  for ( int row = 0; row < numRows_; ++row ) {
+    int column = aCol;
+    while ( column < aCol + count ) {
+      int cellWidth = chartModel_.width( column, row );
+      remove_cell_( column, row );
+      column += cellWidth;
+    }
+  }
+
+  /* shift the ones right of it over */
+  chartModel_.delete_columns( aCol, count );
+  reseat_moved_items_();
+  shift_legend_items_horizontally_( aCol, -count * gridCellDimensions_.width() );
+  numCols_ -= count;
+
+  commit_transaction_();
+
+  update_grid_extent_();
+}
+
+
+
+//-------------------------------------------------------------
+// redraw the labels and update the scene rect after the
+// grid changed its dimensions
+//-------------------------------------------------------------
+void GraphicsScene::update_grid_extent_()
+{
+  update_grid_labels_();
+  selectionItem_->update_geometry();
+
+  setSceneRect( grid_extent_() | legend_extent_() );
+}
+
+
+
+//-------------------------------------------------------------
+// compute the area covered by the pattern grid, its labels
+// and marker rectangles. The grid itself is computed from
+// its dimensions; for the labels we only need to look at
+// the first and last one of each pool since the last ones
+// carry the widest numbers.
+//-------------------------------------------------------------
+QRectF GraphicsScene::grid_extent_() const
+{
+  QRectF extent( origin_, QSizeF( numCols_ * gridCellDimensions_.width(),
+                                  numRows_ * gridCellDimensions_.height() ) );
+
+  if ( !columnLabels_.empty() ) {
+    extent |= columnLabels_.first()->sceneBoundingRect();
+    extent |= columnLabels_.last()->sceneBoundingRect();
+  }
+
+  if ( !rowLabels_.empty() ) {
+    extent |= rowLabels_.first()->sceneBoundingRect();
+    extent |= rowLabels_.last()->sceneBoundingRect();
+  }
+
+  foreach( PatternGridRectangle* rect, gridRectangles_ ) {
+    extent |= rect->sceneBoundingRect();
+  }
+
+  return extent;
+}
+
+
+
+//-------------------------------------------------------------
+// compute the area covered by the legend; this only involves
+// the legend entries, not the rest of the canvas
+//-------------------------------------------------------------
+QRectF GraphicsScene::legend_extent_() const
+{
+  if ( legendEntries_.empty() ) {
+    return QRectF();
+  }
+
+  return get_bounding_rect( get_all_legend_items_() );
+}
+
+
+
+//-------------------------------------------------------------
+// this function goes through all active items and changes
+// the color of each on to the one that is currently
+// selected.
+//-------------------------------------------------------------
+void GraphicsScene::change_selected_cells_colors_()
+{
+  begin_edit_( EditJournal::Recolor );
+  for ( int row = 0; row < numRows_; ++row ) {
+    const SelectionRuns& runs = selection_.row_runs( row );
+    if ( !runs.empty() ) {
+      journal_cells_( row, runs.first().first,
+                      runs.last().first + runs.last().second - 1 );
+    }
+
+    foreach( SelectionRun run, runs ) {
+      int column = run.first;
+      while ( column < run.first + run.second ) {
+        KnittingSymbolPtr symbol = chartModel_.symbol( column, row );
+        int cellWidth = chartModel_.width( column, row );
+
+        /* remove us from the legend */
+        remove_legend_reference_(
+          legendKeys_.intern( symbol, QColor( chartModel_.color( column, row ) ),
+                              CHART_LEGEND_TAG ) );
+
+        chartModel_.set_color( column, row, backgroundColor_ );
+        PatternGridItem* item = chartModel_.item( column, row );
+        if ( item != 0 ) {
+          item->update();
+        } else if ( chartGrid_ != 0 ) {
+          chartGrid_->update_cells( column, row, cellWidth );
+        }
+
+        /* re-add newly colored symbol to the legend */
+        add_legend_reference_( legendKeys_.intern( symbol, backgroundColor_,
+                               CHART_LEGEND_TAG ) );
+
+        column += cellWidth;
+      }
+    }
   }
+  commit_edit_();
+
+  deselect_all_active_items();
+}
+
+
+
+//-------------------------------------------------------------
+// this function tries to place the currently active
+// knitting symbol into the selected pattern grid cells
+//-------------------------------------------------------------
+void GraphicsScene::try_place_knitting_symbol_()
+{
+  /* check how many cells we need for the currently selected
+   * knitting symbol */
+  QSize size = selectedSymbol_->dim();
+  int cellsNeeded = size.width();
 
-  /* sort selected items row wise */
-  QList<RowItems> rowList;
-  bool sortStatus = sort_active_items_row_wise_( rowList );
-  if ( !sortStatus ) {
+  if ( cellsNeeded == 0 ) {
     return;
   }
 
+  /* make sure the number of selected items is an integer multiple
+   * of the required item size */
+  if ( selection_.num_cells() % cellsNeeded != 0 ) {
+    emit statusBar_error( tr( "Number of selected cells is"
+                              "not a multiple of the pattern size" ) );
+  }
+
   /* check if each row has the proper arrangement of
    * highlighted cells to fit the selected pattern item */
   QList<RowLayout> replacementCells;
   bool finalStatus = process_selected_items_( replacementCells,
-                     rowList, cellsNeeded );
+                     cellsNeeded );
   if ( !finalStatus ) {
     return;
   }
 
 
+  begin_edit_( EditJournal::PlaceSymbol );
+
   /* delete previously highligthed cells */
-  QList<PatternGridItem*> deadItems( activeItems_.values() );
-  foreach( PatternGridItem* item, deadItems ) {
-    remove_patternGridItem_( item );
+  for ( int row = 0; row < numRows_; ++row ) {
+    const SelectionRuns& runs = selection_.row_runs( row );
+    if ( !runs.empty() ) {
+      journal_cells_( row, runs.first().first,
+                      runs.last().first + runs.last().second - 1 );
+    }
+
+    foreach( SelectionRun run, runs ) {
+      clear_cells_( run.first, row, run.second );
+    }
   }
 
 
@@ -1368,23 +1449,14 @@ void GraphicsScene::try_place_knitting_symbol_()
       int column = replacementCells.at( row )[cell].first;
       int aWidth  = replacementCells.at( row )[cell].second;
 
-      PatternGridItem* anItem = new PatternGridItem(
-        QSize( aWidth, 1 ),
-        gridCellDimensions_,
-        column,
-        row,
-        this,
-        backgroundColor_ );
-
-      anItem->Init();
-      anItem->insert_knitting_symbol( selectedSymbol_ );
-      anItem->setPos( compute_cell_origin_( column, row ) );
-      add_patternGridItem_( anItem );
+      place_cell_( column, row, aWidth, selectedSymbol_, backgroundColor_ );
     }
   }
 
+  commit_edit_();
+
   /* clear selection */
-  activeItems_.clear();
+  deselect_all_active_items();
 }
 
 
@@ -1412,47 +1484,23 @@ int GraphicsScene::compute_horizontal_label_shift_( int aNum,
 
 
 
-//----------------------------------------------------------------
-// sort all currently selected cells in a row by row fashion
-// returns true on success and false on failure
-//----------------------------------------------------------------
-bool GraphicsScene::sort_active_items_row_wise_(
-  QList<RowItems>& theRows ) const
-{
-  for ( int i = 0; i < numRows_; ++i ) {
-    RowItems tempList;
-    theRows.push_back( tempList );
-  }
-
-  QMap<int, PatternGridItem*>::const_iterator iter =
-    activeItems_.constBegin();
-  while ( iter != activeItems_.constEnd() ) {
-    int row = static_cast<int>( iter.key() / numCols_ );
-    theRows[row].push_back( iter.value() );
-    ++iter;
-  }
-
-  return true;
-}
-
-
-
 //--------------------------------------------------------------
 // check if each row has the proper arrangement of
 // highlighted cells to fit the selected pattern item and
-// arrange highlighted cells in bunches of targetPatternSize
+// arrange highlighted cells in bunches of targetPatternSize.
+// The selected runs of each row are already merged into
+// contiguous blocks.
 // NOTE: selectedPatternSize is expected to be non-zero
 //--------------------------------------------------------------
 bool GraphicsScene::process_selected_items_(
-  QList<RowLayout>& finalCellLayout, const QList<RowItems>& rowLayout,
-  int selectedPatternSize )
+  QList<RowLayout>& finalCellLayout, int selectedPatternSize )
 {
-  for ( int row = 0; row < rowLayout.size(); ++row ) {
-    RowItems rowItem = rowLayout.at( row );
+  for ( int row = 0; row < numRows_; ++row ) {
+    const SelectionRuns& cellBounds = selection_.row_runs( row );
 
     int rowLength = 0;
-    foreach( PatternGridItem* anItem, rowItem ) {
-      rowLength += ( anItem->dim() ).width();
+    foreach( SelectionRun run, cellBounds ) {
+      rowLength += run.second;
     }
 
     /* if the rowLength is not divisible by cellsNeeded we
@@ -1462,29 +1510,6 @@ bool GraphicsScene::process_selected_items_(
       return false;
     }
 
-    RowLayout cellBounds;
-    foreach( PatternGridItem* anItem, rowItem ) {
-      int curStart = ( anItem->col() );
-      int curWidth = ( anItem->dim() ).width();
-
-      if ( !cellBounds.empty() ) {
-        int lastStart = cellBounds.back().first;
-        int lastWidth = cellBounds.back().second;
-
-        /* see if we are extending the last cell */
-        if ( lastStart + lastWidth == curStart ) {
-          cellBounds.pop_back();
-          cellBounds.push_back(
-            QPair<int, int>( lastStart, lastWidth + curWidth ) );
-        } else {
-          cellBounds.push_back( QPair<int, int>( curStart, curWidth ) );
-        }
-      } else {
-        cellBounds.push_back( QPair<int, int>( curStart, curWidth ) );
-      }
-    }
-
-
     /* generate row message String */
     QString rowIndex;
     rowIndex.setNum( row + 1 );
@@ -1522,23 +1547,6 @@ bool GraphicsScene::process_selected_items_(
 
 
 
-//--------------------------------------------------------------
-// color all highlighted cells in the presently currently
-// selected color. In reality, this really boils down to
-// deselecting them all since they will pick up the current
-// highlight color in the process :)
-//--------------------------------------------------------------
-void GraphicsScene::colorize_highlighted_cells_()
-{
-  /* if coloring is selected we set the color of all
-   * curently active Items */
-  QList<PatternGridItem*> patternItems( activeItems_.values() );
-  foreach( PatternGridItem* anItem, patternItems ) {
-    anItem->set_background_color( backgroundColor_ );
-  }
-}
-
-
 //--------------------------------------------------------------
 // given a point on the canvas, determines which column/row the
 // click was in.
@@ -1561,52 +1569,23 @@ QPair<int, int> GraphicsScene::get_cell_coords_(
 
 
 //-------------------------------------------------------------
-// activate a complete row
-// In order to accomplish this we create a rectangle that
-// covers all cells in the row, then get all the items and
-// the select them all.
-// NOTE: This is simular to what we do with the RubberBand.
+// toggle the selection of a complete row
 //-------------------------------------------------------------
 void GraphicsScene::select_row_( int rowId )
 {
-  /* selector box dimensions */
-  int xShift    = static_cast<int>( gridCellDimensions_.width() * 0.25 );
-  int yShift    = static_cast<int>( gridCellDimensions_.height() * 0.25 );
-  int xHalfCell = static_cast<int>( gridCellDimensions_.width() * 0.5 );
-  int yHalfCell = static_cast<int>( gridCellDimensions_.height() * 0.5 );
-
-  QPoint boxOrigin( origin_.x() + xShift,
-                    rowId * gridCellDimensions_.height() + yShift );
-
-  QSize boxDim(( numCols_ - 1 ) * gridCellDimensions_.width() + xHalfCell,
-               yHalfCell );
-
-  select_region( QRect( boxOrigin, boxDim ) );
+  selection_.select_row( rowId, ChartSelection::Toggle );
+  selection_changed_( rowId, rowId );
 }
 
 
 
 //-------------------------------------------------------------
-// activate a complete column
-// In order to accomplish this we create a rectangle that
-// covers all cells in the column, then get all the items and
-// the select them all.
-// NOTE: This is simular to what we do with the RubberBand.
+// toggle the selection of a complete column
 //-------------------------------------------------------------
 void GraphicsScene::select_column_( int colId )
 {
-  /* selector box dimensions */
-  int xShift    = static_cast<int>( gridCellDimensions_.width() * 0.25 );
-  int yShift    = static_cast<int>( gridCellDimensions_.height() * 0.25 );
-  int xHalfCell = static_cast<int>( gridCellDimensions_.width() * 0.5 );
-  int yHalfCell = static_cast<int>( gridCellDimensions_.height() * 0.5 );
-
-  QPoint boxOrigin( colId * gridCellDimensions_.width() + xShift, yShift );
-  QSize boxDim( xHalfCell, ( numRows_ - 1 ) * gridCellDimensions_.height()
-                + yHalfCell );
-
-  /* select items */
-  select_region( QRect( boxOrigin, boxDim ) );
+  selection_.select_column( colId, ChartSelection::Toggle );
+  selection_changed_( 0, numRows_ - 1 );
 }
 
 
@@ -1623,192 +1602,91 @@ QPoint GraphicsScene::compute_cell_origin_( int col, int row ) const
 
 
 
-//-----------------------------------------------------------------
-// returns a pointer to the PatternGridItem at the given row
-// and column indices
-//-----------------------------------------------------------------
-PatternGridItem* GraphicsScene::patternGridItem_at_( int col, int row ) const
-{
-  assert( col >= 0 && col <= numCols_ );
-  assert( row >= 0 && row <= numRows_ );
-
-  QPointF center( origin_.x() + ( col + 0.5 ) * gridCellDimensions_.width(),
-                  origin_.y() + ( row + 0.5 ) * gridCellDimensions_.height() );
-
-  QList<PatternGridItem*> foundItems;
-  QList<QGraphicsItem*> allItems = items( center );
-  foreach( QGraphicsItem* anItem, allItems ) {
-    PatternGridItem* cell = qgraphicsitem_cast<PatternGridItem*>( anItem );
-
-    if ( cell != 0 ) {
-      foundItems.push_back( cell );
-    }
-  }
-
-  assert( foundItems.size() == 1 );
-
-  return foundItems.first();
-}
-
-
-//-----------------------------------------------------------------
-// compute the index of a given cell based on its present row
-// and column
-//-----------------------------------------------------------------
-int GraphicsScene::compute_cell_index_( PatternGridItem* anItem ) const
-{
-  return ( anItem->row() * numCols_ ) + anItem->col();
-}
-
-
-
-//-----------------------------------------------------------------
-// compute the row and column of a given cell based on the
-// cell index
-//-----------------------------------------------------------------
-QPair<int, int> GraphicsScene::compute_from_cell_index_( int index ) const
-{
-  int row = static_cast<int>( index / numCols_ );
-  int col = index;
-  if ( row != 0 ) {
-    col = index % numCols_;
-  }
-
-  return QPair<int, int>( row, col );
-}
-
-
 //-------------------------------------------------------------
 // create the grid
 //-------------------------------------------------------------
 void GraphicsScene::create_pattern_grid_()
 {
+  chartModel_.reset( numCols_, numRows_ );
+  setup_grid_view_();
+
   /* grid */
-  for ( int col = 0; col < numCols_; ++col ) {
-    for ( int row = 0; row < numRows_; ++row ) {
-      PatternGridItem* item =
-        new PatternGridItem( QSize( 1, 1 ), gridCellDimensions_, col, row, this );
-      item->Init();
-      item->setPos( compute_cell_origin_( col, row ) );
-      item->insert_knitting_symbol( defaultSymbol_ );
-
-      /* add it to our scene */
-      add_patternGridItem_( item );
+  begin_transaction_( BULK_TRANSACTION );
+  for ( int row = 0; row < numRows_; ++row ) {
+    for ( int col = 0; col < numCols_; ++col ) {
+      place_cell_( col, row, 1, defaultSymbol_, defaultColor_ );
     }
   }
+  commit_transaction_();
 }
 
 
 
 //-------------------------------------------------------------
-// create or update the column labels
+// bring the row and column labels in sync with the grid.
+// Labels are pooled by the number they show, so after an
+// insert or delete we only move the existing ones and create
+// or destroy labels at the end of the number range.
 //-------------------------------------------------------------
-void GraphicsScene::create_grid_labels_()
+void GraphicsScene::update_grid_labels_()
 {
-  /* remove all existing labels if there are any */
-  QList<QGraphicsItem*> allItems( items() );
-  QList<PatternGridLabel*> allLabels;
-  foreach( QGraphicsItem* aLabel, allItems ) {
-    PatternGridLabel* label =
-      qgraphicsitem_cast<PatternGridLabel*>( aLabel );
+  resize_label_pool_( columnLabels_, numCols_, PatternGridLabel::ColLabel );
+  resize_label_pool_( rowLabels_, numRows_, PatternGridLabel::RowLabel );
 
-    if ( label != 0 ) {
-      allLabels.push_back( label );
-    }
-  }
-
-  foreach( PatternGridLabel* aLabel, allLabels ) {
-    removeItem( aLabel );
-    aLabel->deleteLater();
-  }
-
-  /* add new column labels */
-  QString label;
+  /* place column labels */
   qreal yPos = origin_.y() + numRows_ * gridCellDimensions_.height() + 1;
-
-  for ( int col = 0; col < numCols_; ++col ) {
-    int colNum = numCols_ - col;
-    PatternGridLabel* text = new PatternGridLabel(
-      label.setNum( colNum ),
-      PatternGridLabel::ColLabel
-    );
-
+  for ( int colNum = 1; colNum <= numCols_; ++colNum ) {
+    PatternGridLabel* text = columnLabels_.at( colNum - 1 );
+    int col = numCols_ - colNum;
     int shift =
       compute_horizontal_label_shift_( colNum, textFont_.pointSize() );
+    if ( text->font() != textFont_ ) {
+      text->setFont( textFont_ );
+    }
     text->setPos( origin_.x() + col*gridCellDimensions_.width() + shift, yPos );
-    text->setFont( textFont_ );
-    addItem( text );
   }
 
 
-  /* add new row labels
+  /* place row labels
    * FIXME: the exact placement of the labels is hand-tuned
    * and probably not very robust */
   QFontMetrics metric( textFont_ );
   int fontHeight = metric.ascent();
-  for ( int row = 0; row < numRows_; ++row ) {
-    PatternGridLabel* text = new PatternGridLabel(
-      label.setNum( numRows_ - row ),
-      PatternGridLabel::RowLabel
-    );
-
-    text->setPos( origin_.x() + ( numCols_*gridCellDimensions_.width() )
-                  + 0.1*gridCellDimensions_.width(),
-                  origin_.y() + row*gridCellDimensions_.height()
+  qreal xPos = origin_.x() + ( numCols_*gridCellDimensions_.width() )
+               + 0.1*gridCellDimensions_.width();
+  for ( int rowNum = 1; rowNum <= numRows_; ++rowNum ) {
+    PatternGridLabel* text = rowLabels_.at( rowNum - 1 );
+    int row = numRows_ - rowNum;
+    if ( text->font() != textFont_ ) {
+      text->setFont( textFont_ );
+    }
+    text->setPos( xPos, origin_.y() + row*gridCellDimensions_.height()
                   + 0.5*( gridCellDimensions_.height() - 1.8*fontHeight ) );
-    text->setFont( textFont_ );
-    addItem( text );
   }
 }
 
 
 
-//---------------------------------------------------------------
-// shift the pattern grid by one column and/or row wise starting
-// at the specified column and row indices.
-// This is mainly used when inserting/deleting columns/rows
-//--------------------------------------------------------------
-void GraphicsScene::expand_grid_( int colPivot, int rowPivot )
+//-------------------------------------------------------------
+// grow or shrink a pool of labels so that it holds exactly
+// the labels for the numbers 1 to count
+//-------------------------------------------------------------
+void GraphicsScene::resize_label_pool_( QList<PatternGridLabel*>& pool,
+                                        int count, int labelType )
 {
-  QList<QGraphicsItem*> allItems( items() );
-
-  /* go through all items and make sure that that
-   * inserting the columns won't cut through any
-   * multy row cells */
-  foreach( QGraphicsItem* anItem, allItems ) {
-    PatternGridItem* cell =
-      qgraphicsitem_cast<PatternGridItem*>( anItem );
-
-    if ( cell != 0 ) {
-      /* do we want to shift the columns */
-      if ( colPivot != NOSHIFT ) {
-        if ( cell->col() >= colPivot ) {
-          cell->reseat( cell->col() + 1, cell->row() );
-          cell->setPos( compute_cell_origin_( cell->col(), cell->row() ) );
-        }
-      }
-
-      /* do we want to shift the rows */
-      if ( rowPivot != NOSHIFT ) {
-        if ( cell->row() > rowPivot ) {
-          /* Note: we shift the cell first and can the just
-           * use its new position, i.e. no row()+1 in set Pos */
-          cell->reseat( cell->col(), cell->row() + 1 );
-          cell->setPos( compute_cell_origin_( cell->col(), cell->row() ) );
-        }
-      }
-    }
-  }
-
-  /* adjust the row/col count and also shift the legend items */
-  if ( colPivot != NOSHIFT ) {
-    shift_legend_items_horizontally_( colPivot, gridCellDimensions_.width() );
-    numCols_ += 1;
+  while ( pool.size() > count ) {
+    PatternGridLabel* deadLabel = pool.takeLast();
+    removeItem( deadLabel );
+    deadLabel->deleteLater();
   }
 
-  if ( rowPivot != NOSHIFT ) {
-    shift_legend_items_vertically_( rowPivot, gridCellDimensions_.height() );
-    numRows_ += 1;
+  QString label;
+  while ( pool.size() < count ) {
+    PatternGridLabel* text =
+      new PatternGridLabel( label.setNum( pool.size() + 1 ), labelType );
+    text->setFont( textFont_ );
+    addItem( text );
+    pool.push_back( text );
   }
 }
 
@@ -1823,6 +1701,8 @@ void GraphicsScene::purge_legend_()
   legendEntries_.clear();
   symbolDescriptors_.clear();
   usedKnittingSymbols_.clear();
+  pendingLegendKeys_.clear();
+  legendKeys_.clear();
 
   legendIsVisible_ = false;
 }
@@ -1832,27 +1712,35 @@ void GraphicsScene::purge_legend_()
 //---------------------------------------------------------------
 // remove all items on canvas
 //
-// NOTE: Since the SVGItems are owned by each PatternGridItem
-// we have to make sure we don't remove them explicitly.
+// NOTE: Symbols are painted by the items themselves and none
+// of our items has child items, so each item is deleted
+// exactly once.
 //
 // NOTE: Since we call delete directly, make sure that this
 // function is never called in an event handler.
 //---------------------------------------------------------------
 void GraphicsScene::purge_all_canvas_items_()
 {
-  /* collect all non svgItems first */
   QList<QGraphicsItem*> allItems( items() );
-  QList<QGraphicsItem*> nonSvgItems;
-  foreach( QGraphicsItem* anItem, allItems ) {
-    if ( anItem->type() != QGraphicsSvgItem::Type ) {
-      nonSvgItems.push_back( anItem );
-    }
-  }
 
-  foreach( QGraphicsItem* finalItem, nonSvgItems ) {
+  begin_transaction_( BULK_TRANSACTION );
+  foreach( QGraphicsItem* finalItem, allItems ) {
     removeItem( finalItem );
     delete finalItem;
   }
+  commit_transaction_();
+
+  /* the ChartGridItem, selection and labels went with the rest */
+  chartGrid_ = 0;
+  selectionItem_ = 0;
+  selection_.clear();
+  columnLabels_.clear();
+  rowLabels_.clear();
+  gridRectangles_.clear();
+  floatingItems_.clear();
+  hoveringFloatingItem_ = false;
+  virtualGrid_ = false;
+  chartModel_.reset( 0, 0 );
 }
 
 
@@ -1870,76 +1758,52 @@ void GraphicsScene::update_active_items_()
 
 
 
-//-----------------------------------------------------------
-// return if a row of PatternGridItems is contiguous, i.e.
-// there are no holes, and the number of unit cells covered
-// by the row (holes not counted)
-//-----------------------------------------------------------
-QPair<bool, int> GraphicsScene::is_row_contiguous_(
-  const RowItems& aRow ) const
+//-------------------------------------------------------------
+// compute the rectangle of grid cells (in cell coordinates)
+// touching region. Returns a null rectangle if the region
+// misses the grid.
+//-------------------------------------------------------------
+QRect GraphicsScene::region_to_cells_( const QRectF& aRegion ) const
 {
-  /* an empty row is contiguous */
-  if ( aRow.empty() ) {
-    return QPair<bool, int>( true, 0 );
-  }
+  QPair<int, int> topLeft( get_cell_coords_( aRegion.topLeft() ) );
+  QPair<int, int> bottomRight( get_cell_coords_( aRegion.bottomRight() ) );
 
-  int currentCol = aRow.at( 0 )->col();
-  int rowWidth   = aRow.at( 0 )->dim().width();
-  int totalWidth = 0;
-  bool status    = true;
-  for ( int index = 1; index < aRow.size(); ++index ) {
-    int rowCol   = aRow.at( index )->col();
-    if (( currentCol + rowWidth ) != rowCol ) {
-      status = false;
-    }
-
-    currentCol = rowCol;
-    totalWidth += rowWidth;
-    rowWidth = aRow.at( index )->dim().width();
+  int firstCol = qMax( topLeft.first, 0 );
+  int lastCol  = qMin( bottomRight.first, numCols_ - 1 );
+  int firstRow = qMax( topLeft.second, 0 );
+  int lastRow  = qMin( bottomRight.second, numRows_ - 1 );
+  if ( firstCol > lastCol || firstRow > lastRow ) {
+    return QRect();
   }
 
-  return QPair<bool, int>( status, totalWidth );
+  return QRect( QPoint( firstCol, firstRow ), QPoint( lastCol, lastRow ) );
 }
 
 
+
 //-------------------------------------------------------------
-// given a list of RowItems, determines the size of the
-// rectangle that bounds them all. The rows are assumed
-// to be in increasing order of y with respect to the
-// origin
+// toggle the selection of the chart cell covering col, row
 //-------------------------------------------------------------
-QRect GraphicsScene::find_bounding_rectangle_(
-  const QList<RowItems>& rows ) const
+void GraphicsScene::toggle_cell_selection_( int col, int row )
 {
-  assert( !rows.empty() );
-
-  /* get index of upper left corner */
-  RowItems firstRow = rows.first();
-  assert( !firstRow.empty() );
-  int upperLeftColIndex = firstRow.first()->col();
-  int upperLeftRowIndex = firstRow.first()->row();
+  selection_.toggle_cell( col, row );
+  selection_changed_( row, row );
+}
 
-  /* get index of lower right corner */
-  RowItems lastRow = rows.last();
-  assert( !lastRow.empty() );
-  int lowerRightColIndex  = lastRow.last()->col();
-  int lowerRightRowIndex  = lastRow.last()->row();
-  int lowerRightCellWidth = lastRow.last()->dim().width();
-  int lowerRightCellHeight = lastRow.last()->dim().height();
 
-  /* compute coordinates */
-  QPoint upperLeftCorner( origin_.x() + upperLeftColIndex * gridCellDimensions_.width(),
-                          origin_.y() + upperLeftRowIndex
-                          * gridCellDimensions_.height() );
 
-  QPoint lowerRightCorner( origin_.x() - 1
-                           + ( lowerRightColIndex + lowerRightCellWidth )
-                           * gridCellDimensions_.width(),
-                           origin_.y() - 1
-                           + ( lowerRightRowIndex + lowerRightCellHeight )
-                           * gridCellDimensions_.height() );
+//-------------------------------------------------------------
+// redraw the rows firstRow to lastRow after the user changed
+// the selection in them and try placing the current knitting
+// symbol into it (unless this is temporarily disabled)
+//-------------------------------------------------------------
+void GraphicsScene::selection_changed_( int firstRow, int lastRow )
+{
+  selectionItem_->update_rows( firstRow, lastRow );
 
-  return QRect( upperLeftCorner, lowerRightCorner );
+  if ( updateActiveItems_ ) {
+    update_active_items_();
+  }
 }
 
 
@@ -1951,10 +1815,10 @@ QRect GraphicsScene::find_bounding_rectangle_(
 bool GraphicsScene::handle_click_on_marker_rectangle_(
   const QGraphicsSceneMouseEvent* mouseEvent )
 {
-  /* get all items at pos and grab all patternGridRectangles
-   * if any */
+  /* get all floating items at pos and grab all
+   * patternGridRectangles if any */
   QPointF mousePos( mouseEvent->scenePos() );
-  QList<QGraphicsItem*> itemsUnderMouse = items( mousePos );
+  QList<QGraphicsItem*> itemsUnderMouse = floatingItems_.items_at( mousePos );
 
   QList<PatternGridRectangle*> rectangles;
   foreach( QGraphicsItem* anItem, itemsUnderMouse ) {
@@ -2008,10 +1872,15 @@ bool GraphicsScene::handle_click_on_grid_array_(
     QMenu gridMenu;
     QAction* copyAction = gridMenu.addAction( "&Copy" );
     QAction* pasteAction = gridMenu.addAction( "&Paste" );
+    QAction* pasteTiledAction =
+      gridMenu.addAction( "Paste &tiled into selection" );
+    pasteTiledAction->setEnabled( !selection_.is_empty() );
     gridMenu.addSeparator();
     QAction* rowAction  = gridMenu.addAction( "Insert/delete rows & columns" );
     gridMenu.addSeparator();
     QAction* colorAction = gridMenu.addAction( "Grab color" );
+    QAction* replaceColorAction =
+      gridMenu.addAction( "Use active color for all cells of this color" );
 
     connect( rowAction,
              SIGNAL( triggered() ),
@@ -2028,11 +1897,21 @@ bool GraphicsScene::handle_click_on_grid_array_(
              this,
              SLOT( paste_items_() ) );
 
+    connect( pasteTiledAction,
+             SIGNAL( triggered() ),
+             this,
+             SLOT( paste_items_tiled_() ) );
+
     connect( colorAction,
              SIGNAL( triggered() ),
              this,
              SLOT( grab_color_() ) );
 
+    connect( replaceColorAction,
+             SIGNAL( triggered() ),
+             this,
+             SLOT( replace_selected_color_() ) );
+
     gridMenu.exec( mouseEvent->screenPos() );
   }
 
@@ -2064,6 +1943,20 @@ bool GraphicsScene::handle_click_on_grid_labels_(
 
 
 
+//----------------------------------------------------------------
+// returns true if the mouse at pos needs QGraphicsScene's
+// default event handling, i.e., if an item grabbed the mouse
+// or there is a floating item under it. The latter are legend
+// items, labels and the lines of marker rectangles; clicks
+// anywhere else belong to the chart cells.
+//----------------------------------------------------------------
+bool GraphicsScene::wants_item_event_( const QPointF& pos ) const
+{
+  return mouseGrabberItem() != 0 || floatingItems_.item_at( pos ) != 0;
+}
+
+
+
 //---------------------------------------------------------------
 // generate a menu allowing the user to customize or delete
 // a pattern grid rectangle
@@ -2116,32 +2009,300 @@ void GraphicsScene::show_rectangle_manage_menu_(
 
 
 //-------------------------------------------------------------
-// use this function to add a PatternGridItem to the scene.
-// In addition to that we also update the referene count of
-// currently active knitting symbols
+// place a new chart cell of the given width, symbol and color
+// at col, row. In addition to that we also update the
+// reference count of currently active knitting symbols.
+// For virtual grids the cell only lives in the chart model
+// and is drawn by the ChartGridItem, otherwise a
+// PatternGridItem is created for it.
+//-------------------------------------------------------------
+void GraphicsScene::place_cell_( int col, int row, int width,
+                                 const KnittingSymbolPtr symbol,
+                                 const QColor& color )
+{
+  /* knitting symbols with their own color always use it */
+  QColor cellColor( color );
+  if ( symbol->color_name() != "" ) {
+    cellColor = QColor( symbol->color_name() );
+  }
+
+  chartModel_.set_cell( col, row, width, symbol, cellColor );
+  add_legend_reference_( legendKeys_.intern( symbol, cellColor,
+                                             CHART_LEGEND_TAG ) );
+
+  if ( virtualGrid_ ) {
+    chartGrid_->update_cells( col, row, width );
+  } else {
+    materialize_cell_( col, row );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// remove the chart cell covering col, row including the
+// PatternGridItem displaying it (if any) and update the
+// reference count of currently active knitting symbols.
+// The cell is left behind as empty unit cells.
+//-------------------------------------------------------------
+void GraphicsScene::remove_cell_( int col, int row )
+{
+  int originCol = chartModel_.origin_column( col, row );
+  int cellWidth = chartModel_.width( originCol, row );
+  remove_legend_reference_(
+    legendKeys_.intern( chartModel_.symbol( originCol, row ),
+                        QColor( chartModel_.color( originCol, row ) ),
+                        CHART_LEGEND_TAG ) );
+
+  PatternGridItem* deadItem = chartModel_.item( originCol, row );
+  if ( deadItem != 0 ) {
+    removeItem( deadItem );
+    delete deadItem;
+  }
+
+  chartModel_.clear_cell( originCol, row );
+
+  if ( virtualGrid_ ) {
+    chartGrid_->update_cells( originCol, row, cellWidth );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// change symbol and color of the chart cell at col, row in
+// place, i.e., keeping its PatternGridItem (if any) and only
+// touching the legend reference counts
+//-------------------------------------------------------------
+void GraphicsScene::restyle_cell_( int col, int row,
+                                   const KnittingSymbolPtr symbol,
+                                   const QColor& color )
+{
+  assert( chartModel_.origin_column( col, row ) == col );
+
+  /* knitting symbols with their own color always use it */
+  QColor cellColor( color );
+  if ( symbol->color_name() != "" ) {
+    cellColor = QColor( symbol->color_name() );
+  }
+
+  KnittingSymbolPtr oldSymbol = chartModel_.symbol( col, row );
+  QColor oldColor( chartModel_.color( col, row ) );
+  if ( oldSymbol == symbol && oldColor == cellColor ) {
+    return;
+  }
+
+  remove_legend_reference_( legendKeys_.intern( oldSymbol, oldColor,
+                                                CHART_LEGEND_TAG ) );
+
+  int cellWidth = chartModel_.width( col, row );
+  PatternGridItem* anItem = chartModel_.item( col, row );
+  chartModel_.set_cell( col, row, cellWidth, symbol, cellColor, anItem );
+  add_legend_reference_( legendKeys_.intern( symbol, cellColor,
+                                             CHART_LEGEND_TAG ) );
+
+  if ( anItem != 0 ) {
+    anItem->insert_knitting_symbol( symbol );
+  } else if ( chartGrid_ != 0 ) {
+    chartGrid_->update_cells( col, row, cellWidth );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// return the PatternGridItem displaying the chart cell
+// covering col, row and create it if there is none yet
 //-------------------------------------------------------------
-void GraphicsScene::add_patternGridItem_( PatternGridItem* anItem )
+PatternGridItem* GraphicsScene::materialize_cell_( int col, int row )
 {
+  int originCol = chartModel_.origin_column( col, row );
+  PatternGridItem* anItem = chartModel_.item( originCol, row );
+  if ( anItem != 0 ) {
+    return anItem;
+  }
+
+  anItem = new PatternGridItem( QSize( chartModel_.width( originCol, row ), 1 ),
+                                cellStyle_, originCol, row );
+  anItem->Init();
+  anItem->setPos( compute_cell_origin_( originCol, row ) );
+  anItem->insert_knitting_symbol( chartModel_.symbol( originCol, row ) );
   addItem( anItem );
-  notify_legend_of_item_addition_( anItem->get_knitting_symbol(),
-                                   anItem->color(), "chartLegendItem" );
+  chartModel_.set_item( originCol, row, anItem );
+
+  return anItem;
+}
+
+
+
+//-------------------------------------------------------------
+// decide how to display the pattern grid based on its size
+// and set up the ChartGridItem for virtual grids as well as
+// the selection overlay. Needs to be called whenever a new
+// grid is created.
+//-------------------------------------------------------------
+void GraphicsScene::setup_grid_view_()
+{
+  virtualGrid_ = ( numCols_ * numRows_ > VIRTUAL_GRID_THRESHOLD );
+
+  if ( virtualGrid_ && chartGrid_ == 0 ) {
+    chartGrid_ = new ChartGridItem( chartModel_, origin_, cellStyle_ );
+    chartGrid_->Init();
+    addItem( chartGrid_ );
+  } else if ( !virtualGrid_ && chartGrid_ != 0 ) {
+    removeItem( chartGrid_ );
+    delete chartGrid_;
+    chartGrid_ = 0;
+  }
+
+  if ( chartGrid_ != 0 ) {
+    chartGrid_->update_geometry();
+  }
+
+  journal_.clear();
+  journal_changed_();
+
+  selection_.clear();
+  if ( selectionItem_ == 0 ) {
+    selectionItem_ = new ChartSelectionItem( selection_, origin_,
+                                             gridCellDimensions_ );
+    selectionItem_->Init();
+    addItem( selectionItem_ );
+  }
+  selectionItem_->update_geometry();
+}
+
+
+
+//-------------------------------------------------------------
+// remove all cells overlapping width unit cells starting at
+// col, row. Parts of wider cells sticking out of this range
+// are refilled with empty unit cells.
+//-------------------------------------------------------------
+void GraphicsScene::clear_cells_( int col, int row, int width )
+{
+  int lastCol = col + width;
+  int column = chartModel_.origin_column( col, row );
+  while ( column < lastCol ) {
+    int cellWidth = chartModel_.width( column, row );
+    remove_cell_( column, row );
+
+    for ( int unitCol = column; unitCol < column + cellWidth; ++unitCol ) {
+      if ( unitCol < col || unitCol >= lastCol ) {
+        place_cell_( unitCol, row, 1, defaultSymbol_, defaultColor_ );
+      }
+    }
+
+    column += cellWidth;
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// pick up chart cells from the system clipboard (which may
+// have been copied in another window or sconcho instance).
+// If the clipboard holds none we stick with whatever we copied
+// last. Returns true if there is something to paste.
+//-------------------------------------------------------------
+bool GraphicsScene::fetch_copied_items_()
+{
+  const QMimeData* clipboardData = QApplication::clipboard()->mimeData();
+  if ( clipboardData != 0
+       && clipboardData->hasFormat( CHART_CELLS_MIME_TYPE ) ) {
+    CopyObject clipboardItems;
+    if ( decode_copy_object( clipboardData->data( CHART_CELLS_MIME_TYPE ),
+                             allSymbols_, clipboardItems ) ) {
+      copiedItems_ = clipboardItems;
+    } else {
+      emit statusBar_error( tr( "Could not read chart cells from "
+                                "the clipboard" ) );
+      return false;
+    }
+  }
+
+  return !copiedItems_.runs.empty();
+}
+
+
+
+//-------------------------------------------------------------
+// paste the copied cells into target (in cell coordinates),
+// repeating them as often as they fit. Copied cells that
+// would stick out of target are skipped. The copied runs are
+// expanded into cells as we go. Target cells are
+// addressed straight through the chart model and cells which
+// already have the width of the pasted one are restyled in
+// place instead of being recreated.
+//-------------------------------------------------------------
+void GraphicsScene::paste_copied_items_( const QRect& target )
+{
+  assert( copiedItems_.width > 0 && copiedItems_.height > 0 );
+
+  begin_edit_();
+  for ( int row = target.top(); row <= target.bottom(); ++row ) {
+    journal_cells_( row, target.left(), target.right() );
+  }
+
+  for ( int tileRow = target.top(); tileRow <= target.bottom();
+        tileRow += copiedItems_.height ) {
+    for ( int tileCol = target.left(); tileCol <= target.right();
+          tileCol += copiedItems_.width ) {
+      foreach( CopyObjectRun run, copiedItems_.runs ) {
+        int targetRow = tileRow + run.row;
+        int targetWidth = run.width;
+        if ( targetRow > target.bottom() ) {
+          continue;
+        }
+
+        for ( int cell = 0; cell < run.count; ++cell ) {
+          int targetCol = tileCol + run.column + cell * targetWidth;
+          if ( targetCol + targetWidth - 1 > target.right() ) {
+            break;
+          }
+
+          if ( chartModel_.origin_column( targetCol, targetRow ) == targetCol
+               && chartModel_.width( targetCol, targetRow ) == targetWidth ) {
+            restyle_cell_( targetCol, targetRow, run.symbol,
+                           run.backColor );
+          } else {
+            clear_cells_( targetCol, targetRow, targetWidth );
+            place_cell_( targetCol, targetRow, targetWidth, run.symbol,
+                         run.backColor );
+          }
+        }
+      }
+    }
+  }
+  commit_edit_();
 }
 
 
 
 //-------------------------------------------------------------
-// use this function to remove a PatternGridItem from the scene.
-// In addition to that we also update the referene count of
-// currently active knitting symbols
+// move all PatternGridItems whose location in the chart model
+// changed (e.g. after inserting or deleting rows/columns) to
+// their new position on the canvas
 //-------------------------------------------------------------
-void GraphicsScene::remove_patternGridItem_( PatternGridItem* anItem )
+void GraphicsScene::reseat_moved_items_()
 {
-  removeItem( anItem );
-  notify_legend_of_item_removal_( anItem->get_knitting_symbol(),
-                                  anItem->color(), "chartLegendItem" );
+  int numModelCols = chartModel_.num_columns();
+  for ( int row = 0; row < chartModel_.num_rows(); ++row ) {
+    int col = 0;
+    while ( col < numModelCols ) {
+      PatternGridItem* cell = chartModel_.item( col, row );
+      if ( cell != 0 && ( cell->col() != col || cell->row() != row ) ) {
+        cell->reseat( col, row );
+        cell->setPos( compute_cell_origin_( col, row ) );
+      }
+
+      col += chartModel_.width( col, row );
+    }
+  }
 
-  /* delete it for good */
-  anItem->deleteLater();
+  if ( chartGrid_ != 0 ) {
+    chartGrid_->update_geometry();
+  }
 }
 
 
@@ -2248,6 +2409,435 @@ void GraphicsScene::update_legend_labels_()
 
 
 
+//-------------------------------------------------------------
+// start recording an undoable edit. Edits don't nest; they
+// open a scene transaction as well.
+//-------------------------------------------------------------
+void GraphicsScene::begin_edit_( EditJournal::StepKind kind )
+{
+  journal_.begin_step( kind );
+  begin_transaction_();
+}
+
+
+
+//-------------------------------------------------------------
+// finish recording an undoable edit. This is where we learn
+// what the announced cells look like now.
+//-------------------------------------------------------------
+void GraphicsScene::commit_edit_()
+{
+  commit_transaction_();
+
+  JournalStep& step = journal_.open_step();
+  for ( int index = 0; index < step.size(); ++index ) {
+    JournalOp& op = step[index];
+    if ( op.type == JournalOp::Cells ) {
+      op.after = snapshot_cells_( op.row, op.column, op.column + op.count );
+    }
+  }
+
+  journal_.end_step();
+  journal_changed_();
+}
+
+
+
+//-------------------------------------------------------------
+// announce that the cells between firstCol and lastCol of row
+// are about to change. The range is widened to whole chart
+// cells. Outside of an edit (e.g. while undoing) this does
+// nothing.
+//-------------------------------------------------------------
+void GraphicsScene::journal_cells_( int row, int firstCol, int lastCol )
+{
+  if ( !journal_.step_is_open() ) {
+    return;
+  }
+
+  int start = chartModel_.origin_column( firstCol, row );
+  int lastOrigin = chartModel_.origin_column( lastCol, row );
+  int end = lastOrigin + chartModel_.width( lastOrigin, row );
+
+  JournalOp op;
+  op.type = JournalOp::Cells;
+  op.row = row;
+  op.column = start;
+  op.count = end - start;
+  op.before = snapshot_cells_( row, start, end );
+  journal_.add_op( op );
+}
+
+
+
+//-------------------------------------------------------------
+// announce that count rows or columns are about to be
+// inserted or deleted at index. For deletes we keep the
+// cells about to disappear.
+//-------------------------------------------------------------
+void GraphicsScene::journal_structure_( JournalOp::Type type, int index,
+                                        int count )
+{
+  if ( !journal_.step_is_open() ) {
+    return;
+  }
+
+  JournalOp op;
+  op.type = type;
+  op.row = index;
+  op.column = index;
+  op.count = count;
+
+  if ( type == JournalOp::DeleteRows ) {
+    for ( int row = index; row < index + count; ++row ) {
+      op.before += snapshot_cells_( row, 0, numCols_ );
+    }
+  } else if ( type == JournalOp::DeleteColumns ) {
+    for ( int row = 0; row < numRows_; ++row ) {
+      op.before += snapshot_cells_( row, index, index + count );
+    }
+  }
+
+  journal_.add_op( op );
+}
+
+
+
+//-------------------------------------------------------------
+// record the chart cells of row covering the unit columns
+// [col, endCol); both need to be cell boundaries
+//-------------------------------------------------------------
+JournalCells GraphicsScene::snapshot_cells_( int row, int col, int endCol )
+{
+  JournalCells cells;
+  int column = col;
+  while ( column < endCol ) {
+    JournalCell cell;
+    cell.width = chartModel_.width( column, row );
+    cell.symbol = journal_.intern( chartModel_.symbol( column, row ) );
+    cell.color = chartModel_.color( column, row );
+    cells.push_back( cell );
+
+    column += cell.width;
+  }
+
+  return cells;
+}
+
+
+
+//-------------------------------------------------------------
+// replace the unit columns [col, endCol) of row with recorded
+// cells starting at index first and return the index of the
+// first cell not used
+//-------------------------------------------------------------
+int GraphicsScene::write_cells_( int row, int col, int endCol,
+                                 const JournalCells& cells, int first )
+{
+  clear_cells_( col, row, endCol - col );
+
+  int index = first;
+  int column = col;
+  while ( column < endCol ) {
+    const JournalCell& cell = cells.at( index );
+    place_cell_( column, row, cell.width, journal_.symbol( cell.symbol ),
+                 QColor( cell.color ) );
+
+    column += cell.width;
+    ++index;
+  }
+
+  return index;
+}
+
+
+
+//-------------------------------------------------------------
+// undo a single journal op
+//-------------------------------------------------------------
+void GraphicsScene::revert_journal_op_( const JournalOp& op )
+{
+  if ( op.type == JournalOp::Cells ) {
+    write_cells_( op.row, op.column, op.column + op.count, op.before );
+  } else if ( op.type == JournalOp::InsertRows ) {
+    delete_grid_rows_( op.row, op.count );
+  } else if ( op.type == JournalOp::DeleteRows ) {
+    insert_grid_rows_( op.row, op.count );
+    int index = 0;
+    for ( int row = op.row; row < op.row + op.count; ++row ) {
+      index = write_cells_( row, 0, numCols_, op.before, index );
+    }
+  } else if ( op.type == JournalOp::InsertColumns ) {
+    delete_grid_columns_( op.column, op.count );
+  } else if ( op.type == JournalOp::DeleteColumns ) {
+    insert_grid_columns_( op.column, op.count );
+    int index = 0;
+    for ( int row = 0; row < numRows_; ++row ) {
+      index = write_cells_( row, op.column, op.column + op.count,
+                            op.before, index );
+    }
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// redo a single journal op
+//-------------------------------------------------------------
+void GraphicsScene::apply_journal_op_( const JournalOp& op )
+{
+  if ( op.type == JournalOp::Cells ) {
+    write_cells_( op.row, op.column, op.column + op.count, op.after );
+  } else if ( op.type == JournalOp::InsertRows ) {
+    insert_grid_rows_( op.row, op.count );
+  } else if ( op.type == JournalOp::DeleteRows ) {
+    delete_grid_rows_( op.row, op.count );
+  } else if ( op.type == JournalOp::InsertColumns ) {
+    insert_grid_columns_( op.column, op.count );
+  } else if ( op.type == JournalOp::DeleteColumns ) {
+    delete_grid_columns_( op.column, op.count );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// let the world know what can be undone/redone
+//-------------------------------------------------------------
+void GraphicsScene::journal_changed_()
+{
+  emit undo_available( journal_.can_undo() );
+  emit redo_available( journal_.can_redo() );
+}
+
+
+
+//-------------------------------------------------------------
+// start a scene transaction. Until the matching commit the
+// legend only keeps track of reference counts; legend entries
+// are created or removed once at commit time based on the net
+// change. Transactions nest; if any of them is a bulk
+// transaction the scene stays paused until the outermost one
+// commits.
+//-------------------------------------------------------------
+void GraphicsScene::begin_transaction_( TransactionType type )
+{
+  ++transactionDepth_;
+
+  if ( type == BULK_TRANSACTION && !scenePaused_ ) {
+    pause_scene_();
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// finish a scene transaction. Once the outermost one is
+// committed we sync the legend with the reference counts
+// of all keys touched in the meantime.
+//-------------------------------------------------------------
+void GraphicsScene::commit_transaction_()
+{
+  assert( transactionDepth_ > 0 );
+
+  --transactionDepth_;
+  if ( transactionDepth_ > 0 ) {
+    return;
+  }
+
+  QList<int> touchedKeys( pendingLegendKeys_.toList() );
+  qSort( touchedKeys );
+  pendingLegendKeys_.clear();
+
+  /* remove dead entries first so new ones can take their place */
+  QList<int> newKeys;
+  foreach( int keyId, touchedKeys ) {
+    bool hasEntry = legendEntries_.contains( legendKeys_.name( keyId ) );
+    int count = usedKnittingSymbols_.at( keyId );
+    if ( count == 0 && hasEntry ) {
+      remove_legend_entry_( keyId );
+    } else if ( count > 0 && !hasEntry ) {
+      newKeys.push_back( keyId );
+    }
+  }
+
+  foreach( int keyId, newKeys ) {
+    create_legend_entry_( keyId );
+  }
+
+  if ( scenePaused_ ) {
+    resume_scene_();
+  }
+
+  if ( !newKeys.empty() && legendIsVisible_ ) {
+    emit show_whole_scene();
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// stop maintaining the item index and repainting the views.
+// Adding, moving or removing lots of items is much cheaper
+// this way than keeping the BSP tree up to date after each
+// one of them. Signals keep flowing; the views rely on
+// sceneRectChanged and the main window on undo_available and
+// redo_available while we are paused.
+//-------------------------------------------------------------
+void GraphicsScene::pause_scene_()
+{
+  scenePaused_ = true;
+
+  pausedIndexMethod_ = itemIndexMethod();
+  setItemIndexMethod( NoIndex );
+
+  foreach( QGraphicsView* aView, views() ) {
+    aView->viewport()->setUpdatesEnabled( false );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// rebuild the item index in one go and repaint the views once
+//-------------------------------------------------------------
+void GraphicsScene::resume_scene_()
+{
+  setItemIndexMethod( pausedIndexMethod_ );
+  scenePaused_ = false;
+
+  foreach( QGraphicsView* aView, views() ) {
+    aView->viewport()->setUpdatesEnabled( true );
+  }
+  update( sceneRect() );
+}
+
+
+
+//-------------------------------------------------------------
+// bump the reference count of an interned legend key by count
+// and create its legend entry if it is the first of its kind
+//-------------------------------------------------------------
+void GraphicsScene::add_legend_reference_( int keyId, int count )
+{
+  if ( keyId >= usedKnittingSymbols_.size() ) {
+    usedKnittingSymbols_.resize( legendKeys_.size() );
+  }
+
+  int currentValue = usedKnittingSymbols_[keyId] += count;
+  assert( currentValue > 0 );
+
+  if ( transactionDepth_ > 0 ) {
+    pendingLegendKeys_.insert( keyId );
+  } else if ( currentValue == count ) {
+    create_legend_entry_( keyId );
+    if ( legendIsVisible_ ) {
+      emit show_whole_scene();
+    }
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// drop the reference count of an interned legend key by count
+// and remove its legend entry once it hits 0
+//-------------------------------------------------------------
+void GraphicsScene::remove_legend_reference_( int keyId, int count )
+{
+  assert( keyId < usedKnittingSymbols_.size() );
+
+  int currentValue = usedKnittingSymbols_[keyId] -= count;
+  assert( currentValue >= 0 );
+
+  if ( transactionDepth_ > 0 ) {
+    pendingLegendKeys_.insert( keyId );
+  } else if ( currentValue == 0 ) {
+    remove_legend_entry_( keyId );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// create the legend item and label for an interned legend key
+//-------------------------------------------------------------
+void GraphicsScene::create_legend_entry_( int keyId )
+{
+  const KnittingSymbolPtr symbol = legendKeys_.symbol( keyId );
+  QColor aColor = legendKeys_.color( keyId );
+  const QString& tag = legendKeys_.tag( keyId );
+  const QString& fullName = legendKeys_.name( keyId );
+
+  /* compute position for next label item */
+  int xPosSym = origin_.x();
+  int yPos = get_next_legend_items_y_position_();
+
+  LegendItem* newLegendItem = new LegendItem( symbol->dim(), tag,
+      cellStyle_, aColor );
+  connect( newLegendItem,
+           SIGNAL( delete_from_legend( KnittingSymbolPtr, QColor, QString ) ),
+           this,
+           SLOT( notify_legend_of_item_removal_( KnittingSymbolPtr, QColor,
+                                                 QString ) )
+         );
+  newLegendItem->Init();
+  newLegendItem->insert_knitting_symbol( symbol );
+  newLegendItem->setPos( xPosSym, yPos );
+  newLegendItem->setFlag( QGraphicsItem::ItemIsMovable );
+  newLegendItem->setZValue( 1 );
+  addItem( newLegendItem );
+  floatingItems_.insert( newLegendItem );
+
+  /* add label */
+  QString description = get_symbol_description_( symbol, aColor.name() );
+  int xPosLabel = ( symbol->dim().width() + 0.5 ) * gridCellDimensions_.width()
+                  + origin_.x();
+
+  LegendLabel* newTextItem =
+    new LegendLabel( fullName, description );
+  newTextItem->Init();
+  newTextItem->setPos( xPosLabel, yPos );
+  newTextItem->setFont( textFont_ );
+  newTextItem->setFlag( QGraphicsItem::ItemIsMovable );
+  newTextItem->setZValue( 1 );
+  addItem( newTextItem );
+  floatingItems_.insert( newTextItem );
+  connect( newTextItem,
+           SIGNAL( label_changed( QString, QString ) ),
+           this,
+           SLOT( update_key_label_text_( QString, QString ) )
+         );
+
+  legendEntries_[fullName] = LegendEntry( newLegendItem, newTextItem );
+
+  if ( !legendIsVisible_ ) {
+    newLegendItem->hide();
+    newTextItem->hide();
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// delete the legend item and label for an interned legend key
+//-------------------------------------------------------------
+void GraphicsScene::remove_legend_entry_( int keyId )
+{
+  const QString& fullName = legendKeys_.name( keyId );
+
+  LegendEntry deadItem = legendEntries_[fullName];
+  floatingItems_.remove( deadItem.first );
+  floatingItems_.remove( deadItem.second );
+  removeItem( deadItem.first );
+  deadItem.first->deleteLater();
+  removeItem( deadItem.second );
+  deadItem.second->deleteLater();
+  legendEntries_.remove( fullName );
+}
+
+
+
 //-------------------------------------------------------------
 // shift all legend items below pivot by "distance"
 // vertically
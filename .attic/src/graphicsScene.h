@@ -29,22 +29,35 @@
 #include <QColor>
 #include <QGraphicsScene>
 #include <QPair>
+#include <QSet>
 #include <QList>
 #include <QMap>
+#include <QVector>
 
 /* local includes */
+#include "cellStyle.h"
+#include "chartClipboard.h"
+#include "chartModel.h"
+#include "chartSelection.h"
+#include "editJournal.h"
+#include "floatingItemIndex.h"
+#include "legendKeyTable.h"
 #include "knittingSymbol.h"
 #include "io.h"
+#include "symbolCatalog.h"
 
 
 QT_BEGIN_NAMESPACE
 
 
 /* a few forward declarations */
+class ChartGridItem;
+class ChartSelectionItem;
 class LegendItem;
 class LegendLabel;
 class KnittingPatternItem;
 class PatternGridItem;
+class PatternGridLabel;
 class PatternGridRectangle;
 class QGraphicsSceneMouseEvent;
 class QKeyEvent;
@@ -56,40 +69,14 @@ namespace
 {
 /* convenience constants */
 const int UNSELECTED = -100;
-const int NOSHIFT    = -101;
 
 /* convenience typedefs */
 typedef QList<QPair<int, int> > RowLayout;
-typedef QList<PatternGridItem*> RowItems;
 typedef QPair<LegendItem*, LegendLabel*> LegendEntry;
 };
 
 
 
-/****************************************************************
- *
- * definitions of copy object
- *
- ***************************************************************/
-struct CopyObjectItem {
-  KnittingSymbolPtr symbol;
-  QColor backColor;
-  QSize size;
-  int row;
-  int column;
-};
-typedef boost::shared_ptr<CopyObjectItem> CopyObjectItemPtr;
-
-
-struct CopyObject {
-  QList<CopyObjectItemPtr> objects;
-  int width;    // width of copy object in columns
-  int height;   // height of copy object in rows
-};
-
-
-
-
 /***************************************************************
  *
  * The GraphicsScene handles the sconcho's main drawing
@@ -110,15 +97,16 @@ public:
 
   explicit GraphicsScene( const QPoint& origin, const QSize& gridsize,
                           const QSettings& settings,
+                          const SymbolCatalog& allSymbols,
                           KnittingSymbolPtr defaultSymbol,
                           MainWindow* myParent = 0 );
   bool Init();
 
   /* helper functions */
   void select_region( const QRectF& region );
+  void preview_region( const QRectF& region );
   void reset_grid( const QSize& newSize );
-  void load_new_canvas(
-    const QList<PatternGridItemDescriptorPtr>& newItems );
+  void load_new_canvas( const ChartModel& newChart );
   void instantiate_legend_items(
     const QList<LegendEntryDescriptorPtr>& newExtraLegendItems );
   void place_legend_items(
@@ -126,6 +114,10 @@ public:
   QRectF get_visible_area() const;
   QPoint get_grid_center() const;
 
+  /* access to the underlying chart data */
+  const ChartModel& chart_model() const { return chartModel_; }
+  const ChartSelection& selection() const { return selection_; }
+
   /* legend releated stuff */
   bool legend_is_visible() const { return legendIsVisible_; }
   void hide_all_but_legend();
@@ -142,20 +134,22 @@ signals:
   void statusBar_message( QString msg );
   void show_whole_scene();
   void grabbed_color( const QColor& aColor );
+  void undo_available( bool status );
+  void redo_available( bool status );
 
 
 public slots:
 
   void update_selected_symbol( const KnittingSymbolPtr symbol );
   void add_symbol_to_legend( const KnittingSymbolPtr symbol );
-  void grid_item_selected( PatternGridItem* item, bool status );
-  void grid_item_reset( PatternGridItem* item );
   void update_selected_background_color( const QColor& aColor );
   void deselect_all_active_items();
   void mark_active_cells_with_rectangle();
   void update_after_settings_change();
   void toggle_legend_visibility();
   void load_settings();
+  void undo();
+  void redo();
 
 
 protected:
@@ -176,7 +170,9 @@ private slots:
   void update_key_label_text_( QString, QString );
   void copy_items_();
   void paste_items_();
+  void paste_items_tiled_();
   void grab_color_();
+  void replace_selected_color_();
   void notify_legend_of_item_addition_( const KnittingSymbolPtr symbol,
                                         QColor color, QString extraTag );
   void notify_legend_of_item_removal_( const KnittingSymbolPtr symbol,
@@ -198,6 +194,12 @@ private:
   QSize gridCellDimensions_;
   QFont textFont_;
 
+  /* the content of the pattern grid */
+  ChartModel chartModel_;
+
+  /* appearance shared by all cells */
+  CellStyle cellStyle_;
+
 
   /* holds the index of the currently selected column/row if any */
   int selectedCol_;
@@ -206,11 +208,18 @@ private:
   /* reference to settings */
   const QSettings& settings_;
 
-  /* list of currenly selected items */
-  QMap<int, PatternGridItem*> activeItems_;
+  /* currently selected cells */
+  ChartSelection selection_;
+  ChartSelectionItem* selectionItem_;
+  void toggle_cell_selection_( int col, int row );
+  void selection_changed_( int firstRow, int lastRow );
 
   /* currently copied selection */
   CopyObject copiedItems_;
+  bool fetch_copied_items_();
+
+  /* all knitting symbols we know about */
+  const SymbolCatalog& allSymbols_;
 
   /* pointers to current user selections (knitting symbol,
    * color, pen size ..) */
@@ -221,9 +230,31 @@ private:
 
   /* set up functions for canvas */
   void create_pattern_grid_();
-  void create_grid_labels_();
+  void update_grid_labels_();
   void create_pattern_key_();
 
+  /* marker rectangles currently on the canvas */
+  QList<PatternGridRectangle*> gridRectangles_;
+
+  /* point lookup for everything that isn't a chart cell
+   * (marker rectangles, legend items and labels). Mouse
+   * events only reach QGraphicsScene's BSP based handling
+   * if they hit one of these; for marker rectangles only
+   * their line counts */
+  FloatingItemIndex floatingItems_;
+  bool hoveringFloatingItem_;
+  bool wants_item_event_( const QPointF& pos ) const;
+
+  /* false while everything but the legend is hidden */
+  bool gridIsVisible_;
+
+  /* pooled grid labels; the label showing number n is
+   * at index n-1 */
+  QList<PatternGridLabel*> columnLabels_;
+  QList<PatternGridLabel*> rowLabels_;
+  void resize_label_pool_( QList<PatternGridLabel*>& pool, int count,
+                           int labelType );
+
   /* items related to the legend */
   bool legendIsVisible_;
   void shift_legend_items_vertically_( int pivot, int globalOffset,
@@ -248,12 +279,63 @@ private:
   QString get_symbol_description_( KnittingSymbolPtr aSymbol,
                                    QString aColorName );
 
-  /* reference count of knitting symbols currently in use */
-  QMap<QString, int> usedKnittingSymbols_;
-
-  /* use these to add/remove PatternGridItems to the scene */
-  void add_patternGridItem_( PatternGridItem* anItem );
-  void remove_patternGridItem_( PatternGridItem* anItem );
+  /* reference count of knitting symbols currently in use,
+   * indexed by interned legend key */
+  LegendKeyTable legendKeys_;
+  QVector<int> usedKnittingSymbols_;
+  void add_legend_reference_( int keyId, int count = 1 );
+  void remove_legend_reference_( int keyId, int count = 1 );
+  void create_legend_entry_( int keyId );
+  void remove_legend_entry_( int keyId );
+
+  /* undo/redo history. Edits triggered by the user are
+   * wrapped in begin_edit_/commit_edit_ and announce the cells
+   * they are about to change via journal_cells_ */
+  EditJournal journal_;
+  void begin_edit_( EditJournal::StepKind kind = EditJournal::Unmergeable );
+  void commit_edit_();
+  void journal_cells_( int row, int firstCol, int lastCol );
+  void journal_structure_( JournalOp::Type type, int index, int count );
+  JournalCells snapshot_cells_( int row, int col, int endCol );
+  int write_cells_( int row, int col, int endCol,
+                    const JournalCells& cells, int first = 0 );
+  void revert_journal_op_( const JournalOp& op );
+  void apply_journal_op_( const JournalOp& op );
+  void journal_changed_();
+
+  /* scene transactions; legend entries are only synced with
+   * the reference counts when the outermost one commits. Bulk
+   * transactions also suspend item indexing and repaints
+   * until then */
+  enum TransactionType { EDIT_TRANSACTION, BULK_TRANSACTION };
+  int transactionDepth_;
+  bool scenePaused_;
+  ItemIndexMethod pausedIndexMethod_;
+  QSet<int> pendingLegendKeys_;
+  void begin_transaction_( TransactionType type = EDIT_TRANSACTION );
+  void commit_transaction_();
+  void pause_scene_();
+  void resume_scene_();
+
+  /* large grids are drawn by a single ChartGridItem without
+   * any PatternGridItems */
+  bool virtualGrid_;
+  ChartGridItem* chartGrid_;
+  void setup_grid_view_();
+
+  /* use these to add/remove chart cells */
+  void place_cell_( int col, int row, int width,
+                    const KnittingSymbolPtr symbol,
+                    const QColor& color );
+  void remove_cell_( int col, int row );
+  void restyle_cell_( int col, int row, const KnittingSymbolPtr symbol,
+                      const QColor& color );
+  void clear_cells_( int col, int row, int width );
+  void paste_copied_items_( const QRect& target );
+  void reseat_moved_items_();
+
+  /* use this to create the PatternGridItem for a cell */
+  PatternGridItem* materialize_cell_( int col, int row );
 
   /* these functions take care of resetting the canvas */
   void reset_canvas_();
@@ -264,29 +346,27 @@ private:
   void try_place_knitting_symbol_();
   void change_selected_cells_colors_();
 
-  void colorize_highlighted_cells_();
   QPair<int, int> get_cell_coords_( const QPointF& mousePosition ) const;
   int compute_horizontal_label_shift_( int num, int fontSize ) const;
-  bool sort_active_items_row_wise_( QList<RowItems>& rows ) const;
   bool process_selected_items_( QList<RowLayout>& processedCellLayout,
-                                const QList<RowItems>& rowSelection,
                                 int targetPatternSize );
 
   void select_column_( int col );
   void select_row_( int row );
-  void insert_single_column_( int col );
-  void insert_single_row_( int row );
-  void expand_grid_( int colStart, int rowStart );
+  void insert_grid_rows_( int row, int count );
+  void insert_grid_columns_( int col, int count );
+  void delete_grid_rows_( int row, int count );
+  void delete_grid_columns_( int col, int count );
+  void update_grid_extent_();
+  QRectF grid_extent_() const;
+  QRectF legend_extent_() const;
 
   void enable_canvas_update_() { updateActiveItems_ = true; }
   void disable_canvas_update_() { updateActiveItems_ = false; }
   void update_active_items_();
+  QRect region_to_cells_( const QRectF& region ) const;
 
   QPoint compute_cell_origin_( int col, int row ) const;
-  int compute_cell_index_( PatternGridItem* anItem ) const;
-  QPair<int, int> compute_from_cell_index_( int index ) const;
-
-  PatternGridItem* patternGridItem_at_( int col, int row ) const;
 
   bool handle_click_on_marker_rectangle_(
     const QGraphicsSceneMouseEvent* mouseEvent );
@@ -297,9 +377,6 @@ private:
     const QGraphicsSceneMouseEvent* mouseEvent );
   bool handle_click_on_grid_labels_(
     const QGraphicsSceneMouseEvent* mouseEvent );
-
-  QPair<bool, int> is_row_contiguous_( const RowItems& items ) const;
-  QRect find_bounding_rectangle_( const QList<RowItems>& rows ) const;
 };
 
 
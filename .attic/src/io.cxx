@@ -22,6 +22,7 @@
 #include <cmath>
 
 /* Qt include */
+#include <QBitArray>
 #include <QDebug>
 #include <QColor>
 #include <QDir>
@@ -33,21 +34,23 @@
 #include <QPrinter>
 #include <QProcess>
 #include <QPrintDialog>
+#include <QProgressDialog>
 #include <QRegExp>
 #include <QSettings>
 #include <QString>
 #include <QStringList>
-#include <QTextStream>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 /* local includes */
 #include "config.h"
 #include "basicDefs.h"
+#include "chartModel.h"
 #include "graphicsScene.h"
 #include "helperFunctions.h"
 #include "io.h"
 #include "legendItem.h"
 #include "legendLabel.h"
-#include "patternGridItem.h"
 #include "settings.h"
 
 
@@ -63,6 +66,11 @@ const QString SCONCHO_ENV( "SCONCHO_SYMBOL_PATH" );
 /* name of file that holds the description of knitting
  *  * symbols */
 const QString KNITTING_SYMBOL_DESC( "description" );
+
+/* version of the project file format we write. Version 1
+ * files store one canvasItem per chart cell, version 2 files
+ * store each chart row as a run-length list */
+const int PROJECT_FILE_VERSION = 2;
 };
 
 
@@ -112,30 +120,6 @@ QList<ParsedSymbol> load_symbols_from_path( const QString& path )
 
 
 
-//---------------------------------------------------------------
-// given the list of all available knitting symbols and the
-// category+name of a symbol retrieve the proper
-// KnittingSymbolPtr. Returns true on success and false otherwise
-//---------------------------------------------------------------
-bool retrieve_knitting_symbol(
-  const QList<KnittingSymbolPtr>& allSymbols,
-  const QString& cat,
-  const QString& name,
-  KnittingSymbolPtr& symbolPtr )
-{
-  foreach( KnittingSymbolPtr aSym, allSymbols ) {
-    if (( aSym->category() == cat ) && ( aSym->patternName() == name ) ) {
-      symbolPtr = aSym;
-      return true;
-    }
-  }
-
-  return false;
-}
-
-
-
-
 //--------------------------------------------------------------
 // this function collects all paths where knitting pattern
 // symbols might be located
@@ -321,7 +305,9 @@ CanvasIOWriter::CanvasIOWriter( const GraphicsScene* scene,
     ourScene_( scene ),
     projectColors_( colors ),
     settings_( settings ),
-    fileName_( theName )
+    fileName_( theName ),
+    filePtr_( 0 ),
+    xmlWriter_( 0 )
 {
   status_ = SUCCESSFULLY_CONSTRUCTED;
 }
@@ -333,11 +319,10 @@ CanvasIOWriter::CanvasIOWriter( const GraphicsScene* scene,
 CanvasIOWriter::~CanvasIOWriter()
 {
   if ( filePtr_ != 0 ) {
+    delete xmlWriter_;
+
     filePtr_->close();
     delete filePtr_;
-
-    writeStream_->flush();
-    delete writeStream_;
   }
 }
 
@@ -359,7 +344,9 @@ bool CanvasIOWriter::Init()
     return false;
   }
 
-  writeStream_ = new QTextStream( filePtr_ );
+  xmlWriter_ = new QXmlStreamWriter( filePtr_ );
+  xmlWriter_->setAutoFormatting( true );
+  xmlWriter_->setAutoFormattingIndent( 4 );
 
   return true;
 }
@@ -372,25 +359,36 @@ bool CanvasIOWriter::Init()
 bool CanvasIOWriter::save()
 {
   /* add header */
-  QDomNode xmlNode = writeDoc_.createProcessingInstruction( "xml",
-                     "version=\"1.0\" encoding=\"UTF-8\"" );
-  writeDoc_.insertBefore( xmlNode, writeDoc_.firstChild() );
-  QDomElement root = writeDoc_.createElement( "sconcho" );
-  writeDoc_.appendChild( root );
-
-  /* add actual canvas items */
-  bool statusPatternGridItems = save_patternGridItems_( root );
-  bool statusLegendEntryPos   = save_legendInfo_( root );
-  bool statusColors           = save_colorInfo_( root );
-  bool statusCellDimensions   = save_gridCellDimensions_( root );
-  bool statusTextFont         = save_textFont_( root );
-
-  /* write it to stream */
-  writeDoc_.save( *writeStream_, 4 );
-
-  return ( statusPatternGridItems && statusLegendEntryPos
+  xmlWriter_->writeStartDocument();
+  xmlWriter_->writeStartElement( "sconcho" );
+  xmlWriter_->writeAttribute( "version",
+                              QString::number( PROJECT_FILE_VERSION ) );
+
+  /* add actual canvas items; the color and symbol tables have
+   * to come before the chart rows referring to them */
+  bool statusCellColors       = save_cellColors_();
+  bool statusSymbolTable      = save_symbolTable_();
+  bool statusChartRows        = save_chartRows_();
+  bool statusLegendEntryPos   = save_legendInfo_();
+  bool statusColors           = save_colorInfo_();
+  bool statusCellDimensions   = save_gridCellDimensions_();
+  bool statusTextFont         = save_textFont_();
+
+  xmlWriter_->writeEndElement();
+  xmlWriter_->writeEndDocument();
+
+  /* write errors only show up once the buffered data actually
+   * goes to disk */
+  bool statusFile = filePtr_->flush()
+                    && filePtr_->error() == QFile::NoError;
+#if QT_VERSION >= 0x040800
+  statusFile = statusFile && !xmlWriter_->hasError();
+#endif
+
+  return ( statusCellColors && statusSymbolTable && statusChartRows
+           && statusLegendEntryPos
            && statusColors && statusCellDimensions
-           && statusTextFont );
+           && statusTextFont && statusFile );
 }
 
 
@@ -402,68 +400,100 @@ bool CanvasIOWriter::save()
  **************************************************************/
 
 //-------------------------------------------------------------
-// save all PatternGridItems to our write stream
+// save the color table of the chart; cells refer to its
+// entries by index
 //-------------------------------------------------------------
-bool CanvasIOWriter::save_patternGridItems_( QDomElement& root )
+bool CanvasIOWriter::save_cellColors_()
 {
-  /* retrieve all patternGridItems from canvas */
-  QString helper;
-  QList<QGraphicsItem*> allItems( ourScene_->items() );
-  foreach( QGraphicsItem* anItem, allItems ) {
-    PatternGridItem* cell =
-      qgraphicsitem_cast<PatternGridItem*>( anItem );
-
-    if ( cell != 0 ) {
-      QDomElement mainTag = writeDoc_.createElement( "canvasItem" );
-      root.appendChild( mainTag );
-
-      QDomElement itemTag = writeDoc_.createElement( "patternGridItem" );
-      mainTag.appendChild( itemTag );
-
-      /* write column and row info */
-      QDomElement colTag = writeDoc_.createElement( "colIndex" );
-      itemTag.appendChild( colTag );
-      helper.setNum( cell->col() );
-      colTag.appendChild( writeDoc_.createTextNode( helper ) );
-
-      QDomElement rowTag = writeDoc_.createElement( "rowIndex" );
-      itemTag.appendChild( rowTag );
-      helper.setNum( cell->row() );
-      rowTag.appendChild( writeDoc_.createTextNode( helper ) );
-
-      /* cell width and height */
-      QDomElement widthTag = writeDoc_.createElement( "width" );
-      itemTag.appendChild( widthTag );
-      helper.setNum( cell->dim().width() );
-      widthTag.appendChild( writeDoc_.createTextNode( helper ) );
-
-      QDomElement heightTag = writeDoc_.createElement( "height" );
-      itemTag.appendChild( heightTag );
-      helper.setNum( cell->dim().height() );
-      heightTag.appendChild( writeDoc_.createTextNode( helper ) );
-
-      /* background color */
-      QDomElement colorTag = writeDoc_.createElement( "backgroundColor" );
-      itemTag.appendChild( colorTag );
-      helper.setNum( cell->color().rgb() );
-      colorTag.appendChild( writeDoc_.createTextNode( helper ) );
-
-      /* write knitting symbol related info */
-      KnittingSymbolPtr symbol = cell->get_knitting_symbol();
-
-      /* knitting symbol category */
-      QDomElement catTag = writeDoc_.createElement( "patternCategory" );
-      itemTag.appendChild( catTag );
-      catTag.appendChild(
-        writeDoc_.createTextNode( symbol->category() ) );
-
-      /* knitting symbol name */
-      QDomElement nameTag = writeDoc_.createElement( "patternName" );
-      itemTag.appendChild( nameTag );
-      nameTag.appendChild(
-        writeDoc_.createTextNode( symbol->patternName() ) );
+  xmlWriter_->writeStartElement( "cellColors" );
+  foreach( QRgb aColor, ourScene_->chart_model().palette() ) {
+    xmlWriter_->writeTextElement( "color", QString::number( aColor ) );
+  }
+  xmlWriter_->writeEndElement();
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// save the table of knitting symbols used by the chart. Chart
+// rows refer to its entries by index; each entry also records
+// the width of the chart cells showing the symbol.
+//-------------------------------------------------------------
+bool CanvasIOWriter::save_symbolTable_()
+{
+  symbolIds_.clear();
+
+  xmlWriter_->writeStartElement( "symbolTable" );
+  const ChartModel& chart = ourScene_->chart_model();
+  for ( int row = 0; row < chart.num_rows(); ++row ) {
+    int col = 0;
+    while ( col < chart.num_columns() ) {
+      int cellWidth = chart.width( col, row );
+      KnittingSymbolPtr symbol = chart.symbol( col, row );
+
+      SymbolKey key( symbol.get(), cellWidth );
+      if ( !symbolIds_.contains( key ) ) {
+        int newId = symbolIds_.size();
+        symbolIds_[key] = newId;
+
+        xmlWriter_->writeEmptyElement( "symbol" );
+        xmlWriter_->writeAttribute( "category", symbol->category() );
+        xmlWriter_->writeAttribute( "name", symbol->patternName() );
+        xmlWriter_->writeAttribute( "width", QString::number( cellWidth ) );
+      }
+
+      col += cellWidth;
     }
   }
+  xmlWriter_->writeEndElement();
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// save the chart one row at a time. Each row is a list of
+// runs "symbolId colorIndex width" where a run covers width
+// columns of identical chart cells. Rows go straight to the
+// file so memory use doesn't depend on the size of the chart.
+//-------------------------------------------------------------
+bool CanvasIOWriter::save_chartRows_()
+{
+  const ChartModel& chart = ourScene_->chart_model();
+  int numCols = chart.num_columns();
+
+  xmlWriter_->writeStartElement( "chart" );
+  xmlWriter_->writeAttribute( "columns", QString::number( numCols ) );
+  xmlWriter_->writeAttribute( "rows", QString::number( chart.num_rows() ) );
+
+  for ( int row = 0; row < chart.num_rows(); ++row ) {
+    QStringList runs;
+    int col = 0;
+    while ( col < numCols ) {
+      int cellWidth = chart.width( col, row );
+      int colorIndex = chart.color_index( col, row );
+      KnittingSymbolPtr symbol = chart.symbol( col, row );
+
+      /* extend the run as long as the cells look the same */
+      int runWidth = 0;
+      while ( col < numCols && chart.width( col, row ) == cellWidth
+              && chart.color_index( col, row ) == colorIndex
+              && chart.symbol( col, row ) == symbol ) {
+        runWidth += cellWidth;
+        col += cellWidth;
+      }
+
+      int symbolId = symbolIds_.value( SymbolKey( symbol.get(), cellWidth ) );
+      runs << QString( "%1 %2 %3" ).arg( symbolId ).arg( colorIndex )
+           .arg( runWidth );
+    }
+
+    xmlWriter_->writeTextElement( "row", runs.join( " " ) );
+  }
+  xmlWriter_->writeEndElement();
 
   return true;
 }
@@ -472,10 +502,9 @@ bool CanvasIOWriter::save_patternGridItems_( QDomElement& root )
 //-------------------------------------------------------------
 // save the positions of all items in the legend
 //-------------------------------------------------------------
-bool CanvasIOWriter::save_legendInfo_( QDomElement& root )
+bool CanvasIOWriter::save_legendInfo_()
 {
   /* retrieve all legend items from canvas */
-  QString helper;
   QMap<QString, LegendEntry> allEntries(
     ourScene_->get_legend_entries() );
 
@@ -487,44 +516,29 @@ bool CanvasIOWriter::save_legendInfo_( QDomElement& root )
     LegendItem* item  = iter.value().first;
     LegendLabel* label = iter.value().second;
 
-    QDomElement mainTag = writeDoc_.createElement( "canvasItem" );
-    root.appendChild( mainTag );
-
-    QDomElement itemTag = writeDoc_.createElement( "legendEntry" );
-    mainTag.appendChild( itemTag );
+    xmlWriter_->writeStartElement( "canvasItem" );
+    xmlWriter_->writeStartElement( "legendEntry" );
 
     /* write ID tag */
-    QDomElement idTag = writeDoc_.createElement( "IDTag" );
-    itemTag.appendChild( idTag );
-    idTag.appendChild( writeDoc_.createTextNode( labelID ) );
+    xmlWriter_->writeTextElement( "IDTag", labelID );
 
     /* write position of legend item */
-    QDomElement itemXPosTag = writeDoc_.createElement( "itemXPos" );
-    itemTag.appendChild( itemXPosTag );
-    helper.setNum( item->pos().x() );
-    itemXPosTag.appendChild( writeDoc_.createTextNode( helper ) );
-
-    QDomElement itemYPosTag = writeDoc_.createElement( "itemYPos" );
-    itemTag.appendChild( itemYPosTag );
-    helper.setNum( item->pos().y() );
-    itemYPosTag.appendChild( writeDoc_.createTextNode( helper ) );
+    xmlWriter_->writeTextElement( "itemXPos",
+                                  QString::number( item->pos().x() ) );
+    xmlWriter_->writeTextElement( "itemYPos",
+                                  QString::number( item->pos().y() ) );
 
     /* write position of legend label */
-    QDomElement labelXPosTag = writeDoc_.createElement( "labelXPos" );
-    itemTag.appendChild( labelXPosTag );
-    helper.setNum( label->pos().x() );
-    labelXPosTag.appendChild( writeDoc_.createTextNode( helper ) );
-
-    QDomElement labelYPosTag = writeDoc_.createElement( "labelYPos" );
-    itemTag.appendChild( labelYPosTag );
-    helper.setNum( label->pos().y() );
-    labelYPosTag.appendChild( writeDoc_.createTextNode( helper ) );
+    xmlWriter_->writeTextElement( "labelXPos",
+                                  QString::number( label->pos().x() ) );
+    xmlWriter_->writeTextElement( "labelYPos",
+                                  QString::number( label->pos().y() ) );
 
     /* write text of label */
-    QDomElement labelTextTag = writeDoc_.createElement( "labelText" );
-    itemTag.appendChild( labelTextTag );
-    labelTextTag.appendChild( writeDoc_.createTextNode(
-                                label->toPlainText() ) );
+    xmlWriter_->writeTextElement( "labelText", label->toPlainText() );
+
+    xmlWriter_->writeEndElement();
+    xmlWriter_->writeEndElement();
   }
 
   return true;
@@ -534,17 +548,13 @@ bool CanvasIOWriter::save_legendInfo_( QDomElement& root )
 //-------------------------------------------------------------
 // save the currently defined custom colors
 //-------------------------------------------------------------
-bool CanvasIOWriter::save_colorInfo_( QDomElement& root )
+bool CanvasIOWriter::save_colorInfo_()
 {
-  QDomElement mainTag = writeDoc_.createElement( "projectColors" );
-  root.appendChild( mainTag );
-
+  xmlWriter_->writeStartElement( "projectColors" );
   foreach( QColor aColor, projectColors_ ) {
-    /* write column and row info */
-    QDomElement colorTag = writeDoc_.createElement( "color" );
-    mainTag.appendChild( colorTag );
-    colorTag.appendChild( writeDoc_.createTextNode( aColor.name() ) );
+    xmlWriter_->writeTextElement( "color", aColor.name() );
   }
+  xmlWriter_->writeEndElement();
 
   return true;
 }
@@ -553,25 +563,16 @@ bool CanvasIOWriter::save_colorInfo_( QDomElement& root )
 //-------------------------------------------------------------
 // save the currently defined custom grid cell dimensions
 //-------------------------------------------------------------
-bool CanvasIOWriter::save_gridCellDimensions_( QDomElement& root )
+bool CanvasIOWriter::save_gridCellDimensions_()
 {
-  QDomElement mainTag = writeDoc_.createElement( "gridCellDimensions" );
-  root.appendChild( mainTag );
-
   QSize cellDimensions = extract_cell_dimensions_from_settings( settings_ );
 
-  // write width
-  QDomElement widthTag = writeDoc_.createElement( "width" );
-  mainTag.appendChild( widthTag );
-  QString helper;
-  helper.setNum( cellDimensions.width() );
-  widthTag.appendChild( writeDoc_.createTextNode( helper ) );
-
-  // write height
-  QDomElement heightTag = writeDoc_.createElement( "height" );
-  mainTag.appendChild( heightTag );
-  helper.setNum( cellDimensions.height() );
-  heightTag.appendChild( writeDoc_.createTextNode( helper ) );
+  xmlWriter_->writeStartElement( "gridCellDimensions" );
+  xmlWriter_->writeTextElement( "width",
+                                QString::number( cellDimensions.width() ) );
+  xmlWriter_->writeTextElement( "height",
+                                QString::number( cellDimensions.height() ) );
+  xmlWriter_->writeEndElement();
 
   return true;
 }
@@ -580,16 +581,13 @@ bool CanvasIOWriter::save_gridCellDimensions_( QDomElement& root )
 //-------------------------------------------------------------
 // save the currently defined custom grid cell dimensions
 //-------------------------------------------------------------
-bool CanvasIOWriter::save_textFont_( QDomElement& root )
+bool CanvasIOWriter::save_textFont_()
 {
-  QDomElement mainTag = writeDoc_.createElement( "textFont" );
-  root.appendChild( mainTag );
-
   QFont theFont = extract_font_from_settings( settings_ );
 
-  QDomElement fontTag = writeDoc_.createElement( "name" );
-  mainTag.appendChild( fontTag );
-  fontTag.appendChild( writeDoc_.createTextNode( theFont.toString() ) );
+  xmlWriter_->writeStartElement( "textFont" );
+  xmlWriter_->writeTextElement( "name", theFont.toString() );
+  xmlWriter_->writeEndElement();
 
   return true;
 }
@@ -615,12 +613,14 @@ bool CanvasIOWriter::save_textFont_( QDomElement& root )
 // constructor
 //-------------------------------------------------------------
 CanvasIOReader::CanvasIOReader( const QString& theName,
-                                const QList<KnittingSymbolPtr>& syms,
+                                const SymbolCatalog& syms,
                                 QSettings& settings )
     :
+    ProjectReader( syms, settings ),
     fileName_( theName ),
-    allSymbols_( syms ),
-    settings_( settings )
+    filePtr_( 0 ),
+    progress_( 0 ),
+    itemCount_( 0 )
 {
   status_ = SUCCESSFULLY_CONSTRUCTED;
 }
@@ -660,52 +660,110 @@ bool CanvasIOReader::Init()
 
 
 //--------------------------------------------------------------
-// read content of canvas;
-// returns true on success or false on failure
+// read content of canvas in a single pass over the file;
+// returns true on success or false on failure or if the user
+// canceled via the (optional) progress dialog. Settings
+// stored in the file are only applied once everything was
+// read successfully.
 //--------------------------------------------------------------
-bool CanvasIOReader::read()
+bool CanvasIOReader::read( QProgressDialog* progress )
 {
-  /* parse file and make sure we can read it */
-  QString errStr;
-  int errLine;
-  int errCol;
-  if ( !readDoc_.setContent( filePtr_, true, &errStr, &errLine, &errCol ) ) {
-    QMessageBox::critical( 0, "sconcho DOM Parser",
-                           QString( "Error parsing\n%1\nat line %2 column %3; %4" )
-                           .arg( fileName_ ) .arg( errLine ) .arg( errCol )
-                           .arg( errStr ) );
+  canceled_ = false;
+  itemCount_ = 0;
+  progress_ = progress;
+  if ( progress_ != 0 ) {
+    progress_->setRange( 0, filePtr_->size() );
+  }
+
+  QXmlStreamReader xml( filePtr_ );
 
+  /* make sure we're reading a sconcho file */
+  if ( !xml.readNextStartElement() || xml.name() != "sconcho" ) {
     return false;
   }
 
-  /* make sure we're reading a sconcho file */
-  QDomElement root = readDoc_.documentElement();
-  if ( root.tagName() != "sconcho" ) return false;
+  /* files without a version are version 1; refuse anything
+   * newer than what we know how to read */
+  int version = xml.attributes().value( "version" ).toString().toInt();
+  if ( version > PROJECT_FILE_VERSION ) {
+    QMessageBox::critical( 0, "sconcho XML Parser",
+                           QString( "File\n%1\nwas written by a newer "
+                                    "version of sconcho." ).arg( fileName_ ) );
+    return false;
+  }
 
-  /* parse all events */
+  /* parse all events; version 1 and 2 files only differ in
+   * how the chart cells are stored so we simply handle
+   * whichever we encounter */
   bool parseStatus = true;
-  QDomNode node = root.firstChild();
-  while ( !node.isNull() ) {
-    if ( node.toElement().tagName() == "canvasItem" ) {
-      QDomNode theItem = node.firstChild();
-      if ( theItem.toElement().tagName() == "patternGridItem" ) {
-        parseStatus &= parse_patternGridItems_( theItem );
-      } else if ( theItem.toElement().tagName() == "legendEntry" ) {
-        parseStatus &= parse_legendItems_( theItem );
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() == "canvasItem" ) {
+      while ( xml.readNextStartElement() ) {
+        if ( xml.name() == "patternGridItem" ) {
+          parseStatus &= parse_patternGridItems_( xml );
+        } else if ( xml.name() == "legendEntry" ) {
+          parseStatus &= parse_legendItems_( xml );
+        } else {
+          xml.skipCurrentElement();
+        }
+      }
+
+      if ( !advance_progress_( 1 ) ) {
+        return false;
+      }
+    } else if ( xml.name() == "cellColors" ) {
+      parseStatus &= parse_cellColors_( xml );
+    } else if ( xml.name() == "symbolTable" ) {
+      /* the chart rows can't be trusted without a sane table */
+      if ( !parse_symbolTable_( xml ) ) {
+        return false;
+      }
+    } else if ( xml.name() == "chart" ) {
+      if ( !parse_chartRows_( xml ) ) {
+        return false;
       }
-    } else if ( node.toElement().tagName() == "projectColors" ) {
-      parseStatus &= parse_projectColors_( node );
-    } else if ( node.toElement().tagName() == "gridCellDimensions" ) {
-      parseStatus &= parse_gridCellDimensions_( node );
-    } else if ( node.toElement().tagName() == "textFont" ) {
-      parseStatus &= parse_textFont_( node );
+    } else if ( xml.name() == "projectColors" ) {
+      parseStatus &= parse_projectColors_( xml );
+    } else if ( xml.name() == "gridCellDimensions" ) {
+      parseStatus &= parse_gridCellDimensions_( xml );
+    } else if ( xml.name() == "textFont" ) {
+      parseStatus &= parse_textFont_( xml );
+    } else {
+      xml.skipCurrentElement();
     }
+  }
 
+  if ( xml.hasError() ) {
+    QMessageBox::critical( 0, "sconcho XML Parser",
+                           QString( "Error parsing\n%1\nat line %2 column %3; %4" )
+                           .arg( fileName_ ) .arg( xml.lineNumber() )
+                           .arg( xml.columnNumber() ) .arg( xml.errorString() ) );
 
-    node = node.nextSibling();
+    return false;
+  }
+
+  if ( !parseStatus ) {
+    return false;
+  }
+
+  /* version 1 files describe their cells one item at a time */
+  if ( !gridItems_.isEmpty() && !fill_chart_from_items_() ) {
+    return false;
+  }
+
+  if ( chart_.num_rows() == 0 ) {
+    qDebug() << "ERROR: project file contains no chart";
+    return false;
+  }
+
+  /* only now is it safe to touch the settings */
+  apply_settings_( cellDimensions_, fontName_ );
+
+  if ( progress_ != 0 ) {
+    progress_->setValue( progress_->maximum() );
   }
 
-  return parseStatus;
+  return true;
 }
 
 
@@ -717,64 +775,226 @@ bool CanvasIOReader::read()
  **************************************************************/
 
 //-------------------------------------------------------------
-// read a single PatternGridItem from our input stream
+// read the color table referenced by pattern grid items
 //-------------------------------------------------------------
-bool CanvasIOReader::parse_patternGridItems_( const QDomNode& itemNode )
+bool CanvasIOReader::parse_cellColors_( QXmlStreamReader& xml )
 {
-  /* loop over all the properties we expect for the pattern */
-  int colIndex = 0;
-  int rowIndex = 0;
-  int width    = 0;
-  int height   = 0;
-  uint color   = 0;
-  QString category( "" );
-  QString name( "" );
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() == "color" ) {
+      cellColors_.push_back( QColor( xml.readElementText().toUInt() ) );
+    } else {
+      xml.skipCurrentElement();
+    }
+  }
 
-  QDomNode node = itemNode.firstChild();
-  while ( !node.isNull() ) {
+  return true;
+}
 
-    if ( node.toElement().tagName() == "colIndex" ) {
-      QDomNode childNode( node.firstChild() );
-      colIndex = childNode.toText().data().toInt();
+
+
+//-------------------------------------------------------------
+// read the symbol table referenced by the chart rows of
+// version 2 files
+//-------------------------------------------------------------
+bool CanvasIOReader::parse_symbolTable_( QXmlStreamReader& xml )
+{
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() == "symbol" ) {
+      QXmlStreamAttributes attributes = xml.attributes();
+      QString category = attributes.value( "category" ).toString();
+      QString name = attributes.value( "name" ).toString();
+      int width = attributes.value( "width" ).toString().toInt();
+
+      KnittingSymbolPtr symbolPtr;
+      if ( !allSymbols_.find( category, name, symbolPtr ) ) {
+        qDebug() << "ERROR: failed to load symbol" << name
+        << "in category" << category;
+        return false;
+      } else if ( width <= 0 ) {
+        qDebug() << "ERROR: invalid width" << width << "for symbol"
+        << name << "in category" << category;
+        return false;
+      }
+
+      tableSymbols_.push_back( symbolPtr );
+      tableWidths_.push_back( width );
     }
 
-    if ( node.toElement().tagName() == "rowIndex" ) {
-      QDomNode childNode( node.firstChild() );
-      rowIndex = childNode.toText().data().toInt();
+    xml.skipCurrentElement();
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// read the run-length encoded chart rows of version 2 files
+// and turn each run back into its individual chart cells
+//-------------------------------------------------------------
+bool CanvasIOReader::parse_chartRows_( QXmlStreamReader& xml )
+{
+  QXmlStreamAttributes attributes = xml.attributes();
+  int numCols = attributes.value( "columns" ).toString().toInt();
+  int numRows = attributes.value( "rows" ).toString().toInt();
+  /* every row takes up at least a few bytes of the file;
+   * this keeps a bogus header from making us allocate a huge
+   * chart before we even get to its rows */
+  if ( !ChartModel::valid_dimensions( numCols, numRows )
+       || numRows > filePtr_->size() ) {
+    qDebug() << "ERROR: invalid chart dimensions" << numCols << "x"
+    << numRows;
+    return false;
+  }
+
+  chart_.reset( numCols, numRows );
+  int row = 0;
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() != "row" ) {
+      xml.skipCurrentElement();
+      continue;
+    } else if ( row == numRows ) {
+      qDebug() << "ERROR: found more than" << numRows << "chart rows";
+      return false;
     }
 
-    if ( node.toElement().tagName() == "width" ) {
-      QDomNode childNode( node.firstChild() );
-      width = childNode.toText().data().toInt();
+    QStringList runs =
+      xml.readElementText().split( ' ', QString::SkipEmptyParts );
+    if ( runs.size() % 3 != 0 ) {
+      qDebug() << "ERROR: incomplete run in chart row" << row;
+      return false;
     }
 
-    if ( node.toElement().tagName() == "height" ) {
-      QDomNode childNode( node.firstChild() );
-      height = childNode.toText().data().toInt();
+    int col = 0;
+    for ( int index = 0; index < runs.size(); index += 3 ) {
+      int symbolId = runs.at( index ).toInt();
+      int colorIndex = runs.at( index + 1 ).toInt();
+      int runWidth = runs.at( index + 2 ).toInt();
+      if ( symbolId < 0 || symbolId >= tableSymbols_.size()
+           || colorIndex < 0 || colorIndex >= cellColors_.size() ) {
+        qDebug() << "ERROR: invalid symbol or color index in chart row"
+        << row;
+        return false;
+      }
+
+      int cellWidth = tableWidths_.at( symbolId );
+      if ( cellWidth <= 0 || runWidth <= 0 || runWidth % cellWidth != 0
+           || runWidth > numCols - col ) {
+        qDebug() << "ERROR: invalid run width" << runWidth
+        << "in chart row" << row;
+        return false;
+      }
+
+      for ( int last = col + runWidth; col < last; col += cellWidth ) {
+        chart_.set_cell( col, row, cellWidth, tableSymbols_.at( symbolId ),
+                         cellColors_.at( colorIndex ) );
+      }
     }
 
-    if ( node.toElement().tagName() == "backgroundColor" ) {
-      QDomNode childNode( node.firstChild() );
-      color = childNode.toText().data().toUInt();
+    if ( col != numCols ) {
+      qDebug() << "ERROR: chart row" << row << "covers" << col
+      << "instead of" << numCols << "columns";
+      return false;
     }
 
-    if ( node.toElement().tagName() == "patternCategory" ) {
-      QDomNode childNode( node.firstChild() );
-      category = childNode.toText().data();
+    if ( !advance_progress_( numCols ) ) {
+      return false;
     }
 
-    if ( node.toElement().tagName() == "patternName" ) {
-      QDomNode childNode( node.firstChild() );
-      name = childNode.toText().data();
+    ++row;
+  }
+
+  if ( row != numRows ) {
+    qDebug() << "ERROR: found" << row << "chart rows instead of" << numRows;
+    return false;
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// account for numItems freshly read items and keep the
+// progress dialog (if any) up to date. Returns false if the
+// user canceled.
+//-------------------------------------------------------------
+bool CanvasIOReader::advance_progress_( int numItems )
+{
+  if ( progress_ == 0 ) {
+    return true;
+  }
+
+  int previousBlock = itemCount_ / READ_PROGRESS_INTERVAL;
+  itemCount_ += numItems;
+  if ( itemCount_ / READ_PROGRESS_INTERVAL == previousBlock ) {
+    return true;
+  }
+
+  progress_->setValue( filePtr_->pos() );
+  if ( progress_->wasCanceled() ) {
+    canceled_ = true;
+    return false;
+  }
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// read a single PatternGridItem from our input stream. Older
+// files store the full backgroundColor with each item, newer
+// ones a colorIndex into the cell color table.
+//-------------------------------------------------------------
+bool CanvasIOReader::parse_patternGridItems_( QXmlStreamReader& xml )
+{
+  /* loop over all the properties we expect for the pattern */
+  int colIndex = 0;
+  int rowIndex = 0;
+  int width    = 0;
+  int height   = 0;
+  uint color   = 0;
+  int colorIndex = -1;
+  QString category( "" );
+  QString name( "" );
+
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() == "colIndex" ) {
+      colIndex = xml.readElementText().toInt();
+    } else if ( xml.name() == "rowIndex" ) {
+      rowIndex = xml.readElementText().toInt();
+    } else if ( xml.name() == "width" ) {
+      width = xml.readElementText().toInt();
+    } else if ( xml.name() == "height" ) {
+      height = xml.readElementText().toInt();
+    } else if ( xml.name() == "backgroundColor" ) {
+      color = xml.readElementText().toUInt();
+    } else if ( xml.name() == "colorIndex" ) {
+      colorIndex = xml.readElementText().toInt();
+    } else if ( xml.name() == "patternCategory" ) {
+      category = xml.readElementText();
+    } else if ( xml.name() == "patternName" ) {
+      name = xml.readElementText();
+    } else {
+      xml.skipCurrentElement();
     }
+  }
 
-    node = node.nextSibling();
+  QColor backgroundColor( color );
+  if ( colorIndex >= 0 ) {
+    if ( colorIndex >= cellColors_.size() ) {
+      qDebug() << "ERROR: invalid color index" << colorIndex;
+      qDebug() << "       at grid element (" << colIndex << ","
+      << rowIndex << ")";
+      return false;
+    }
+    backgroundColor = cellColors_.at( colorIndex );
   }
 
   /* find proper knitting symbol */
   KnittingSymbolPtr symbolPtr;
-  bool status =
-    retrieve_knitting_symbol( allSymbols_, category, name, symbolPtr );
+  bool status = allSymbols_.find( category, name, symbolPtr );
   if ( !status ) {
     qDebug() << "ERROR: failed to load symbol" << name
     << "in category" << category;
@@ -788,9 +1008,67 @@ bool CanvasIOReader::parse_patternGridItems_( const QDomNode& itemNode )
   currentItem( new PatternGridItemDescriptor );
   currentItem->location = QPoint( colIndex, rowIndex );
   currentItem->dimension = QSize( width, height );
-  currentItem->backgroundColor = QColor( color );
+  currentItem->backgroundColor = backgroundColor;
   currentItem->patternSymbolPtr = symbolPtr;
-  newPatternGridItems_.push_back( currentItem );
+  gridItems_.push_back( currentItem );
+
+  return true;
+}
+
+
+
+//-------------------------------------------------------------
+// turn the pattern grid items of a version 1 file into chart
+// cells. The chart dimensions follow from the items and each
+// unit cell has to be covered by at most one of them. Items
+// are bound-checked one by one so none of the sums below can
+// overflow before we check the size of the whole chart.
+//-------------------------------------------------------------
+bool CanvasIOReader::fill_chart_from_items_()
+{
+  int numCols = 0;
+  int numRows = 0;
+  foreach( PatternGridItemDescriptorPtr rawItem, gridItems_ ) {
+    if ( rawItem->location.x() < 0 || rawItem->location.y() < 0
+         || rawItem->location.y() >= MAX_CHART_CELLS
+         || rawItem->dimension.width() <= 0
+         || rawItem->dimension.width() >
+            MAX_CHART_CELLS - rawItem->location.x() ) {
+      qDebug() << "ERROR: invalid grid element at ("
+      << rawItem->location.x() << "," << rawItem->location.y() << ")";
+      return false;
+    }
+
+    numCols = qMax( rawItem->location.x() + rawItem->dimension.width(),
+                    numCols );
+    numRows = qMax( rawItem->location.y() + 1, numRows );
+  }
+
+  if ( !ChartModel::valid_dimensions( numCols, numRows ) ) {
+    qDebug() << "ERROR: invalid chart dimensions" << numCols << "x"
+    << numRows;
+    return false;
+  }
+
+  chart_.reset( numCols, numRows );
+  QBitArray covered( numCols * numRows );
+  foreach( PatternGridItemDescriptorPtr rawItem, gridItems_ ) {
+    int col = rawItem->location.x();
+    int row = rawItem->location.y();
+    int width = rawItem->dimension.width();
+    for ( int index = row * numCols + col;
+          index < row * numCols + col + width; ++index ) {
+      if ( covered.testBit( index ) ) {
+        qDebug() << "ERROR: overlapping grid elements at (" << col
+        << "," << row << ")";
+        return false;
+      }
+      covered.setBit( index );
+    }
+
+    chart_.set_cell( col, row, width, rawItem->patternSymbolPtr,
+                     rawItem->backgroundColor );
+  }
 
   return true;
 }
@@ -799,7 +1077,7 @@ bool CanvasIOReader::parse_patternGridItems_( const QDomNode& itemNode )
 //-------------------------------------------------------------
 // read a single legend entry from our input stream
 //-------------------------------------------------------------
-bool CanvasIOReader::parse_legendItems_( const QDomNode& itemNode )
+bool CanvasIOReader::parse_legendItems_( QXmlStreamReader& xml )
 {
   /* loop over all the properties we expect for the pattern */
   QString entryID( "" );
@@ -809,50 +1087,26 @@ bool CanvasIOReader::parse_legendItems_( const QDomNode& itemNode )
   double labelYPos = 0.0;
   QString labelText( "" );
 
-  QDomNode node = itemNode.firstChild();
-  while ( !node.isNull() ) {
-    if ( node.toElement().tagName() == "IDTag" ) {
-      QDomNode childNode( node.firstChild() );
-      entryID = childNode.toText().data();
-    }
-
-    if ( node.toElement().tagName() == "itemXPos" ) {
-      QDomNode childNode( node.firstChild() );
-      itemXPos = childNode.toText().data().toDouble();
-    }
-
-    if ( node.toElement().tagName() == "itemYPos" ) {
-      QDomNode childNode( node.firstChild() );
-      itemYPos = childNode.toText().data().toDouble();
-    }
-
-    if ( node.toElement().tagName() == "labelXPos" ) {
-      QDomNode childNode( node.firstChild() );
-      labelXPos = childNode.toText().data().toDouble();
-    }
-
-    if ( node.toElement().tagName() == "labelYPos" ) {
-      QDomNode childNode( node.firstChild() );
-      labelYPos = childNode.toText().data().toDouble();
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() == "IDTag" ) {
+      entryID = xml.readElementText();
+    } else if ( xml.name() == "itemXPos" ) {
+      itemXPos = xml.readElementText().toDouble();
+    } else if ( xml.name() == "itemYPos" ) {
+      itemYPos = xml.readElementText().toDouble();
+    } else if ( xml.name() == "labelXPos" ) {
+      labelXPos = xml.readElementText().toDouble();
+    } else if ( xml.name() == "labelYPos" ) {
+      labelYPos = xml.readElementText().toDouble();
+    } else if ( xml.name() == "labelText" ) {
+      labelText = xml.readElementText();
+    } else {
+      xml.skipCurrentElement();
     }
-
-    if ( node.toElement().tagName() == "labelText" ) {
-      QDomNode childNode( node.firstChild() );
-      labelText = childNode.toText().data();
-    }
-
-    node = node.nextSibling();
   }
 
-  /* if the legend entry is a widgetItem we also have to retrieve
-   * the correct KnittingSymbolPtr */
-  if ( is_extraLegendItem( entryID ) ) {
-    add_to_extraLegendItems_( entryID, itemXPos, itemYPos, labelXPos,
-                              labelYPos, labelText );
-  } else {
-    add_to_chartLegendItems_( entryID, itemXPos, itemYPos, labelXPos,
-                              labelYPos, labelText );
-  }
+  add_legend_entry_( entryID, itemXPos, itemYPos, labelXPos, labelYPos,
+                     labelText );
 
   return true;
 }
@@ -861,16 +1115,14 @@ bool CanvasIOReader::parse_legendItems_( const QDomNode& itemNode )
 //-------------------------------------------------------------
 // read the list of project colors (if present)
 //-------------------------------------------------------------
-bool CanvasIOReader::parse_projectColors_( const QDomNode& itemNode )
+bool CanvasIOReader::parse_projectColors_( QXmlStreamReader& xml )
 {
-  QDomNode node = itemNode.firstChild();
-  while ( !node.isNull() ) {
-    if ( node.toElement().tagName() == "color" ) {
-      QDomNode childNode( node.firstChild() );
-      projectColors_.push_back( QColor( childNode.toText().data() ) );
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() == "color" ) {
+      projectColors_.push_back( QColor( xml.readElementText() ) );
+    } else {
+      xml.skipCurrentElement();
     }
-
-    node = node.nextSibling();
   }
 
   return true;
@@ -881,32 +1133,28 @@ bool CanvasIOReader::parse_projectColors_( const QDomNode& itemNode )
 //-------------------------------------------------------------
 // read the list of dimensions of the grid cells (if present)
 //-------------------------------------------------------------
-bool CanvasIOReader::parse_gridCellDimensions_(
-  const QDomNode& itemNode )
+bool CanvasIOReader::parse_gridCellDimensions_( QXmlStreamReader& xml )
 {
   int width    = 0;
   int height   = 0;
   int allFound = 0;
 
-  QDomNode node = itemNode.firstChild();
-  while ( !node.isNull() ) {
-    if ( node.toElement().tagName() == "width" ) {
-      QDomNode childNode( node.firstChild() );
-      width = childNode.toText().data().toInt();
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() == "width" ) {
+      width = xml.readElementText().toInt();
       allFound++;
-    } else if ( node.toElement().tagName() == "height" ) {
-      QDomNode childNode( node.firstChild() );
-      height = childNode.toText().data().toInt();
+    } else if ( xml.name() == "height" ) {
+      height = xml.readElementText().toInt();
       allFound++;
+    } else {
+      xml.skipCurrentElement();
     }
-
-    node = node.nextSibling();
   }
 
   /* only adjust dimensions if we found one width and
-   * height */
+   * height; they are applied once reading succeeded */
   if ( allFound == 2 ) {
-    set_cell_dimensions( settings_, QSize( width, height ) );
+    cellDimensions_ = QSize( width, height );
   }
 
   return true;
@@ -915,18 +1163,16 @@ bool CanvasIOReader::parse_gridCellDimensions_(
 
 
 //-------------------------------------------------------------
-// read the list of dimensions of the grid cells (if present)
+// read the name of the text font (if present)
 //-------------------------------------------------------------
-bool CanvasIOReader::parse_textFont_( const QDomNode& itemNode )
+bool CanvasIOReader::parse_textFont_( QXmlStreamReader& xml )
 {
-  QDomNode node = itemNode.firstChild();
-  while ( !node.isNull() ) {
-    if ( node.toElement().tagName() == "name" ) {
-      QDomNode childNode( node.firstChild() );
-      set_font_string( settings_, childNode.toText().data() );
+  while ( xml.readNextStartElement() ) {
+    if ( xml.name() == "name" ) {
+      fontName_ = xml.readElementText();
+    } else {
+      xml.skipCurrentElement();
     }
-
-    node = node.nextSibling();
   }
 
   return true;
@@ -934,55 +1180,6 @@ bool CanvasIOReader::parse_textFont_( const QDomNode& itemNode )
 
 
 
-//----------------------------------------------------------------
-// add a just parsed chartLegendItem
-//----------------------------------------------------------------
-void CanvasIOReader::add_to_chartLegendItems_( const QString& anID,
-    double anItemXPos, double anItemYPos, double aLabelXPos,
-    double aLabelYPos, const QString& aLabelText )
-{
-  LegendEntryDescriptorPtr currentEntry( new LegendEntryDescriptor );
-  currentEntry->entryID = anID;
-  currentEntry->itemLocation = QPointF( anItemXPos, anItemYPos );
-  currentEntry->labelLocation = QPointF( aLabelXPos, aLabelYPos );
-  currentEntry->labelText = aLabelText;
-  currentEntry->patternSymbolPtr.reset();
-  newLegendEntryDescriptors_.push_back( currentEntry );
-}
-
-
-
-//----------------------------------------------------------------
-// add a just parsed extraLegendItem
-// NOTE: For these we also need to provide a KnittingSymbolPtr
-// because the chart won't do it for us like for chartLegendItem
-//----------------------------------------------------------------
-void CanvasIOReader::add_to_extraLegendItems_( const QString& anID,
-    double anItemXPos, double anItemYPos, double aLabelXPos,
-    double aLabelYPos, const QString& aLabelText )
-{
-  QString name = get_legend_item_name( anID );
-  QString category = get_legend_item_category( anID );
-
-  /* find proper knitting symbol */
-  KnittingSymbolPtr symbolPtr;
-  bool status =
-    retrieve_knitting_symbol( allSymbols_, category, name, symbolPtr );
-  if ( !status ) {
-    qDebug() << "ERROR: failed to load symbol" << category << ":" << name;
-  }
-
-  LegendEntryDescriptorPtr currentEntry( new LegendEntryDescriptor );
-  currentEntry->entryID = anID;
-  currentEntry->itemLocation = QPointF( anItemXPos, anItemYPos );
-  currentEntry->labelLocation = QPointF( aLabelXPos, aLabelYPos );
-  currentEntry->labelText = aLabelText;
-  currentEntry->patternSymbolPtr = symbolPtr;
-  newExtraLegendItemDescriptors_.push_back( currentEntry );
-}
-
-
-
 //---------------------------------------------------------------
 //
 //
@@ -26,7 +26,12 @@
 #include <boost/shared_ptr.hpp>
 
 /* QT includes */
+#include <QColor>
+#include <QHash>
 #include <QList>
+#include <QPair>
+#include <QPoint>
+#include <QSize>
 #include <QString>
 #include <QStringList>
 #include <QtXml/QDomDocument>
@@ -36,6 +41,8 @@
 
 /* local includes */
 #include "knittingSymbol.h"
+#include "projectFormat.h"
+#include "symbolCatalog.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -46,8 +53,10 @@ class GraphicsScene;
 class PatternGridItem;
 class QColor;
 class QFile;
+class QProgressDialog;
 class QSettings;
-class QTextStream;
+class QXmlStreamReader;
+class QXmlStreamWriter;
 
 
 /* convenience typedefs */
@@ -88,19 +97,6 @@ QString get_pattern_path( const QString& name );
 
 
 
-//---------------------------------------------------------------
-// given the list of all available knitting symbols and the
-// category+name of a symbol retrieve the proper
-// KnittingSymbolPtr. Returns true on success and false otherwise
-//---------------------------------------------------------------
-bool retrieve_knitting_symbol(
-  const QList<KnittingSymbolPtr>& allSymbols,
-  const QString& category,
-  const QString& name,
-  KnittingSymbolPtr& symbolPtr );
-
-
-
 //---------------------------------------------------------------
 // looks for a particular environmental variable in a StringList
 // of the full environment and returns its value as a QString
@@ -142,7 +138,7 @@ void print_scene( GraphicsScene* theScene );
  ******************************************************************/
 class CanvasIOWriter
     :
-    public boost::noncopyable
+    public ProjectWriter
 {
 
 public:
@@ -169,15 +165,22 @@ private:
   const QSettings& settings_;
   QString fileName_;
   QFile* filePtr_;
-  QTextStream* writeStream_;
-  QDomDocument writeDoc_;
-
-  /* helper functions */
-  bool save_patternGridItems_( QDomElement& rootElement );
-  bool save_legendInfo_( QDomElement& rootElement );
-  bool save_colorInfo_( QDomElement& rootElement );
-  bool save_gridCellDimensions_( QDomElement& rootElement );
-  bool save_textFont_( QDomElement& rootElement );
+  QXmlStreamWriter* xmlWriter_;
+
+  /* ids of the (symbol, cell width) pairs in the symbol
+   * table written ahead of the chart rows */
+  typedef QPair<const KnittingSymbol*, int> SymbolKey;
+  QHash<SymbolKey, int> symbolIds_;
+
+  /* helper functions; each writes its part of the project
+   * straight to the file */
+  bool save_cellColors_();
+  bool save_symbolTable_();
+  bool save_chartRows_();
+  bool save_legendInfo_();
+  bool save_colorInfo_();
+  bool save_gridCellDimensions_();
+  bool save_textFont_();
 };
 
 
@@ -185,8 +188,8 @@ private:
 /*******************************************************************
  *
  * PatternGridItemDescriptor is a data structure that contains
- * all the information allowing GraphicsScene to reconstruct
- * a previous view loaded from a file
+ * all the information allowing CanvasIOReader to reconstruct
+ * the chart cells of version 1 files
  *
  ******************************************************************/
 struct PatternGridItemDescriptor {
@@ -200,27 +203,6 @@ typedef boost::shared_ptr<PatternGridItemDescriptor>
 PatternGridItemDescriptorPtr;
 
 
-/*******************************************************************
- *
- * LegendEntryDescriptor is a data structure that contains
- * all the information allowing GraphicsScene to reconstruct
- * the position and text of legend items derived both from the
- * chart as well as extra items
- *
- ******************************************************************/
-struct LegendEntryDescriptor {
-  QString entryID;
-  QPointF itemLocation;
-  QPointF labelLocation;
-  QString labelText;
-  KnittingSymbolPtr patternSymbolPtr;
-};
-
-typedef boost::shared_ptr<LegendEntryDescriptor>
-LegendEntryDescriptorPtr;
-
-
-
 /*******************************************************************
  *
  * CanvasIOReader is responsible for reading a previously stored
@@ -229,37 +211,19 @@ LegendEntryDescriptorPtr;
  ******************************************************************/
 class CanvasIOReader
     :
-    public boost::noncopyable
+    public ProjectReader
 {
 
 public:
 
   explicit CanvasIOReader( const QString& fileName,
-                           const QList<KnittingSymbolPtr>& allSymbols,
+                           const SymbolCatalog& allSymbols,
                            QSettings& settings_ );
   ~CanvasIOReader();
   bool Init();
 
   /* read content of canvas */
-  bool read();
-
-  /* accessors for parsed information */
-  const QList<PatternGridItemDescriptorPtr>& get_pattern_items() const {
-    return newPatternGridItems_;
-  }
-
-  const QList<LegendEntryDescriptorPtr>& get_legend_items() const {
-    return newLegendEntryDescriptors_;
-  }
-
-  const QList<LegendEntryDescriptorPtr>& get_extra_legend_items() const {
-    return newExtraLegendItemDescriptors_;
-  }
-
-  const QList<QColor>& get_project_colors() const {
-    return projectColors_;
-  }
-
+  bool read( QProgressDialog* progress = 0 );
 
 
 private:
@@ -269,35 +233,40 @@ private:
 
   /* variables */
   QString fileName_;
-  const QList<KnittingSymbolPtr>& allSymbols_;
-  QSettings& settings_;
   QFile* filePtr_;
-  QDomDocument readDoc_;
+  QProgressDialog* progress_;
+  int itemCount_;
 
-  /* QList of parsed patternGridItems based on input file */
-  QList<PatternGridItemDescriptorPtr> newPatternGridItems_;
+  /* settings found in the file; these are only applied
+   * after the whole file was read successfully */
+  QSize cellDimensions_;
+  QString fontName_;
 
-  /* QList of parsed legend descriptors coming from the chart */
-  QList<LegendEntryDescriptorPtr> newLegendEntryDescriptors_;
+  /* color table referenced by the colorIndex of pattern
+   * grid items */
+  QList<QColor> cellColors_;
 
-  /* QList of extra parsed legend descriptors */
-  QList<LegendEntryDescriptorPtr> newExtraLegendItemDescriptors_;
+  /* symbol table and matching cell widths referenced by
+   * the chart rows of version 2 files */
+  QList<KnittingSymbolPtr> tableSymbols_;
+  QList<int> tableWidths_;
 
-  /* QList of selector colors */
-  QList<QColor> projectColors_;
+  /* pattern grid items of version 1 files; these come in no
+   * particular order and are only turned into chart cells
+   * once all of them are known */
+  QList<PatternGridItemDescriptorPtr> gridItems_;
 
   /* helper functions */
-  bool parse_patternGridItems_( const QDomNode& itemNode );
-  bool parse_legendItems_( const QDomNode& itemNode );
-  bool parse_projectColors_( const QDomNode& itemNode );
-  bool parse_gridCellDimensions_( const QDomNode& itemNode );
-  bool parse_textFont_( const QDomNode& itemNode );
-  void add_to_extraLegendItems_( const QString& entryID, double itemXPos,
-                                 double itemYPos, double labelXPos, double labelYPos,
-                                 const QString& labelText );
-  void add_to_chartLegendItems_( const QString& entryID, double itemXPos,
-                                 double itemYPos, double labelXPos, double labelYPos,
-                                 const QString& labelText );
+  bool parse_cellColors_( QXmlStreamReader& xml );
+  bool parse_symbolTable_( QXmlStreamReader& xml );
+  bool parse_chartRows_( QXmlStreamReader& xml );
+  bool advance_progress_( int numItems );
+  bool parse_patternGridItems_( QXmlStreamReader& xml );
+  bool fill_chart_from_items_();
+  bool parse_legendItems_( QXmlStreamReader& xml );
+  bool parse_projectColors_( QXmlStreamReader& xml );
+  bool parse_gridCellDimensions_( QXmlStreamReader& xml );
+  bool parse_textFont_( QXmlStreamReader& xml );
 };
 
 
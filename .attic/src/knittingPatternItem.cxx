@@ -18,17 +18,14 @@
 *
 ****************************************************************/
 
-/* C++ headers */
-#include <float.h>
-
 /* Qt headers */
 #include <QColor>
 #include <QDebug>
-#include <QGraphicsSvgItem>
 #include <QPainter>
 
 /* local headers */
 #include "knittingPatternItem.h"
+#include "symbolPixmapCache.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -43,17 +40,12 @@ QT_BEGIN_NAMESPACE
 // constructor
 //-------------------------------------------------------------
 KnittingPatternItem::KnittingPatternItem( const QSize& aDim,
-    const QSize& aspectRatio, const QColor& aBackColor,
-    const QPoint& aLoc )
+    const CellStyle& aStyle )
     :
     QGraphicsItem(),
-    svgItem_( 0 ),
     knittingSymbol_( emptyKnittingSymbol ),
-    backColor_( aBackColor ),
-    highlightColor_( QColor( Qt::gray ) ),
-    dim_( aDim ),
-    loc_( aLoc ),
-    cellAspectRatio_( aspectRatio )
+    style_( aStyle ),
+    dim_( aDim )
 {
   status_ = SUCCESSFULLY_CONSTRUCTED;
 }
@@ -68,12 +60,6 @@ bool KnittingPatternItem::Init()
     return false;
   }
 
-  /* set up some properties */
-  setFlags( QGraphicsItem::ItemClipsChildrenToShape );
-
-  /* call individual initialization routines */
-  set_up_pens_brushes_();
-
   return true;
 }
 
@@ -106,10 +92,11 @@ int KnittingPatternItem::type() const
 //------------------------------------------------------------
 QRectF KnittingPatternItem::boundingRect() const
 {
-  return QRectF( loc_.x() - pen_.width() * 0.25,
-                 loc_.y() - pen_.width() * 0.25,
-                 cellAspectRatio_.width() * dim_.width() + pen_.width() * 0.5,
-                 cellAspectRatio_.height() * dim_.height() + pen_.width() * 0.5 );
+  const QSize& cellSize = style_.cell_size();
+  qreal penWidth = style_.pen().widthF();
+  return QRectF( -penWidth * 0.25, -penWidth * 0.25,
+                 cellSize.width() * dim_.width() + penWidth * 0.5,
+                 cellSize.height() * dim_.height() + penWidth * 0.5 );
 }
 
 
@@ -125,13 +112,17 @@ void KnittingPatternItem::paint( QPainter *painter,
   Q_UNUSED( widget );
   Q_UNUSED( option );
 
-  painter->setPen( pen_ );
-  QBrush aBrush( currentColor_ );
-  painter->setBrush( aBrush );
+  const QSize& cellSize = style_.cell_size();
+  QRectF frame( 0, 0, cellSize.width() * dim_.width(),
+                cellSize.height() * dim_.height() );
+
+  /* background and symbol come from the pixmap cache */
+  SymbolPixmapCache::instance().draw( painter, knittingSymbol_, frame,
+                                      color() );
 
-  painter->drawRect( QRectF( loc_,
-                             QSize( cellAspectRatio_.width() * dim_.width(),
-                                    cellAspectRatio_.height() * dim_.height() ) ) );
+  painter->setPen( style_.pen() );
+  painter->setBrush( Qt::NoBrush );
+  painter->drawRect( frame );
 }
 
 
@@ -142,27 +133,10 @@ void KnittingPatternItem::paint( QPainter *painter,
 void KnittingPatternItem::insert_knitting_symbol(
   KnittingSymbolPtr aSymbol )
 {
-  /* update pointers */
+  /* update pointers; a background color the symbol provides
+   * is already part of our color() */
   knittingSymbol_ = aSymbol;
-  QString symbolPath( aSymbol->path() );
-
-  /* delete the previous svgItem if there was one */
-  if ( svgItem_ != 0 ) {
-    delete svgItem_;
-    svgItem_ = 0;
-  }
-
-  if ( symbolPath != "" ) {
-    svgItem_ = new QGraphicsSvgItem( symbolPath, this );
-    fit_svg_();
-  }
-
-  /* if the knitting symbol provides a backgroundColor we use
-   * it */
-  if ( knittingSymbol_->color_name() != "" ) {
-    set_background_color( knittingSymbol_->color_name() );
-    set_up_pens_brushes_();
-  }
+  update();
 }
 
 
@@ -178,16 +152,6 @@ const
 
 
 
-//-------------------------------------------------------------
-// change the background color
-//-------------------------------------------------------------
-void KnittingPatternItem::set_background_color( const QColor& newColor )
-{
-  backColor_ = newColor;
-}
-
-
-
 /**************************************************************
  *
  * PROTECTED MEMBER FUNCTIONS
@@ -195,31 +159,14 @@ void KnittingPatternItem::set_background_color( const QColor& newColor )
  *************************************************************/
 
 //---------------------------------------------------------------
-// scale and shift svg item so it fits into our bounding
-// box
+// the symbol is painted to fill our frame so all we need to do
+// after a change of the cell dimensions is let the scene know
+// that our geometry changed
 //---------------------------------------------------------------
-void KnittingPatternItem::fit_svg_()
+void KnittingPatternItem::fit_geometry_()
 {
-  if ( svgItem_ == 0 ) {
-    return;
-  }
-
-  /* get bounding boxes */
-  QRectF svgRect = svgItem_->sceneBoundingRect();
-  QRectF boxRect = sceneBoundingRect();
-
-  /* scale */
-  double scaleX = 1.0;
-  if ( svgRect.width() > DBL_EPSILON ) {
-    scaleX = boxRect.width() / svgRect.width();
-  }
-
-  double scaleY = 1.0;
-  if ( svgRect.height() > DBL_EPSILON ) {
-    scaleY = boxRect.height() / svgRect.height();
-  }
-
-  svgItem_->scale( scaleX, scaleY );
+  prepareGeometryChange();
+  update();
 }
 
 
@@ -237,18 +184,4 @@ void KnittingPatternItem::fit_svg_()
  *
  *************************************************************/
 
-//-------------------------------------------------------------
-// set up all the pens we use for drawing
-//-------------------------------------------------------------
-void KnittingPatternItem::set_up_pens_brushes_()
-{
-  /* pen used */
-  pen_.setWidthF( 1.0 );
-  pen_.setColor( Qt::black );
-
-  currentColor_ = backColor_;
-}
-
-
-
 QT_END_NAMESPACE
@@ -27,11 +27,11 @@
 /* QT includes */
 #include <QColor>
 #include <QGraphicsItem>
-#include <QPen>
 
 
 /* local includes */
 #include "basicDefs.h"
+#include "cellStyle.h"
 #include "knittingSymbol.h"
 
 
@@ -41,7 +41,6 @@ QT_BEGIN_NAMESPACE
 /* a few forward declarations */
 class GraphicsScene;
 class QGraphicsSceneMouseEvent;
-class QGraphicsSvgItem;
 class QPainter;
 class QStyleOptionGraphicsItem;
 
@@ -54,17 +53,13 @@ class QStyleOptionGraphicsItem;
  ***************************************************************/
 class KnittingPatternItem
     :
-    public QObject,
     public QGraphicsItem,
     public boost::noncopyable
 {
 
 public:
 
-  explicit KnittingPatternItem( const QSize& aDim,
-                                const QSize& aspectRatio,
-                                const QColor& backColor = Qt::white,
-                                const QPoint& loc = QPoint( 0, 0 ) );
+  KnittingPatternItem( const QSize& aDim, const CellStyle& style );
   bool Init();
 
   /* return our object type; needed for qgraphicsitem_cast */
@@ -79,24 +74,21 @@ public:
   /* insert a new knitting symbol to be displayed */
   void insert_knitting_symbol( KnittingSymbolPtr symbol );
 
-  /* color related functions */
-  void set_background_color( const QColor& newColor );
-  const QColor& color() const { return backColor_; }
+  /* our background color */
+  virtual QColor color() const = 0;
 
   /* accessors for properties */
-  const QPoint& origin() const { return loc_; }
   const QSize& dim() const { return dim_; }
   const KnittingSymbolPtr get_knitting_symbol() const;
 
 
 protected:
 
-  /* a few setters for our children */
-  void select_background_color() { currentColor_ = backColor_; }
-  void select_highlight_color() { currentColor_ = highlightColor_; }
+  /* adjust to a change of the cell dimensions */
+  void fit_geometry_();
 
-  /* fit the svg item snug into our frame */
-  void fit_svg_();
+  /* appearance shared with all other cells */
+  const CellStyle& cell_style_() const { return style_; }
 
 
 private:
@@ -105,22 +97,14 @@ private:
   int status_;
 
   /* our data symbol */
-  QGraphicsSvgItem* svgItem_;
   KnittingSymbolPtr knittingSymbol_;
 
-  /* drawing related objects */
-  QPen pen_;
-  QColor backColor_;
-  QColor currentColor_;
-  QColor highlightColor_;
+  /* drawing related objects; everything shared by all
+   * cells lives in style_ */
+  const CellStyle& style_;
 
-  /* our location and dimensions */
+  /* our dimensions in units of cells */
   QSize dim_;
-  QPoint loc_;
-  const QSize& cellAspectRatio_;
-
-  /* functions */
-  void set_up_pens_brushes_();
 };
 
 
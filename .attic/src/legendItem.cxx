@@ -39,11 +39,11 @@ QT_BEGIN_NAMESPACE
 // constructor
 //-------------------------------------------------------------
 LegendItem::LegendItem( const QSize& aDim, const QString& tag,
-                        const QSize& aspectRatio, const QColor& aBackColor,
-                        const QPoint& aLoc )
+                        const CellStyle& aStyle, const QColor& aBackColor )
     :
-    KnittingPatternItem( aDim, aspectRatio, aBackColor, aLoc ),
-    idTag_( tag )
+    KnittingPatternItem( aDim, aStyle ),
+    idTag_( tag ),
+    backColor_( aBackColor )
 {
   status_ = SUCCESSFULLY_CONSTRUCTED;
 }
@@ -24,6 +24,9 @@
 /* boost includes */
 #include <boost/utility.hpp>
 
+/* QT includes */
+#include <QObject>
+
 /* local includes */
 #include "basicDefs.h"
 #include "knittingPatternItem.h"
@@ -40,11 +43,14 @@ QT_BEGIN_NAMESPACE
 /***************************************************************
  *
  * a LegendItem is basically a KnittingPatternItem that is
- * a seperate type so we can pick it out from the canvas
+ * a seperate type so we can pick it out from the canvas.
+ * Unlike chart cells it needs signals and slots for its
+ * options menu.
  *
  ***************************************************************/
 class LegendItem
     :
+    public QObject,
     public KnittingPatternItem
 {
 
@@ -54,9 +60,8 @@ class LegendItem
 public:
 
   explicit LegendItem( const QSize& aDim, const QString& idTag,
-                       const QSize& aspectRatio,
-                       const QColor& backColor = Qt::white,
-                       const QPoint& loc = QPoint( 0, 0 ) );
+                       const CellStyle& style,
+                       const QColor& backColor = Qt::white );
   bool Init();
 
   /* return our object type; needed for qgraphicsitem_cast */
@@ -64,7 +69,10 @@ public:
   int type() const;
 
   /* resize cell after a cell aspect ratio change */
-  void resize() { fit_svg_(); }
+  void resize() { fit_geometry_(); }
+
+  /* legend items keep their own color */
+  QColor color() const { return backColor_; }
 
 
 signals:
@@ -88,6 +96,7 @@ private:
   /* some tracking variables */
   int status_;
   QString idTag_;
+  QColor backColor_;
 
   /* private functions */
   void show_options_menu_( const QPoint& symPos ) const;
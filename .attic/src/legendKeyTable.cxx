@@ -0,0 +1,111 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* local headers */
+#include "helperFunctions.h"
+#include "legendKeyTable.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+LegendKeyTable::LegendKeyTable()
+{
+}
+
+
+
+//-------------------------------------------------------------
+// return the id for the given symbol, color and tag
+//-------------------------------------------------------------
+int LegendKeyTable::intern( const KnittingSymbolPtr symbol,
+                            const QColor& aColor, const QString& tag )
+{
+  int tagId = intern_tag_( tag );
+  QRgb rgb = aColor.rgb();
+  Key key( symbol.get(), ( static_cast<quint64>( rgb ) << 32 ) | tagId );
+
+  QHash<Key, int>::const_iterator pos = ids_.constFind( key );
+  if ( pos != ids_.constEnd() ) {
+    return pos.value();
+  }
+
+  int newId = symbols_.size();
+  ids_[key] = newId;
+  symbols_.push_back( symbol );
+  colors_.push_back( rgb );
+  tagIds_.push_back( tagId );
+  names_.push_back( get_legend_item_name( symbol->category(),
+                                          symbol->patternName(),
+                                          aColor.name(), tag ) );
+
+  return newId;
+}
+
+
+
+//-------------------------------------------------------------
+// forget all ids
+//-------------------------------------------------------------
+void LegendKeyTable::clear()
+{
+  ids_.clear();
+  tags_.clear();
+  symbols_.clear();
+  colors_.clear();
+  tagIds_.clear();
+  names_.clear();
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// return the index of tag in our tag list; there are only a
+// handful of distinct tags so a linear search is all we need
+//-------------------------------------------------------------
+int LegendKeyTable::intern_tag_( const QString& tag )
+{
+  int tagId = tags_.indexOf( tag );
+  if ( tagId == -1 ) {
+    tagId = tags_.size();
+    tags_.push_back( tag );
+  }
+
+  return tagId;
+}
+
+
+
+QT_END_NAMESPACE
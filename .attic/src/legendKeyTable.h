@@ -0,0 +1,100 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef LEGEND_KEY_TABLE_H
+#define LEGEND_KEY_TABLE_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QColor>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/***************************************************************
+ *
+ * LegendKeyTable interns (knitting symbol, color, tag) triples
+ * used for legend reference counting into small consecutive
+ * integer ids. The legend item name string for each id is
+ * only built once, the first time the triple is seen.
+ *
+ ***************************************************************/
+class LegendKeyTable
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  explicit LegendKeyTable();
+
+  /* return the id for symbol, color and tag, creating a new
+   * one if we haven't seen the combination before */
+  int intern( const KnittingSymbolPtr symbol, const QColor& color,
+              const QString& tag );
+
+  /* number of ids handed out so far */
+  int size() const { return symbols_.size(); }
+
+  /* accessors for the data behind an id */
+  const QString& name( int id ) const { return names_.at( id ); }
+  const KnittingSymbolPtr symbol( int id ) const { return symbols_.at( id ); }
+  QColor color( int id ) const { return QColor( colors_.at( id ) ); }
+  const QString& tag( int id ) const { return tags_.at( tagIds_.at( id ) ); }
+
+  /* forget all ids */
+  void clear();
+
+
+private:
+
+  /* lookup of (symbol, color | tag id) -> id */
+  typedef QPair<const KnittingSymbol*, quint64> Key;
+  QHash<Key, int> ids_;
+
+  /* tags are few so we intern them separately */
+  QStringList tags_;
+
+  /* per id data */
+  QVector<KnittingSymbolPtr> symbols_;
+  QVector<QRgb> colors_;
+  QVector<int> tagIds_;
+  QVector<QString> names_;
+
+  /* functions */
+  int intern_tag_( const QString& tag );
+};
+
+
+QT_END_NAMESPACE
+
+#endif
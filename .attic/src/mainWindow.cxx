@@ -18,6 +18,9 @@
 *
 ****************************************************************/
 
+/** boost headers */
+#include <boost/scoped_ptr.hpp>
+
 /** Qt headers */
 #include <QAction>
 #include <QCheckBox>
@@ -32,6 +35,7 @@
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QSettings>
 #include <QSplitter>
@@ -51,7 +55,9 @@
 #include "mainWindow.h"
 #include "patternView.h"
 #include "preferencesDialog.h"
+#include "projectFormat.h"
 #include "settings.h"
+#include "symbolPixmapCache.h"
 #include "symbolSelectorWidget.h"
 
 
@@ -122,6 +128,8 @@ bool MainWindow::Init()
   setWindowIcon( QIcon( ":/icons/sconcho_icon.png" ) );
   setMinimumSize( initialSize );
   initialize_settings( settings_ );
+  SymbolPixmapCache::instance().set_budget(
+    extract_symbol_cache_budget_from_settings( settings_ ) );
 
   /* populate the main interface
    * NOTE: We NEED to first create the patterKeyDialog and
@@ -269,7 +277,7 @@ void MainWindow::show_file_open_dialog_()
   QString currentDirectory = QDir::currentPath();
   QString openFileName = QFileDialog::getOpenFileName( this,
                          tr( "open data file" ), currentDirectory,
-                         tr( "sconcho pattern files (*.spf)" ) );
+                         project_file_filter() );
 
   if ( openFileName.isEmpty() ) {
     return;
@@ -287,7 +295,7 @@ void MainWindow::show_file_save_dialog_()
   QFileInfo currentFileInfo( saveFilePath_ );
   QString saveFileName = QFileDialog::getSaveFileName( this,
                          tr( "Save Pattern" ), currentFileInfo.fileName(),
-                         tr( "sconcho pattern files (*.spf)" ) );
+                         project_file_filter() );
 
   if ( saveFileName.isEmpty() ) {
     return;
@@ -296,12 +304,12 @@ void MainWindow::show_file_save_dialog_()
   /* extract file extension and make sure it corresponds to
    * a supported format */
   QFileInfo saveFileInfo( saveFileName );
-  QString extension = saveFileInfo.completeSuffix();
+  QString extension = saveFileInfo.suffix();
 
-  if ( extension != "spf" ) {
+  if ( find_project_format( saveFileName ) == 0 ) {
     if ( extension.isEmpty() ) {
-      /* add spf default suffix */
-      saveFileName = saveFileName + ".spf";
+      /* add default suffix */
+      saveFileName = saveFileName + "." + project_formats().first().suffix;
     } else {
 
       QMessageBox::warning( this, tr( "Warning" ),
@@ -615,6 +623,37 @@ void MainWindow::create_edit_menu_()
 {
   QMenu* editMenu = menuBar_->addMenu( tr( "&Edit" ) );
 
+  /* undo/redo */
+  QAction* undoAction = new QAction( tr( "&Undo" ), this );
+  editMenu->addAction( undoAction );
+  undoAction->setShortcut( tr( "Ctrl+Z" ) );
+  undoAction->setEnabled( false );
+  connect( undoAction,
+           SIGNAL( triggered() ),
+           canvas_,
+           SLOT( undo() ) );
+
+  connect( canvas_,
+           SIGNAL( undo_available( bool ) ),
+           undoAction,
+           SLOT( setEnabled( bool ) ) );
+
+  QAction* redoAction = new QAction( tr( "&Redo" ), this );
+  editMenu->addAction( redoAction );
+  redoAction->setShortcut( tr( "Ctrl+Y" ) );
+  redoAction->setEnabled( false );
+  connect( redoAction,
+           SIGNAL( triggered() ),
+           canvas_,
+           SLOT( redo() ) );
+
+  connect( canvas_,
+           SIGNAL( redo_available( bool ) ),
+           redoAction,
+           SLOT( setEnabled( bool ) ) );
+
+  editMenu->addSeparator();
+
   /* preferences */
   QAction* preferencesAction =
     new QAction( tr( "&Preferences" ), this );
@@ -727,7 +766,8 @@ void MainWindow::create_graphics_scene_()
 
   /* create canvas */
   QPoint origin( 0, 0 );
-  canvas_ = new GraphicsScene( origin, gridSize, settings_, defaultSymbol, this );
+  canvas_ = new GraphicsScene( origin, gridSize, settings_, allSymbols_,
+                               defaultSymbol, this );
   if ( !canvas_->Init() ) {
     qDebug() << "Failed to initialize canvas";
   }
@@ -746,7 +786,7 @@ void MainWindow::initialize_symbols_(
   const QList<ParsedSymbol>& rawSymbols )
 {
   foreach( ParsedSymbol sym, rawSymbols ) {
-    allSymbols_.push_back( sym.first );
+    allSymbols_.insert( sym.first );
   }
 }
 
@@ -982,17 +1022,30 @@ QSize MainWindow::show_grid_dimension_dialog_()
 //-------------------------------------------------------------
 void MainWindow::save_project_( const QString& fileName )
 {
+  const ProjectFormat* format = find_project_format( fileName );
+  if ( format == 0 ) {
+    QMessageBox::critical( this, tr( "Error" ),
+                           tr( "Can not save file with format " )
+                           + QFileInfo( fileName ).suffix(),
+                           QMessageBox::Ok );
+    return;
+  }
+
   QList<QColor> activeColors( colorSelectorWidget_->get_colors() );
-  CanvasIOWriter writer( canvas_, activeColors, settings_, fileName );
+  boost::scoped_ptr<ProjectWriter> writer(
+    format->create_writer( canvas_, activeColors, settings_, fileName ) );
 
-  /* we need to check if we can open the file for writing */
-  if ( !writer.Init() ) {
+  /* we need to check if we can open the file for writing and
+   * if all of the project actually made it to disk */
+  if ( !writer->Init() ) {
     QMessageBox::critical( 0, "Save File",
                            QString( "Failed to open file\n%1\nfor saving." )
                            .arg( fileName ) );
-    return;
-  } else {
-    writer.save();
+  } else if ( !writer->save() ) {
+    QMessageBox::critical( 0, "Save File",
+                           QString( "Failed to save project to file\n%1\n"
+                                    "The file may be incomplete." )
+                           .arg( fileName ) );
   }
 }
 
@@ -1012,28 +1065,40 @@ void MainWindow::load_project_( const QString& fileName )
   }
 
   /* is the extension correct? */
-  QString extension = openFile.completeSuffix();
-  if ( extension != "spf" ) {
+  const ProjectFormat* format = find_project_format( fileName );
+  if ( format == 0 ) {
     QMessageBox::critical( this, tr( "Error" ),
-                           tr( "Can not open file with format " ) + extension,
+                           tr( "Can not open file with format " )
+                           + openFile.suffix(),
                            QMessageBox::Ok );
     return;
   }
 
   /* try to read it */
-  CanvasIOReader reader( fileName, allSymbols_, settings_ );
+  boost::scoped_ptr<ProjectReader> reader(
+    format->create_reader( fileName, allSymbols_, settings_ ) );
 
   /* we need to make sure that we could parse the file */
-  if ( !reader.Init() ) {
+  if ( !reader->Init() ) {
     QMessageBox::critical( 0, "Read File",
                            QString( "Failed to open file\n%1\nfor reading." )
                            .arg( fileName ) );
     return;
   } else {
-    if ( !reader.read() ) {
-      QMessageBox::critical( 0, "Read File",
-                             QString( "Failed to open file\n%1\nfor reading." )
-                             .arg( fileName ) );
+    /* large projects take a while; let the user bail out */
+    QProgressDialog progress( tr( "Loading %1" ).arg( fileName ),
+                              tr( "Cancel" ), 0, 0, this );
+    progress.setWindowModality( Qt::WindowModal );
+    progress.setMinimumDuration( 500 );
+
+    if ( !reader->read( &progress ) ) {
+      if ( reader->was_canceled() ) {
+        show_statusBar_message( tr( "Loading canceled" ) );
+      } else {
+        QMessageBox::critical( 0, "Read File",
+                               QString( "Failed to open file\n%1\nfor reading." )
+                               .arg( fileName ) );
+      }
       return;
     }
 
@@ -1041,14 +1106,14 @@ void MainWindow::load_project_( const QString& fileName )
     canvas_->load_settings();
 
     /* establish canvas */
-    canvas_->load_new_canvas( reader.get_pattern_items() );
-    canvas_->instantiate_legend_items( reader.get_extra_legend_items() );
-    canvas_->place_legend_items( reader.get_legend_items() );
-    canvas_->place_legend_items( reader.get_extra_legend_items() );
+    canvas_->load_new_canvas( reader->get_chart() );
+    canvas_->instantiate_legend_items( reader->get_extra_legend_items() );
+    canvas_->place_legend_items( reader->get_legend_items() );
+    canvas_->place_legend_items( reader->get_extra_legend_items() );
 
     /* read custom colors and apply them */
-    QList<QColor> foo( reader.get_project_colors() );
-    colorSelectorWidget_->set_colors( reader.get_project_colors() );
+    QList<QColor> foo( reader->get_project_colors() );
+    colorSelectorWidget_->set_colors( reader->get_project_colors() );
   }
 
   canvasView_->visible_in_view();
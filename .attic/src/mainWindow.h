@@ -33,6 +33,7 @@
 /* local includes */
 #include "io.h"
 #include "knittingSymbol.h"
+#include "symbolCatalog.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -145,7 +146,7 @@ private:
   QLabel* currentMousePosWidget_;
 
   /* list of all knitting symbols we know about */
-  QList<KnittingSymbolPtr> allSymbols_;
+  SymbolCatalog allSymbols_;
 
   /* path to were current project file resides */
   QString saveFilePath_;
@@ -25,10 +25,9 @@
 /* Qt headers */
 #include <QColor>
 #include <QDebug>
-#include <QGraphicsSceneMouseEvent>
 
 /* local headers */
-#include "graphicsScene.h"
+#include "chartModel.h"
 #include "patternGridItem.h"
 
 
@@ -43,14 +42,10 @@ QT_BEGIN_NAMESPACE
 //-------------------------------------------------------------
 // constructor
 //-------------------------------------------------------------
-PatternGridItem::PatternGridItem( const QSize& aDim,
-                                  const QSize& aspectRatio, int aCol, int aRow,
-                                  GraphicsScene* myParent, const QColor& aBackColor,
-                                  const QPoint& aLoc )
+PatternGridItem::PatternGridItem( const QSize& aDim, const CellStyle& aStyle,
+                                  int aCol, int aRow )
     :
-    KnittingPatternItem( aDim, aspectRatio, aBackColor, aLoc ),
-    selected_( false ),
-    parent_( myParent ),
+    KnittingPatternItem( aDim, aStyle ),
     columnIndex_( aCol ),
     rowIndex_( aRow )
 {
@@ -70,20 +65,8 @@ bool PatternGridItem::Init()
   /* initialize our parent */
   KnittingPatternItem::Init();
 
-  /* set up some properties */
-  setFlags( QGraphicsItem::ItemIsSelectable );
-
-  /* some signals and slots */
-  connect( this,
-           SIGNAL( item_selected( PatternGridItem*, bool ) ),
-           parent_,
-           SLOT( grid_item_selected( PatternGridItem*, bool ) ) );
-
-  connect( this,
-           SIGNAL( item_reset( PatternGridItem* ) ),
-           parent_,
-           SLOT( grid_item_reset( PatternGridItem* ) ) );
-
+  /* mouse clicks are dispatched by the scene */
+  setAcceptedMouseButtons( 0 );
 
   return true;
 }
@@ -114,23 +97,15 @@ void PatternGridItem::reseat( int newCol, int newRow )
 
 
 //--------------------------------------------------------------
-// select this grid cell and turn highlighting on/off based
-// on its current status
+// return the color of our chart cell
 //--------------------------------------------------------------
-void PatternGridItem::select()
+QColor PatternGridItem::color() const
 {
-  if ( selected_ ) {
-    highlight_off_();
-    emit item_selected( this, false );
-  } else {
-    highlight_on_();
-    emit item_selected( this, true );
-  }
-
-  update();
+  return QColor( cell_style_().chart().color( columnIndex_, rowIndex_ ) );
 }
 
 
+
 //--------------------------------------------------------------
 // return our custom type
 //--------------------------------------------------------------
@@ -140,37 +115,6 @@ int PatternGridItem::type() const
 }
 
 
-/**************************************************************
- *
- * PROTECTED MEMBER FUNCTIONS
- *
- *************************************************************/
-
-//-------------------------------------------------------------
-// handle mouse press events
-//-------------------------------------------------------------
-void PatternGridItem::mousePressEvent(
-  QGraphicsSceneMouseEvent* anEvent )
-{
-  /* ignore right mouse clicks */
-  if ( anEvent->button() == Qt::RightButton ) {
-    return;
-  }
-
-  /* if the user has control pressed we ignore this event */
-  if ( anEvent->modifiers().testFlag( Qt::ControlModifier ) ) {
-    anEvent->ignore();
-    return;
-  }
-
-  /* if the user has shift pressed we don't do anything to
-   * not interfere with the rubber band */
-  if ( !anEvent->modifiers().testFlag( Qt::ShiftModifier ) ) {
-    select();
-  }
-}
-
-
 /**************************************************************
  *
  * PRIVATE SLOTS
@@ -183,23 +127,4 @@ void PatternGridItem::mousePressEvent(
  *
  *************************************************************/
 
-//-----------------------------------------------------------------
-// helper function for doing the internal housekeeping during
-// selecting/deselecting
-// NOTE: these functions should not emit an item_selected signal
-//-----------------------------------------------------------------
-void PatternGridItem::highlight_on_()
-{
-  selected_ = true;
-  select_highlight_color();
-}
-
-
-void PatternGridItem::highlight_off_()
-{
-  selected_ = false;
-  select_background_color();
-}
-
-
 QT_END_NAMESPACE
@@ -37,17 +37,17 @@ QT_BEGIN_NAMESPACE
 
 
 /* a few forward declarations */
-class GraphicsScene;
-class QGraphicsSceneMouseEvent;
-class QGraphicsSvgItem;
 class QPainter;
 class QStyleOptionGraphicsItem;
 
 
 /***************************************************************
  *
- * The GraphicsScene handles the sconcho's main drawing
- * canvas
+ * A PatternGridItem displays a single chart cell. There can
+ * be a lot of them, so they are plain QGraphicsItems without
+ * any QObject baggage and don't handle mouse events; the
+ * GraphicsScene takes care of those based on grid
+ * coordinates.
  *
  ***************************************************************/
 class PatternGridItem
@@ -55,64 +55,40 @@ class PatternGridItem
     public KnittingPatternItem
 {
 
-  Q_OBJECT
-
-
 public:
 
-  explicit PatternGridItem( const QSize& aDim,
-                            const QSize& aspectRatio, int columnID, int rowID,
-                            GraphicsScene* myParent = 0,
-                            const QColor& backColor = Qt::white,
-                            const QPoint& loc = QPoint( 0, 0 ) );
+  PatternGridItem( const QSize& aDim, const CellStyle& style,
+                   int columnID, int rowID );
   bool Init();
 
   /* return our object type; needed for qgraphicsitem_cast */
   enum { Type = UserType + PATTERN_GRID_ITEM_TYPE };
   int type() const;
 
-  /* this function selects a cell and highlights/unhightlights it
-   * based on its current status */
-  void select();
-
   /* reseat this cell to the given new column/row */
   void reseat( int newCol, int newRow );
 
   /* resize cell after a cell aspect ratio change */
-  void resize() { fit_svg_(); }
+  void resize() { fit_geometry_(); }
+
+  /* our color is looked up in the chart model so we don't
+   * keep a copy that has to follow recoloring and palette
+   * edits */
+  QColor color() const;
 
   /* accessors for properties */
   int col() const { return columnIndex_; }
   int row() const { return rowIndex_; }
 
 
-signals:
-
-  void item_selected( PatternGridItem* us, bool status );
-  void item_reset( PatternGridItem* us );
-
-
-protected:
-
-  void mousePressEvent( QGraphicsSceneMouseEvent* event );
-
-
 private:
 
   /* some tracking variables */
   int status_;
-  bool selected_;
-
-  /* our parent scene */
-  GraphicsScene* parent_;
 
   /* our location and dimensions */
   int columnIndex_;
   int rowIndex_;
-
-  /* functions */
-  void highlight_on_();
-  void highlight_off_();
 };
 
 
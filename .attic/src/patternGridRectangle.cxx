@@ -83,13 +83,23 @@ const
 {
   assert( boundingRect().contains( position ) );
 
-  /* get rectangle covering only the inside (not the
-   * actual rectangle line */
-  QRectF inside( boundingRect() );
-  qreal penWidth( currentPen_.widthF() );
-  inside.adjust( penWidth, penWidth, -penWidth, -penWidth );
+  return ( !interior_().contains( position ) );
+}
+
+
+
+//-------------------------------------------------------------
+// our shape is the rectangle line only, i.e., the bounding
+// box minus the interior
+//-------------------------------------------------------------
+QPainterPath PatternGridRectangle::shape() const
+{
+  QPainterPath border;
+  border.setFillRule( Qt::OddEvenFill );
+  border.addRect( boundingRect() );
+  border.addRect( interior_() );
 
-  return ( !inside.contains( position ) );
+  return border;
 }
 
 
@@ -136,4 +146,18 @@ void PatternGridRectangle::set_pen( QPen newPen )
  *
  *************************************************************/
 
+//-------------------------------------------------------------
+// rectangle covering only the inside (not the actual
+// rectangle line)
+//-------------------------------------------------------------
+QRectF PatternGridRectangle::interior_() const
+{
+  QRectF inside( boundingRect() );
+  qreal penWidth( currentPen_.widthF() );
+  inside.adjust( penWidth, penWidth, -penWidth, -penWidth );
+
+  return inside;
+}
+
+
 QT_END_NAMESPACE
@@ -27,6 +27,7 @@
 /* QT includes */
 #include <QGraphicsRectItem>
 #include <QObject>
+#include <QPainterPath>
 #include <QPen>
 
 /* local includes */
@@ -61,6 +62,10 @@ public:
   bool selected( const QPointF& clickPos ) const;
   void set_pen( QPen newPen );
 
+  /* only the rectangle line is part of our shape so clicks
+   * inside the rectangle reach the chart cells beneath */
+  QPainterPath shape() const;
+
 
   /* return our object type; needed for qgraphicsitem_cast */
   enum { Type = UserType + PATTERN_GRID_RECTANGLE_TYPE };
@@ -75,6 +80,9 @@ private:
   /* variables */
   QPen currentPen_;
 
+  /* the inside of the rectangle without the line */
+  QRectF interior_() const;
+
 };
 
 
@@ -23,6 +23,7 @@
 #include <QMouseEvent>
 #include <QRubberBand>
 #include <QGraphicsSceneMouseEvent>
+#include <QTimer>
 #include <QWheelEvent>
 
 #include <QScrollBar>
@@ -32,6 +33,7 @@
 #include "graphicsScene.h"
 #include "patternGridItem.h"
 #include "patternView.h"
+#include "symbolPixmapCache.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -50,7 +52,8 @@ PatternView::PatternView( GraphicsScene* aScene, QWidget* myParent )
     :
     QGraphicsView( aScene, myParent ),
     canvas_( aScene ),
-    rubberBandOn_( false )
+    rubberBandOn_( false ),
+    previewTimer_( 0 )
 {
   status_ = SUCCESSFULLY_CONSTRUCTED;
 }
@@ -140,6 +143,7 @@ void PatternView::visible_in_view()
   centerOn( mapFromScene( gridCenter ) );
 
   setMatrix( QMatrix() );
+  SymbolPixmapCache::instance().zoom_changed( 1.0 );
 }
 
 
@@ -152,6 +156,7 @@ void PatternView::zoom_in()
   QPointF center( mapToScene( rect() ).boundingRect().center() );
   scale( 1.1, 1.1 );
   centerOn( center );
+  SymbolPixmapCache::instance().zoom_changed( matrix().m11() );
 }
 
 
@@ -163,6 +168,7 @@ void PatternView::zoom_out()
   QPointF center( mapToScene( rect() ).boundingRect().center() );
   scale( 0.9, 0.9 );
   centerOn( center );
+  SymbolPixmapCache::instance().zoom_changed( matrix().m11() );
 }
 
 
@@ -208,6 +214,8 @@ void PatternView::pan_up()
 void PatternView::mouseReleaseEvent( QMouseEvent* evt )
 {
   if ( rubberBandOn_ ) {
+    previewTimer_->stop();
+
     /* retrieve final rubberBand geometry and pick
      * and select them */
     QRectF finalGeometry(
@@ -249,6 +257,12 @@ void PatternView::mouseMoveEvent( QMouseEvent* evt )
   if ( rubberBandOn_ ) {
     rubberBand_->setGeometry( QRect( rubberBandOrigin_,
                                      evt->pos() ).normalized() );
+
+    /* the preview catches up with the latest geometry once
+     * the timer fires */
+    if ( !previewTimer_->isActive() ) {
+      previewTimer_->start();
+    }
   }
 
   QGraphicsView::mouseMoveEvent( evt );
@@ -278,6 +292,20 @@ void PatternView::wheelEvent( QWheelEvent* aWheelEvent )
  *
  *************************************************************/
 
+//-------------------------------------------------------------
+// show the cells covered by the current rubber band
+//-------------------------------------------------------------
+void PatternView::update_selection_preview_()
+{
+  if ( !rubberBandOn_ ) {
+    return;
+  }
+
+  canvas_->preview_region(
+    mapToScene( rubberBand_->geometry() ).boundingRect() );
+}
+
+
 /*************************************************************
  *
  * PRIVATE MEMBER FUNCTIONS
@@ -299,6 +327,14 @@ void PatternView::initialize_rubberband_()
   aPalette.setBrush( QPalette::Base, Qt::blue );
   aPalette.setBrush( QPalette::WindowText, Qt::red );
   rubberBand_->setPalette( aPalette );
+
+  previewTimer_ = new QTimer( this );
+  previewTimer_->setSingleShot( true );
+  previewTimer_->setInterval( SELECTION_PREVIEW_INTERVAL );
+  connect( previewTimer_,
+           SIGNAL( timeout() ),
+           this,
+           SLOT( update_selection_preview_() ) );
 }
 
 
@@ -37,6 +37,7 @@ class GraphicsScene;
 class QWheelEvent;
 class QMouseEvent;
 class QRubberBand;
+class QTimer;
 
 
 /***************************************************************
@@ -80,6 +81,11 @@ protected:
   void wheelEvent( QWheelEvent* wheelEvent );
 
 
+private slots:
+
+  void update_selection_preview_();
+
+
 private:
 
   /* construction status variable */
@@ -93,6 +99,10 @@ private:
   bool rubberBandOn_;
   QPoint rubberBandOrigin_;
 
+  /* coalesces rubber band moves into at most one selection
+   * preview update per frame */
+  QTimer* previewTimer_;
+
   /* member functions */
   void initialize_rubberband_();
 };
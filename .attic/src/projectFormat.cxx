@@ -0,0 +1,263 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QDebug>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStringList>
+
+/* local headers */
+#include "binaryProject.h"
+#include "helperFunctions.h"
+#include "io.h"
+#include "projectFormat.h"
+#include "settings.h"
+#include "symbolCatalog.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+namespace
+{
+/* factories for the formats in the registry */
+ProjectReader* create_xml_reader( const QString& fileName,
+                                  const SymbolCatalog& allSymbols,
+                                  QSettings& settings )
+{
+  return new CanvasIOReader( fileName, allSymbols, settings );
+}
+
+ProjectWriter* create_xml_writer( const GraphicsScene* theScene,
+                                  const QList<QColor>& activeColors,
+                                  const QSettings& settings,
+                                  const QString& fileName )
+{
+  return new CanvasIOWriter( theScene, activeColors, settings, fileName );
+}
+
+ProjectReader* create_binary_reader( const QString& fileName,
+                                     const SymbolCatalog& allSymbols,
+                                     QSettings& settings )
+{
+  return new BinaryProjectReader( fileName, allSymbols, settings );
+}
+
+ProjectWriter* create_binary_writer( const GraphicsScene* theScene,
+                                     const QList<QColor>& activeColors,
+                                     const QSettings& settings,
+                                     const QString& fileName )
+{
+  return new BinaryProjectWriter( theScene, activeColors, settings,
+                                  fileName );
+}
+};
+
+
+
+//---------------------------------------------------------------
+// returns all supported project formats
+//---------------------------------------------------------------
+const QList<ProjectFormat>& project_formats()
+{
+  static QList<ProjectFormat> formats;
+  if ( formats.isEmpty() ) {
+    ProjectFormat xmlFormat = { "spf", "sconcho pattern files",
+                                create_xml_reader, create_xml_writer
+                              };
+    formats.push_back( xmlFormat );
+
+    ProjectFormat binaryFormat = { "sconchob",
+                                   "sconcho binary pattern files",
+                                   create_binary_reader,
+                                   create_binary_writer
+                                 };
+    formats.push_back( binaryFormat );
+  }
+
+  return formats;
+}
+
+
+
+//---------------------------------------------------------------
+// returns the format matching the suffix of fileName
+//---------------------------------------------------------------
+const ProjectFormat* find_project_format( const QString& fileName )
+{
+  QString suffix = QFileInfo( fileName ).suffix();
+  const QList<ProjectFormat>& formats = project_formats();
+  for ( int index = 0; index < formats.size(); ++index ) {
+    if ( formats.at( index ).suffix == suffix ) {
+      return &formats.at( index );
+    }
+  }
+
+  return 0;
+}
+
+
+
+//---------------------------------------------------------------
+// returns a file dialog filter listing all project formats
+//---------------------------------------------------------------
+QString project_file_filter()
+{
+  QStringList filters;
+  foreach( ProjectFormat format, project_formats() ) {
+    filters << QString( "%1 (*.%2)" ).arg( format.description )
+    .arg( format.suffix );
+  }
+
+  return filters.join( ";;" );
+}
+
+
+
+//---------------------------------------------------------------
+//
+//
+// class ProjectReader
+//
+//
+//---------------------------------------------------------------
+
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+ProjectReader::ProjectReader( const SymbolCatalog& syms,
+                              QSettings& settings )
+    :
+    allSymbols_( syms ),
+    settings_( settings ),
+    canceled_( false )
+{
+}
+
+
+
+/**************************************************************
+ *
+ * PROTECTED FUNCTIONS
+ *
+ **************************************************************/
+
+//----------------------------------------------------------------
+// add a just parsed legend entry. If the legend entry is a
+// widgetItem we also have to retrieve the correct
+// KnittingSymbolPtr
+//----------------------------------------------------------------
+void ProjectReader::add_legend_entry_( const QString& anID,
+                                       double anItemXPos, double anItemYPos,
+                                       double aLabelXPos, double aLabelYPos,
+                                       const QString& aLabelText )
+{
+  if ( is_extraLegendItem( anID ) ) {
+    add_to_extraLegendItems_( anID, anItemXPos, anItemYPos, aLabelXPos,
+                              aLabelYPos, aLabelText );
+  } else {
+    add_to_chartLegendItems_( anID, anItemXPos, anItemYPos, aLabelXPos,
+                              aLabelYPos, aLabelText );
+  }
+}
+
+
+
+//----------------------------------------------------------------
+// store the cell dimensions and font found in a project
+//----------------------------------------------------------------
+void ProjectReader::apply_settings_( const QSize& cellDimensions,
+                                     const QString& fontName )
+{
+  if ( cellDimensions.isValid() ) {
+    set_cell_dimensions( settings_, cellDimensions );
+  }
+
+  if ( !fontName.isEmpty() ) {
+    set_font_string( settings_, fontName );
+  }
+}
+
+
+
+/**************************************************************
+ *
+ * PRIVATE FUNCTIONS
+ *
+ **************************************************************/
+
+//----------------------------------------------------------------
+// add a just parsed chartLegendItem
+//----------------------------------------------------------------
+void ProjectReader::add_to_chartLegendItems_( const QString& anID,
+    double anItemXPos, double anItemYPos, double aLabelXPos,
+    double aLabelYPos, const QString& aLabelText )
+{
+  LegendEntryDescriptorPtr currentEntry( new LegendEntryDescriptor );
+  currentEntry->entryID = anID;
+  currentEntry->itemLocation = QPointF( anItemXPos, anItemYPos );
+  currentEntry->labelLocation = QPointF( aLabelXPos, aLabelYPos );
+  currentEntry->labelText = aLabelText;
+  currentEntry->patternSymbolPtr.reset();
+  newLegendEntryDescriptors_.push_back( currentEntry );
+}
+
+
+
+//----------------------------------------------------------------
+// add a just parsed extraLegendItem
+// NOTE: For these we also need to provide a KnittingSymbolPtr
+// because the chart won't do it for us like for chartLegendItem
+//----------------------------------------------------------------
+void ProjectReader::add_to_extraLegendItems_( const QString& anID,
+    double anItemXPos, double anItemYPos, double aLabelXPos,
+    double aLabelYPos, const QString& aLabelText )
+{
+  QString name = get_legend_item_name( anID );
+  QString category = get_legend_item_category( anID );
+
+  /* find proper knitting symbol */
+  KnittingSymbolPtr symbolPtr;
+  bool status = allSymbols_.find( category, name, symbolPtr );
+  if ( !status ) {
+    qDebug() << "ERROR: failed to load symbol" << category << ":" << name;
+  }
+
+  LegendEntryDescriptorPtr currentEntry( new LegendEntryDescriptor );
+  currentEntry->entryID = anID;
+  currentEntry->itemLocation = QPointF( anItemXPos, anItemYPos );
+  currentEntry->labelLocation = QPointF( aLabelXPos, aLabelYPos );
+  currentEntry->labelText = aLabelText;
+  currentEntry->patternSymbolPtr = symbolPtr;
+  newExtraLegendItemDescriptors_.push_back( currentEntry );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,224 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef PROJECT_FORMAT_H
+#define PROJECT_FORMAT_H
+
+/* boost includes */
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QColor>
+#include <QList>
+#include <QPointF>
+#include <QSize>
+#include <QString>
+
+/* local includes */
+#include "chartModel.h"
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* forward declarations */
+class GraphicsScene;
+class QProgressDialog;
+class QSettings;
+class SymbolCatalog;
+
+
+
+/*******************************************************************
+ *
+ * LegendEntryDescriptor is a data structure that contains
+ * all the information allowing GraphicsScene to reconstruct
+ * the position and text of legend items derived both from the
+ * chart as well as extra items
+ *
+ ******************************************************************/
+struct LegendEntryDescriptor {
+  QString entryID;
+  QPointF itemLocation;
+  QPointF labelLocation;
+  QString labelText;
+  KnittingSymbolPtr patternSymbolPtr;
+};
+
+typedef boost::shared_ptr<LegendEntryDescriptor>
+LegendEntryDescriptorPtr;
+
+
+
+/*******************************************************************
+ *
+ * ProjectWriter is the interface shared by all writers of
+ * sconcho project files
+ *
+ ******************************************************************/
+class ProjectWriter
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  virtual ~ProjectWriter() {}
+  virtual bool Init() = 0;
+
+  /* save content of canvas */
+  virtual bool save() = 0;
+};
+
+
+
+/*******************************************************************
+ *
+ * ProjectReader is the interface shared by all readers of
+ * sconcho project files. It holds the parsed information
+ * the canvas is re-built from.
+ *
+ ******************************************************************/
+class ProjectReader
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  explicit ProjectReader( const SymbolCatalog& allSymbols,
+                          QSettings& settings );
+  virtual ~ProjectReader() {}
+  virtual bool Init() = 0;
+
+  /* read content of canvas; if a progress dialog is given
+   * it is kept up to date and allows the user to cancel */
+  virtual bool read( QProgressDialog* progress = 0 ) = 0;
+  bool was_canceled() const { return canceled_; }
+
+  /* accessors for parsed information */
+  const ChartModel& get_chart() const {
+    return chart_;
+  }
+
+  const QList<LegendEntryDescriptorPtr>& get_legend_items() const {
+    return newLegendEntryDescriptors_;
+  }
+
+  const QList<LegendEntryDescriptorPtr>& get_extra_legend_items() const {
+    return newExtraLegendItemDescriptors_;
+  }
+
+  const QList<QColor>& get_project_colors() const {
+    return projectColors_;
+  }
+
+
+protected:
+
+  const SymbolCatalog& allSymbols_;
+  QSettings& settings_;
+  bool canceled_;
+
+  /* the chart cells found in the input file */
+  ChartModel chart_;
+
+  /* QList of parsed legend descriptors coming from the chart */
+  QList<LegendEntryDescriptorPtr> newLegendEntryDescriptors_;
+
+  /* QList of extra parsed legend descriptors */
+  QList<LegendEntryDescriptorPtr> newExtraLegendItemDescriptors_;
+
+  /* QList of selector colors */
+  QList<QColor> projectColors_;
+
+  /* file the entry with the chart or extra legend items
+   * depending on its ID */
+  void add_legend_entry_( const QString& entryID, double itemXPos,
+                          double itemYPos, double labelXPos,
+                          double labelYPos, const QString& labelText );
+
+  /* store the cell dimensions and font found in a project;
+   * invalid or empty values are ignored */
+  void apply_settings_( const QSize& cellDimensions,
+                        const QString& fontName );
+
+
+private:
+
+  void add_to_extraLegendItems_( const QString& entryID, double itemXPos,
+                                 double itemYPos, double labelXPos, double labelYPos,
+                                 const QString& labelText );
+  void add_to_chartLegendItems_( const QString& entryID, double itemXPos,
+                                 double itemYPos, double labelXPos, double labelYPos,
+                                 const QString& labelText );
+};
+
+
+
+/*******************************************************************
+ *
+ * ProjectFormat describes a project file format we can read
+ * and write. Formats are told apart by their file suffix.
+ *
+ ******************************************************************/
+struct ProjectFormat {
+  QString suffix;
+  QString description;
+
+  ProjectReader* ( *create_reader )( const QString& fileName,
+                                     const SymbolCatalog& allSymbols,
+                                     QSettings& settings );
+  ProjectWriter* ( *create_writer )( const GraphicsScene* theScene,
+                                     const QList<QColor>& activeColors,
+                                     const QSettings& settings,
+                                     const QString& fileName );
+};
+
+
+
+//---------------------------------------------------------------
+// returns all supported project formats; the first one is
+// the default
+//---------------------------------------------------------------
+const QList<ProjectFormat>& project_formats();
+
+
+
+//---------------------------------------------------------------
+// returns the format matching the suffix of fileName or 0
+// if there is none
+//---------------------------------------------------------------
+const ProjectFormat* find_project_format( const QString& fileName );
+
+
+
+//---------------------------------------------------------------
+// returns a file dialog filter listing all project formats
+//---------------------------------------------------------------
+QString project_file_filter();
+
+
+QT_END_NAMESPACE
+
+#endif
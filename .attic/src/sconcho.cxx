@@ -24,6 +24,7 @@
 
 /** local includes */
 #include "mainWindow.h"
+#include "symbolPixmapCache.h"
 
 
 int main( int argc, char** argv )
@@ -40,5 +41,11 @@ int main( int argc, char** argv )
   }
 
   mainWin.show();
-  return app.exec();
+  int result = app.exec();
+
+  /** the pixmap cache lives until the end of the program but
+   * pixmaps must not outlive the application object */
+  SymbolPixmapCache::instance().clear();
+
+  return result;
 }
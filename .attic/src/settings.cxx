@@ -67,6 +67,23 @@ void initialize_settings( QSettings& settings )
     defaultHeight.setNum( GRID_CELL_HEIGHT );
     settings.setValue( "global/cell_height", defaultHeight );
   }
+
+  /* memory budget for rasterized knitting symbols */
+  QString cacheBudget =
+    settings.value( "global/symbol_cache_budget" ).toString();
+  if ( cacheBudget.isEmpty() ) {
+    QString defaultBudget;
+    defaultBudget.setNum( SYMBOL_PIXMAP_CACHE_BUDGET );
+    settings.setValue( "global/symbol_cache_budget", defaultBudget );
+  }
+
+  /* memory budget for the undo history */
+  QString undoBudget = settings.value( "global/undo_budget" ).toString();
+  if ( undoBudget.isEmpty() ) {
+    QString defaultBudget;
+    defaultBudget.setNum( UNDO_JOURNAL_BUDGET );
+    settings.setValue( "global/undo_budget", defaultBudget );
+  }
 }
 
 
@@ -102,6 +119,33 @@ QSize extract_cell_dimensions_from_settings( const QSettings& settings )
 
 
 
+/*******************************************************************
+ * accessor function for the symbol pixmap cache budget
+ *******************************************************************/
+int extract_symbol_cache_budget_from_settings( const QSettings& settings )
+{
+  QString cacheBudget =
+    settings.value( "global/symbol_cache_budget" ).toString();
+  assert( !cacheBudget.isNull() );
+
+  return cacheBudget.toInt();
+}
+
+
+
+/*******************************************************************
+ * accessor function for the undo history budget
+ *******************************************************************/
+int extract_undo_budget_from_settings( const QSettings& settings )
+{
+  QString undoBudget = settings.value( "global/undo_budget" ).toString();
+  assert( !undoBudget.isNull() );
+
+  return undoBudget.toInt();
+}
+
+
+
 /*******************************************************************
  * implementations of setters for settings
  ******************************************************************/
@@ -51,6 +51,20 @@ QFont extract_font_from_settings( const QSettings& settings );
 QSize extract_cell_dimensions_from_settings( const QSettings& settings );
 
 
+
+/*******************************************************************
+ * accessor function for the symbol pixmap cache budget (in kB)
+ *******************************************************************/
+int extract_symbol_cache_budget_from_settings( const QSettings& settings );
+
+
+
+/*******************************************************************
+ * accessor function for the undo history budget (in kB)
+ *******************************************************************/
+int extract_undo_budget_from_settings( const QSettings& settings );
+
+
 /************************************************************
  * set a new font string
  ***********************************************************/
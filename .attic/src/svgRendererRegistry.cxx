@@ -0,0 +1,96 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+/* Qt headers */
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSvgRenderer>
+
+/* local headers */
+#include "svgRendererRegistry.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// return the registry; it is created on first use
+//-------------------------------------------------------------
+SvgRendererRegistry& SvgRendererRegistry::instance()
+{
+  static SvgRendererRegistry registry;
+  return registry;
+}
+
+
+
+//-------------------------------------------------------------
+// return the shared renderer for symbol, parsing its svg file
+// the first time it is requested.
+// NOTE: The renderers are parented to the application object
+// and go away with it.
+//-------------------------------------------------------------
+QSvgRenderer* SvgRendererRegistry::renderer( const KnittingSymbolPtr symbol )
+{
+  const QString& path = symbol->path();
+  if ( path == "" ) {
+    return 0;
+  }
+
+  QHash<QString, QSvgRenderer*>::const_iterator pos = renderers_.constFind( path );
+  if ( pos != renderers_.constEnd() ) {
+    return pos.value();
+  }
+
+  QSvgRenderer* newRenderer = new QSvgRenderer( path,
+                                                QCoreApplication::instance() );
+  if ( !newRenderer->isValid() ) {
+    qDebug() << "Error: could not load svg file " << path;
+    delete newRenderer;
+    newRenderer = 0;
+  }
+  renderers_[path] = newRenderer;
+
+  return newRenderer;
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+SvgRendererRegistry::SvgRendererRegistry()
+{
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,77 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+#ifndef SVG_RENDERER_REGISTRY_H
+#define SVG_RENDERER_REGISTRY_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QHash>
+#include <QString>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* a few forward declarations */
+class QSvgRenderer;
+
+
+/***************************************************************
+ *
+ * SvgRendererRegistry keeps a single QSvgRenderer for each
+ * knitting symbol svg file so that every item displaying
+ * the symbol can share it. Each file is parsed exactly once
+ * the first time its symbol is requested.
+ *
+ ***************************************************************/
+class SvgRendererRegistry
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  /* access to the process wide registry */
+  static SvgRendererRegistry& instance();
+
+  /* return the renderer for a knitting symbol or 0 for
+   * the empty symbol and symbols whose svg file can't
+   * be loaded */
+  QSvgRenderer* renderer( const KnittingSymbolPtr symbol );
+
+
+private:
+
+  SvgRendererRegistry();
+
+  /* renderers by svg path; invalid files map to 0 */
+  QHash<QString, QSvgRenderer*> renderers_;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,76 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* local headers */
+#include "symbolCatalog.h"
+
+
+QT_BEGIN_NAMESPACE
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+SymbolCatalog::SymbolCatalog()
+{
+}
+
+
+
+//-------------------------------------------------------------
+// add a symbol to the catalog
+//-------------------------------------------------------------
+void SymbolCatalog::insert( const KnittingSymbolPtr symbol )
+{
+  Key key( symbol->category(), symbol->patternName() );
+  if ( !index_.contains( key ) ) {
+    index_[key] = symbol;
+  }
+
+  symbols_.push_back( symbol );
+}
+
+
+
+//-------------------------------------------------------------
+// look up the symbol for category and name
+//-------------------------------------------------------------
+bool SymbolCatalog::find( const QString& category, const QString& name,
+                          KnittingSymbolPtr& symbolPtr ) const
+{
+  QHash<Key, KnittingSymbolPtr>::const_iterator pos =
+    index_.constFind( Key( category, name ) );
+  if ( pos == index_.constEnd() ) {
+    return false;
+  }
+
+  symbolPtr = pos.value();
+  return true;
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,82 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef SYMBOL_CATALOG_H
+#define SYMBOL_CATALOG_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/***************************************************************
+ *
+ * SymbolCatalog holds all knitting symbols we know about and
+ * looks them up by (category, name) via a hash index instead
+ * of scanning the whole list.
+ *
+ ***************************************************************/
+class SymbolCatalog
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  explicit SymbolCatalog();
+
+  /* add a symbol; a later symbol with the same category and
+   * name as an earlier one does not replace it */
+  void insert( const KnittingSymbolPtr symbol );
+
+  /* retrieve the symbol for category and name. Returns true
+   * on success and false otherwise */
+  bool find( const QString& category, const QString& name,
+             KnittingSymbolPtr& symbolPtr ) const;
+
+  /* all symbols in the order they were inserted */
+  const QList<KnittingSymbolPtr>& symbols() const { return symbols_; }
+  int size() const { return symbols_.size(); }
+
+
+private:
+
+  typedef QPair<QString, QString> Key;
+  QHash<Key, KnittingSymbolPtr> index_;
+
+  QList<KnittingSymbolPtr> symbols_;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
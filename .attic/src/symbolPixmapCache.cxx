@@ -0,0 +1,246 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+/* C++ headers */
+#include <cmath>
+
+/* Qt headers */
+#include <QDebug>
+#include <QPainter>
+#include <QSvgRenderer>
+
+/* local headers */
+#include "basicDefs.h"
+#include "svgRendererRegistry.h"
+#include "symbolPixmapCache.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+namespace
+{
+/* zoom levels are bucketed in steps of the view's zoom factor */
+const qreal ZOOM_BUCKET_STEP = 1.1;
+
+/* number of zoom buckets on either side of the current one
+ * we keep pixmaps for */
+const int ZOOM_BUCKETS_KEPT = 2;
+};
+
+
+
+//-------------------------------------------------------------
+// pixmap keys are equal if all their fields are
+//-------------------------------------------------------------
+bool operator==( const SymbolPixmapKey& lhs, const SymbolPixmapKey& rhs )
+{
+  return lhs.renderer == rhs.renderer && lhs.width == rhs.width
+         && lhs.height == rhs.height && lhs.background == rhs.background;
+}
+
+
+
+//-------------------------------------------------------------
+// hash of a pixmap key
+//-------------------------------------------------------------
+uint qHash( const SymbolPixmapKey& key )
+{
+  uint hash = qHash( key.renderer );
+  hash = hash * 31 + uint( key.width );
+  hash = hash * 31 + uint( key.height );
+  return hash * 31 + key.background;
+}
+
+
+/**************************************************************
+ *
+ * PUBLIC FUNCTIONS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// return the cache; it is created on first use
+//-------------------------------------------------------------
+SymbolPixmapCache& SymbolPixmapCache::instance()
+{
+  static SymbolPixmapCache cache;
+  return cache;
+}
+
+
+
+//-------------------------------------------------------------
+// change the memory budget; shrinking it evicts the least
+// recently used pixmaps right away
+//-------------------------------------------------------------
+void SymbolPixmapCache::set_budget( int kBytes )
+{
+  pixmaps_.setMaxCost( qMax( kBytes, 0 ) );
+}
+
+
+
+//-------------------------------------------------------------
+// draw the background and symbol into rect
+//-------------------------------------------------------------
+void SymbolPixmapCache::draw( QPainter* painter,
+                              const KnittingSymbolPtr symbol,
+                              const QRectF& rect, const QColor& background )
+{
+  QSvgRenderer* renderer = SvgRendererRegistry::instance().renderer( symbol );
+  if ( renderer == 0 ) {
+    painter->fillRect( rect, background );
+    return;
+  }
+
+  QRectF deviceRect = painter->worldTransform().mapRect( rect );
+  QSize deviceSize( qRound( deviceRect.width() ),
+                    qRound( deviceRect.height() ) );
+
+  const QPixmap* symbolPixmap = 0;
+  if ( deviceSize.width() > 0 && deviceSize.height() > 0
+       && deviceSize.width() <= SYMBOL_PIXMAP_MAX_EDGE
+       && deviceSize.height() <= SYMBOL_PIXMAP_MAX_EDGE ) {
+    int zoomBucket = zoom_bucket_( deviceRect.width() / rect.width() );
+    symbolPixmap = get_pixmap_( renderer, deviceSize, background,
+                                zoomBucket );
+  }
+
+  if ( symbolPixmap != 0 ) {
+    painter->drawPixmap( rect, *symbolPixmap, QRectF( symbolPixmap->rect() ) );
+  } else {
+    painter->fillRect( rect, background );
+    renderer->render( painter, rect );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// release all pixmaps rendered for zoom levels more than
+// ZOOM_BUCKETS_KEPT steps away from scale. We also forget
+// about pixmaps QCache evicted on its own in the meantime.
+//-------------------------------------------------------------
+void SymbolPixmapCache::zoom_changed( qreal scale )
+{
+  int currentBucket = zoom_bucket_( scale );
+
+  QHash<SymbolPixmapKey, int>::iterator pos = zoomBuckets_.begin();
+  while ( pos != zoomBuckets_.end() ) {
+    if ( !pixmaps_.contains( pos.key() ) ) {
+      pos = zoomBuckets_.erase( pos );
+    } else if ( qAbs( pos.value() - currentBucket ) > ZOOM_BUCKETS_KEPT ) {
+      pixmaps_.remove( pos.key() );
+      pos = zoomBuckets_.erase( pos );
+    } else {
+      ++pos;
+    }
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// release all pixmaps
+//-------------------------------------------------------------
+void SymbolPixmapCache::clear()
+{
+  pixmaps_.clear();
+  zoomBuckets_.clear();
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// constructor
+//-------------------------------------------------------------
+SymbolPixmapCache::SymbolPixmapCache()
+    :
+    pixmaps_( SYMBOL_PIXMAP_CACHE_BUDGET )
+{
+}
+
+
+
+//-------------------------------------------------------------
+// return the pixmap for the symbol drawn by renderer at
+// deviceSize on background, rasterizing it if it isn't cached
+// yet. Returns 0 if the pixmap doesn't fit into the budget.
+//-------------------------------------------------------------
+const QPixmap* SymbolPixmapCache::get_pixmap_(
+  QSvgRenderer* renderer, const QSize& deviceSize,
+  const QColor& background, int zoomBucket )
+{
+  SymbolPixmapKey key;
+  key.renderer   = renderer;
+  key.width      = deviceSize.width();
+  key.height     = deviceSize.height();
+  key.background = background.rgba();
+
+  QPixmap* symbolPixmap = pixmaps_.object( key );
+  if ( symbolPixmap != 0 ) {
+    return symbolPixmap;
+  }
+
+  symbolPixmap = new QPixmap( deviceSize );
+  symbolPixmap->fill( background );
+  QPainter pixmapPainter( symbolPixmap );
+  pixmapPainter.setRenderHints( QPainter::Antialiasing );
+  renderer->render( &pixmapPainter, QRectF( symbolPixmap->rect() ) );
+  pixmapPainter.end();
+
+  /* cost is measured in kB */
+  int cost = qMax( 1, deviceSize.width() * deviceSize.height()
+                   * symbolPixmap->depth() / 8 / 1024 );
+
+  /* QCache deletes objects that exceed its budget */
+  if ( !pixmaps_.insert( key, symbolPixmap, cost ) ) {
+    zoomBuckets_.remove( key );
+    return 0;
+  }
+  zoomBuckets_[key] = zoomBucket;
+
+  return symbolPixmap;
+}
+
+
+
+//-------------------------------------------------------------
+// map a zoom factor onto its bucket
+//-------------------------------------------------------------
+int SymbolPixmapCache::zoom_bucket_( qreal scale ) const
+{
+  if ( scale <= 0.0 ) {
+    return 0;
+  }
+
+  return qRound( log( scale ) / log( ZOOM_BUCKET_STEP ) );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,122 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+#ifndef SYMBOL_PIXMAP_CACHE_H
+#define SYMBOL_PIXMAP_CACHE_H
+
+/* boost includes */
+#include <boost/utility.hpp>
+
+/* QT includes */
+#include <QCache>
+#include <QColor>
+#include <QHash>
+#include <QPixmap>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* a few forward declarations */
+class QPainter;
+class QRectF;
+class QSize;
+class QSvgRenderer;
+
+
+/* cache key of a rasterized symbol. The registry keeps a single
+ * renderer per svg file for the lifetime of the application so
+ * the renderer identifies the symbol. */
+struct SymbolPixmapKey {
+  const QSvgRenderer* renderer;
+  int width;
+  int height;
+  QRgb background;
+};
+
+bool operator==( const SymbolPixmapKey& lhs, const SymbolPixmapKey& rhs );
+uint qHash( const SymbolPixmapKey& key );
+
+
+/***************************************************************
+ *
+ * SymbolPixmapCache keeps rasterized versions of knitting
+ * symbols so that cells can be blitted instead of re-rendering
+ * the svg on every repaint. Pixmaps are keyed by symbol, size
+ * in device pixels (which is what changes when zooming) and
+ * background color; looking one up doesn't allocate anything
+ * since it happens for every visible cell on every repaint.
+ * The least recently used pixmaps are
+ * evicted once the memory budget is exhausted.
+ *
+ ***************************************************************/
+class SymbolPixmapCache
+    :
+    public boost::noncopyable
+{
+
+public:
+
+  /* access to the process wide cache */
+  static SymbolPixmapCache& instance();
+
+  /* memory budget in kB */
+  void set_budget( int kBytes );
+  int budget() const { return pixmaps_.maxCost(); }
+
+  /* draw symbol on top of background into rect. Symbols
+   * are taken from the cache if possible and rendered
+   * straight from the svg otherwise (e.g. when printing
+   * at very high resolution) */
+  void draw( QPainter* painter, const KnittingSymbolPtr symbol,
+             const QRectF& rect, const QColor& background );
+
+  /* let the cache know that the view changed its zoom
+   * factor; pixmaps far away from the new zoom level
+   * are released */
+  void zoom_changed( qreal scale );
+
+  /* release all pixmaps; this has to happen before the
+   * application object goes away */
+  void clear();
+
+
+private:
+
+  SymbolPixmapCache();
+
+  /* the pixmaps and the zoom bucket each was rendered for */
+  QCache<SymbolPixmapKey, QPixmap> pixmaps_;
+  QHash<SymbolPixmapKey, int> zoomBuckets_;
+
+  /* functions */
+  const QPixmap* get_pixmap_( QSvgRenderer* renderer,
+                              const QSize& deviceSize,
+                              const QColor& background, int zoomBucket );
+  int zoom_bucket_( qreal scale ) const;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
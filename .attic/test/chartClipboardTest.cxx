@@ -0,0 +1,337 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QColor>
+#include <QDataStream>
+#include <QtTest>
+
+/* local headers */
+#include "basicDefs.h"
+#include "chartClipboardTest.h"
+#include "testHelpers.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+namespace
+{
+/* payload header as written by encode_copy_object */
+const quint32 CHART_CELLS_MAGIC = 0x53434e43;
+const quint16 CHART_CELLS_VERSION = 1;
+
+
+//-------------------------------------------------------------
+// add a cell to a copy object
+//-------------------------------------------------------------
+void add_cell( CopyObject& cells, KnittingSymbolPtr symbol,
+               const QColor& color, int column, int row )
+{
+  append_copy_cell( cells, symbol, color, column, row,
+                    symbol->dim().width() );
+}
+};
+
+
+
+/**************************************************************
+ *
+ * PRIVATE SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// symbols shared by all tests
+//-------------------------------------------------------------
+void ChartClipboardTest::initTestCase()
+{
+  knit_ = make_test_symbol( "knit" );
+  cable_ = make_test_symbol( "cable", 3 );
+  catalog_.insert( knit_ );
+  catalog_.insert( cable_ );
+}
+
+
+
+//-------------------------------------------------------------
+// decoding an encoded copy object gives back the same cells
+//-------------------------------------------------------------
+void ChartClipboardTest::round_trip()
+{
+  CopyObject cells = sample_cells_();
+  QByteArray data = encode_copy_object( cells );
+  QVERIFY( !data.isEmpty() );
+
+  CopyObject decoded;
+  QVERIFY( decode_copy_object( data, catalog_, decoded ) );
+  QCOMPARE( decoded.width, cells.width );
+  QCOMPARE( decoded.height, cells.height );
+  QCOMPARE( decoded.runs.size(), cells.runs.size() );
+
+  for ( int index = 0; index < cells.runs.size(); ++index ) {
+    const CopyObjectRun& original = cells.runs.at( index );
+    const CopyObjectRun& copy = decoded.runs.at( index );
+    QVERIFY( copy.symbol == original.symbol );
+    QCOMPARE( copy.backColor, original.backColor );
+    QCOMPARE( copy.row, original.row );
+    QCOMPARE( copy.column, original.column );
+    QCOMPARE( copy.count, original.count );
+    QCOMPARE( copy.width, original.width );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// a row of identical cells is stored as a single run, so
+// neither the copy object nor the payload grow with the width
+// of the selection
+//-------------------------------------------------------------
+void ChartClipboardTest::identical_cells_form_runs()
+{
+  CopyObject narrow;
+  narrow.width = 2;
+  narrow.height = 1;
+  add_cell( narrow, knit_, Qt::red, 0, 0 );
+  add_cell( narrow, knit_, Qt::red, 1, 0 );
+
+  CopyObject wide;
+  wide.width = 1000;
+  wide.height = 1;
+  for ( int col = 0; col < wide.width; ++col ) {
+    add_cell( wide, knit_, Qt::red, col, 0 );
+  }
+
+  QCOMPARE( encode_copy_object( wide ).size(),
+            encode_copy_object( narrow ).size() );
+
+  CopyObject decoded;
+  QVERIFY( decode_copy_object( encode_copy_object( wide ), catalog_,
+                               decoded ) );
+  QCOMPARE( wide.runs.size(), 1 );
+  QCOMPARE( decoded.runs.size(), 1 );
+  QCOMPARE( decoded.runs.first().count, 1000 );
+  QCOMPARE( decoded.runs.first().column, 0 );
+}
+
+
+
+//-------------------------------------------------------------
+// anything that isn't one of our payloads is rejected
+//-------------------------------------------------------------
+void ChartClipboardTest::rejects_garbage()
+{
+  CopyObject decoded;
+  QVERIFY( !decode_copy_object( QByteArray(), catalog_, decoded ) );
+  QVERIFY( !decode_copy_object( QByteArray( "no sconcho cells here" ),
+                                catalog_, decoded ) );
+
+  QByteArray wrongMagic = encode_copy_object( sample_cells_() );
+  wrongMagic[0] = ~wrongMagic[0];
+  QVERIFY( !decode_copy_object( wrongMagic, catalog_, decoded ) );
+
+  QByteArray wrongVersion = encode_copy_object( sample_cells_() );
+  wrongVersion[5] = wrongVersion[5] + 1;
+  QVERIFY( !decode_copy_object( wrongVersion, catalog_, decoded ) );
+}
+
+
+
+//-------------------------------------------------------------
+// a payload cut off anywhere is rejected
+//-------------------------------------------------------------
+void ChartClipboardTest::rejects_truncated_payload()
+{
+  QByteArray data = encode_copy_object( sample_cells_() );
+  for ( int size = 0; size < data.size(); ++size ) {
+    CopyObject decoded;
+    QVERIFY2( !decode_copy_object( data.left( size ), catalog_, decoded ),
+              qPrintable( QString( "accepted %1 of %2 bytes" )
+                          .arg( size ).arg( data.size() ) ) );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// payloads referring to symbols we don't know are rejected
+//-------------------------------------------------------------
+void ChartClipboardTest::rejects_unknown_symbol()
+{
+  SymbolCatalog otherCatalog;
+  otherCatalog.insert( knit_ );
+
+  CopyObject decoded;
+  QVERIFY( !decode_copy_object( encode_copy_object( sample_cells_() ),
+                                otherCatalog, decoded ) );
+}
+
+
+
+//-------------------------------------------------------------
+// runs have to stay within their row
+//-------------------------------------------------------------
+void ChartClipboardTest::rejects_runs_outside_of_row()
+{
+  CopyObject decoded;
+  QVERIFY( decode_copy_object( single_run_payload_( 4, 0, 4, 1, 0, 0 ),
+                               catalog_, decoded ) );
+  QVERIFY( decode_copy_object( single_run_payload_( 4, 1, 1, 3, 0, 0 ),
+                               catalog_, decoded ) );
+
+  QVERIFY( !decode_copy_object( single_run_payload_( 4, 0, 5, 1, 0, 0 ),
+                                catalog_, decoded ) );
+  QVERIFY( !decode_copy_object( single_run_payload_( 4, 2, 1, 3, 0, 0 ),
+                                catalog_, decoded ) );
+  QVERIFY( !decode_copy_object( single_run_payload_( 4, 4, 1, 1, 0, 0 ),
+                                catalog_, decoded ) );
+  QVERIFY( !decode_copy_object( single_run_payload_( 4, -1, 1, 1, 0, 0 ),
+                                catalog_, decoded ) );
+  QVERIFY( !decode_copy_object( single_run_payload_( 4, 0, 0, 1, 0, 0 ),
+                                catalog_, decoded ) );
+  QVERIFY( !decode_copy_object( single_run_payload_( 4, 0, 1, 0, 0, 0 ),
+                                catalog_, decoded ) );
+
+  /* counts large enough to overflow column + count * width */
+  QVERIFY( !decode_copy_object(
+             single_run_payload_( 4, 1, 0x7fffffff, 2, 0, 0 ),
+             catalog_, decoded ) );
+}
+
+
+
+//-------------------------------------------------------------
+// a payload may not describe more cells than the largest
+// chart we create; below that a single run stays a single
+// run no matter how many cells it covers
+//-------------------------------------------------------------
+void ChartClipboardTest::rejects_oversized_payload()
+{
+  CopyObject decoded;
+  QVERIFY( decode_copy_object(
+             single_run_payload_( MAX_CHART_CELLS, 0, MAX_CHART_CELLS, 1,
+                                  0, 0 ),
+             catalog_, decoded ) );
+  QCOMPARE( decoded.runs.size(), 1 );
+  QCOMPARE( decoded.runs.first().count, MAX_CHART_CELLS );
+
+  QVERIFY( !decode_copy_object(
+             single_run_payload_( 0x7fffffff, 0, 0x7fffffff, 1, 0, 0 ),
+             catalog_, decoded ) );
+  QVERIFY( !decode_copy_object(
+             single_run_payload_( MAX_CHART_CELLS + 1, 0, 1, 1, 0, 0 ),
+             catalog_, decoded ) );
+}
+
+
+
+//-------------------------------------------------------------
+// runs have to refer to existing symbol and color entries
+//-------------------------------------------------------------
+void ChartClipboardTest::rejects_invalid_table_indices()
+{
+  CopyObject decoded;
+  QVERIFY( !decode_copy_object( single_run_payload_( 4, 0, 1, 1, 1, 0 ),
+                                catalog_, decoded ) );
+  QVERIFY( !decode_copy_object( single_run_payload_( 4, 0, 1, 1, 0, 1 ),
+                                catalog_, decoded ) );
+}
+
+
+
+//-------------------------------------------------------------
+// the tables are indexed by quint16 so the encoder has to give
+// up if there are more distinct colors than that
+//-------------------------------------------------------------
+void ChartClipboardTest::encoder_refuses_oversized_tables()
+{
+  CopyObject cells;
+  cells.width = 65537;
+  cells.height = 1;
+  for ( int col = 0; col < cells.width; ++col ) {
+    add_cell( cells, knit_, QColor( QRgb( col ) ), col, 0 );
+  }
+
+  QVERIFY( encode_copy_object( cells ).isEmpty() );
+
+  cells.runs.remove( cells.runs.size() - 1 );
+  cells.width = 65536;
+  QVERIFY( !encode_copy_object( cells ).isEmpty() );
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// two rows: knit, cable, knit and a row of knits in two colors
+//-------------------------------------------------------------
+CopyObject ChartClipboardTest::sample_cells_() const
+{
+  CopyObject cells;
+  cells.width = 5;
+  cells.height = 2;
+
+  add_cell( cells, knit_, Qt::white, 0, 0 );
+  add_cell( cells, cable_, Qt::red, 1, 0 );
+  add_cell( cells, knit_, Qt::white, 4, 0 );
+
+  add_cell( cells, knit_, Qt::white, 0, 1 );
+  add_cell( cells, knit_, Qt::white, 1, 1 );
+  add_cell( cells, knit_, Qt::blue, 2, 1 );
+  add_cell( cells, knit_, Qt::blue, 3, 1 );
+  add_cell( cells, knit_, Qt::white, 4, 1 );
+
+  return cells;
+}
+
+
+
+//-------------------------------------------------------------
+// assemble a payload by hand so we can put anything we like
+// into the run
+//-------------------------------------------------------------
+QByteArray ChartClipboardTest::single_run_payload_( qint32 width,
+    qint32 column, qint32 count, qint32 runWidth, quint16 symbolIndex,
+    quint16 colorIndex ) const
+{
+  QByteArray data;
+  QDataStream out( &data, QIODevice::WriteOnly );
+  out.setVersion( QDataStream::Qt_4_5 );
+
+  out << CHART_CELLS_MAGIC << CHART_CELLS_VERSION
+      << width << qint32( 1 );
+  out << qint32( 1 ) << QString( "test" ) << QString( "knit" );
+  out << qint32( 1 ) << quint32( QColor( Qt::white ).rgb() );
+  out << qint32( 1 ) << column << count << runWidth
+      << symbolIndex << colorIndex;
+
+  return data;
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,86 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef CHART_CLIPBOARD_TEST_H
+#define CHART_CLIPBOARD_TEST_H
+
+/* QT includes */
+#include <QByteArray>
+#include <QObject>
+
+/* local includes */
+#include "chartClipboard.h"
+#include "symbolCatalog.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/***************************************************************
+ *
+ * ChartClipboardTest checks the clipboard payload codec, in
+ * particular that corrupt or hostile payloads are rejected
+ * instead of being turned into chart cells
+ *
+ ***************************************************************/
+class ChartClipboardTest
+    :
+    public QObject
+{
+
+  Q_OBJECT
+
+
+private slots:
+
+  void initTestCase();
+  void round_trip();
+  void identical_cells_form_runs();
+  void rejects_garbage();
+  void rejects_truncated_payload();
+  void rejects_unknown_symbol();
+  void rejects_runs_outside_of_row();
+  void rejects_oversized_payload();
+  void rejects_invalid_table_indices();
+  void encoder_refuses_oversized_tables();
+
+
+private:
+
+  SymbolCatalog catalog_;
+  KnittingSymbolPtr knit_;
+  KnittingSymbolPtr cable_;
+
+  /* a small copy object using both of our symbols */
+  CopyObject sample_cells_() const;
+
+  /* a payload of a single row width cells wide holding one
+   * run; the symbol and color tables have one entry each */
+  QByteArray single_run_payload_( qint32 width, qint32 column,
+                                  qint32 count, qint32 runWidth,
+                                  quint16 symbolIndex,
+                                  quint16 colorIndex ) const;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
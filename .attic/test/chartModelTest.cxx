@@ -0,0 +1,247 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QColor>
+#include <QtTest>
+
+/* local headers */
+#include "chartModel.h"
+#include "chartModelTest.h"
+#include "testHelpers.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/**************************************************************
+ *
+ * PRIVATE SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// symbols shared by all tests
+//-------------------------------------------------------------
+void ChartModelTest::initTestCase()
+{
+  knit_ = make_test_symbol( "knit" );
+  cable_ = make_test_symbol( "cable", 3 );
+}
+
+
+
+//-------------------------------------------------------------
+// a fresh chart consists of empty unit cells
+//-------------------------------------------------------------
+void ChartModelTest::new_chart_is_empty()
+{
+  ChartModel chart( 4, 3 );
+  QVERIFY( chart.Init() );
+
+  QCOMPARE( chart.num_columns(), 4 );
+  QCOMPARE( chart.num_rows(), 3 );
+  QVERIFY( chart.contains( 3, 2 ) );
+  QVERIFY( !chart.contains( 4, 0 ) );
+  QVERIFY( !chart.contains( 0, -1 ) );
+
+  for ( int row = 0; row < 3; ++row ) {
+    for ( int col = 0; col < 4; ++col ) {
+      QVERIFY( chart.is_empty( col, row ) );
+      QCOMPARE( chart.width( col, row ), 1 );
+      QCOMPARE( chart.color_index( col, row ), 0 );
+    }
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// every unit cell covered by a wide chart cell reports the
+// origin, width, symbol and color of the latter
+//-------------------------------------------------------------
+void ChartModelTest::wide_cells_span_unit_cells()
+{
+  ChartModel chart( 6, 1 );
+  chart.set_cell( 0, 0, 1, knit_, Qt::white );
+  chart.set_cell( 1, 0, 3, cable_, Qt::red );
+
+  for ( int col = 1; col < 4; ++col ) {
+    QCOMPARE( chart.origin_column( col, 0 ), 1 );
+    QCOMPARE( chart.width( col, 0 ), 3 );
+    QVERIFY( chart.symbol( col, 0 ) == cable_ );
+    QCOMPARE( chart.color( col, 0 ), QColor( Qt::red ).rgb() );
+    QVERIFY( !chart.is_empty( col, 0 ) );
+  }
+
+  QCOMPARE( chart.origin_column( 0, 0 ), 0 );
+  QVERIFY( chart.symbol( 0, 0 ) == knit_ );
+  QCOMPARE( chart.origin_column( 4, 0 ), 4 );
+  QVERIFY( chart.is_empty( 4, 0 ) );
+}
+
+
+
+//-------------------------------------------------------------
+// clearing any unit cell of a wide cell clears all of it
+//-------------------------------------------------------------
+void ChartModelTest::clear_cell_leaves_empty_unit_cells()
+{
+  ChartModel chart( 5, 1 );
+  chart.set_cell( 1, 0, 3, cable_, Qt::red );
+  chart.clear_cell( 2, 0 );
+
+  for ( int col = 0; col < 5; ++col ) {
+    QVERIFY( chart.is_empty( col, 0 ) );
+    QCOMPARE( chart.origin_column( col, 0 ), col );
+    QCOMPARE( chart.width( col, 0 ), 1 );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// replacing a color nobody else uses is a single palette edit
+//-------------------------------------------------------------
+void ChartModelTest::replace_color_edits_palette()
+{
+  ChartModel chart( 3, 1 );
+  chart.set_cell( 0, 0, 1, knit_, Qt::red );
+  chart.set_cell( 1, 0, 1, knit_, Qt::red );
+  chart.set_cell( 2, 0, 1, knit_, Qt::blue );
+  int paletteSize = chart.palette().size();
+
+  chart.replace_color( Qt::red, Qt::green );
+
+  QCOMPARE( chart.palette().size(), paletteSize );
+  QCOMPARE( chart.color( 0, 0 ), QColor( Qt::green ).rgb() );
+  QCOMPARE( chart.color( 1, 0 ), QColor( Qt::green ).rgb() );
+  QCOMPARE( chart.color( 2, 0 ), QColor( Qt::blue ).rgb() );
+}
+
+
+
+//-------------------------------------------------------------
+// replacing a color by one already in use moves the cells over
+// so palette entries stay unique
+//-------------------------------------------------------------
+void ChartModelTest::replace_color_merges_into_existing_color()
+{
+  ChartModel chart( 2, 1 );
+  chart.set_cell( 0, 0, 1, knit_, Qt::red );
+  chart.set_cell( 1, 0, 1, knit_, Qt::blue );
+
+  chart.replace_color( Qt::red, Qt::blue );
+
+  QCOMPARE( chart.color( 0, 0 ), QColor( Qt::blue ).rgb() );
+  QCOMPARE( chart.color_index( 0, 0 ), chart.color_index( 1, 0 ) );
+}
+
+
+
+//-------------------------------------------------------------
+// palette ids of colors that are gone from the chart are
+// handed out again instead of growing the palette
+//-------------------------------------------------------------
+void ChartModelTest::unused_colors_are_recycled()
+{
+  ChartModel chart( 2, 2 );
+  chart.set_cell( 0, 0, 1, knit_, Qt::red );
+  int paletteSize = chart.palette().size();
+
+  /* the new color is interned before the old one is released
+   * so recoloring a cell takes one spare id at most */
+  for ( int shade = 0; shade < 100; ++shade ) {
+    chart.set_color( 0, 0, QColor( shade, 0, 0 ) );
+  }
+  QVERIFY( chart.palette().size() <= paletteSize + 1 );
+  paletteSize = chart.palette().size();
+
+  chart.set_cell( 0, 1, 2, knit_, Qt::blue );
+  chart.replace_color( Qt::blue, QColor( 99, 0, 0 ) );
+  chart.delete_rows( 0, 1 );
+  chart.clear_cell( 0, 0 );
+  chart.set_cell( 1, 0, 1, knit_, Qt::green );
+  QCOMPARE( chart.palette().size(), paletteSize );
+  QCOMPARE( chart.color( 1, 0 ), QColor( Qt::green ).rgb() );
+  QCOMPARE( chart.color( 0, 0 ), QColor( Qt::white ).rgb() );
+}
+
+
+
+//-------------------------------------------------------------
+// rows move as a whole and inserted rows are empty
+//-------------------------------------------------------------
+void ChartModelTest::insert_and_delete_rows()
+{
+  ChartModel chart( 4, 2 );
+  chart.set_cell( 1, 1, 3, cable_, Qt::red );
+
+  chart.insert_rows( 0, 2 );
+  QCOMPARE( chart.num_rows(), 4 );
+  QCOMPARE( chart.origin_column( 2, 3 ), 1 );
+  QVERIFY( chart.symbol( 3, 3 ) == cable_ );
+  QVERIFY( chart.is_empty( 1, 0 ) );
+  QVERIFY( chart.is_empty( 1, 1 ) );
+
+  chart.delete_rows( 0, 3 );
+  QCOMPARE( chart.num_rows(), 1 );
+  QCOMPARE( chart.width( 2, 0 ), 3 );
+  QVERIFY( chart.symbol( 1, 0 ) == cable_ );
+}
+
+
+
+//-------------------------------------------------------------
+// wide cells keep their span when columns are added or removed
+// next to them
+//-------------------------------------------------------------
+void ChartModelTest::insert_and_delete_columns()
+{
+  ChartModel chart( 5, 2 );
+  chart.set_cell( 1, 0, 3, cable_, Qt::red );
+
+  QVERIFY( chart.is_column_boundary( 0 ) );
+  QVERIFY( chart.is_column_boundary( 1 ) );
+  QVERIFY( !chart.is_column_boundary( 2 ) );
+  QVERIFY( chart.is_column_boundary( 4 ) );
+  QVERIFY( chart.is_column_boundary( 5 ) );
+  QVERIFY( !chart.is_unit_column( 2 ) );
+  QVERIFY( chart.is_unit_column( 4 ) );
+
+  chart.insert_columns( 1, 2 );
+  QCOMPARE( chart.num_columns(), 7 );
+  QVERIFY( chart.is_empty( 1, 0 ) );
+  QVERIFY( chart.is_empty( 2, 0 ) );
+  QCOMPARE( chart.origin_column( 5, 0 ), 3 );
+  QCOMPARE( chart.width( 5, 0 ), 3 );
+
+  chart.delete_columns( 0, 3 );
+  QCOMPARE( chart.num_columns(), 4 );
+  QCOMPARE( chart.origin_column( 2, 0 ), 0 );
+  QVERIFY( chart.symbol( 0, 0 ) == cable_ );
+  QVERIFY( chart.is_empty( 3, 0 ) );
+  QVERIFY( chart.is_empty( 0, 1 ) );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,72 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef CHART_MODEL_TEST_H
+#define CHART_MODEL_TEST_H
+
+/* QT includes */
+#include <QObject>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/***************************************************************
+ *
+ * ChartModelTest checks the cell bookkeeping of ChartModel,
+ * i.e., spans of wide cells, the color palette and structural
+ * changes of the grid
+ *
+ ***************************************************************/
+class ChartModelTest
+    :
+    public QObject
+{
+
+  Q_OBJECT
+
+
+private slots:
+
+  void initTestCase();
+  void new_chart_is_empty();
+  void wide_cells_span_unit_cells();
+  void clear_cell_leaves_empty_unit_cells();
+  void replace_color_edits_palette();
+  void replace_color_merges_into_existing_color();
+  void unused_colors_are_recycled();
+  void insert_and_delete_rows();
+  void insert_and_delete_columns();
+
+
+private:
+
+  KnittingSymbolPtr knit_;
+  KnittingSymbolPtr cable_;
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,217 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QRect>
+#include <QtTest>
+
+/* local headers */
+#include "chartModel.h"
+#include "chartSelection.h"
+#include "chartSelectionTest.h"
+#include "testHelpers.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+namespace
+{
+//-------------------------------------------------------------
+// shorthand for the expected runs of a row
+//-------------------------------------------------------------
+SelectionRuns runs( int first, int count )
+{
+  SelectionRuns result;
+  result.push_back( SelectionRun( first, count ) );
+  return result;
+}
+
+
+SelectionRuns runs( int first, int count, int second, int secondCount )
+{
+  SelectionRuns result( runs( first, count ) );
+  result.push_back( SelectionRun( second, secondCount ) );
+  return result;
+}
+};
+
+
+
+/**************************************************************
+ *
+ * PRIVATE SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// two selections touching each other end up as one run
+//-------------------------------------------------------------
+void ChartSelectionTest::adjacent_runs_are_merged()
+{
+  ChartModel chart( 10, 3 );
+  ChartSelection selection( chart );
+  QVERIFY( selection.Init() );
+
+  selection.select_rectangle( 0, 0, 2, 0 );
+  selection.select_rectangle( 3, 0, 5, 0 );
+
+  QVERIFY( selection.row_runs( 0 ) == runs( 0, 6 ) );
+  QCOMPARE( selection.num_cells(), 6 );
+  QVERIFY( selection.row_runs( 1 ).empty() );
+}
+
+
+
+//-------------------------------------------------------------
+// overlapping selections are only counted once
+//-------------------------------------------------------------
+void ChartSelectionTest::overlapping_runs_are_merged()
+{
+  ChartModel chart( 10, 1 );
+  ChartSelection selection( chart );
+
+  selection.select_rectangle( 1, 0, 4, 0 );
+  selection.select_rectangle( 7, 0, 8, 0 );
+  QVERIFY( selection.row_runs( 0 ) == runs( 1, 4, 7, 2 ) );
+
+  selection.select_rectangle( 3, 0, 7, 0 );
+  QVERIFY( selection.row_runs( 0 ) == runs( 1, 8 ) );
+  QCOMPARE( selection.num_cells(), 8 );
+}
+
+
+
+//-------------------------------------------------------------
+// deselecting the middle of a run leaves two runs behind
+//-------------------------------------------------------------
+void ChartSelectionTest::deselect_splits_run()
+{
+  ChartModel chart( 10, 1 );
+  ChartSelection selection( chart );
+
+  selection.select_row( 0 );
+  selection.select_rectangle( 4, 0, 4, 0, ChartSelection::Deselect );
+
+  QVERIFY( selection.row_runs( 0 ) == runs( 0, 4, 5, 5 ) );
+  QCOMPARE( selection.num_cells(), 9 );
+  QVERIFY( !selection.is_selected( 4, 0 ) );
+  QVERIFY( selection.is_selected( 5, 0 ) );
+}
+
+
+
+//-------------------------------------------------------------
+// toggling deselects what was selected and vice versa
+//-------------------------------------------------------------
+void ChartSelectionTest::toggle_flips_overlap()
+{
+  ChartModel chart( 10, 1 );
+  ChartSelection selection( chart );
+
+  selection.select_rectangle( 0, 0, 4, 0 );
+  selection.select_rectangle( 2, 0, 6, 0, ChartSelection::Toggle );
+
+  QVERIFY( selection.row_runs( 0 ) == runs( 0, 2, 5, 2 ) );
+  QCOMPARE( selection.num_cells(), 4 );
+
+  selection.toggle_cell( 2, 0 );
+  selection.toggle_cell( 3, 0 );
+  selection.toggle_cell( 4, 0 );
+  QVERIFY( selection.row_runs( 0 ) == runs( 0, 7 ) );
+}
+
+
+
+//-------------------------------------------------------------
+// touching a single unit cell of a wide chart cell selects
+// all of it
+//-------------------------------------------------------------
+void ChartSelectionTest::rectangles_cover_whole_chart_cells()
+{
+  ChartModel chart( 8, 2 );
+  chart.set_cell( 2, 1, 3, make_test_symbol( "cable", 3 ), Qt::white );
+  ChartSelection selection( chart );
+
+  selection.select_rectangle( 3, 0, 3, 1 );
+
+  QVERIFY( selection.row_runs( 0 ) == runs( 3, 1 ) );
+  QVERIFY( selection.row_runs( 1 ) == runs( 2, 3 ) );
+  QCOMPARE( selection.num_cells(), 4 );
+
+  QRect bounds;
+  QVERIFY( !selection.bounding_rectangle( bounds ) );
+}
+
+
+
+//-------------------------------------------------------------
+// the bounding rectangle only exists for rectangular
+// selections
+//-------------------------------------------------------------
+void ChartSelectionTest::bounding_rectangle()
+{
+  ChartModel chart( 10, 4 );
+  ChartSelection selection( chart );
+
+  QRect bounds;
+  QVERIFY( !selection.bounding_rectangle( bounds ) );
+
+  selection.select_rectangle( 1, 1, 3, 3 );
+  QVERIFY( selection.bounding_rectangle( bounds ) );
+  QCOMPARE( bounds, QRect( 1, 1, 3, 3 ) );
+
+  selection.toggle_cell( 8, 2 );
+  QVERIFY( !selection.bounding_rectangle( bounds ) );
+}
+
+
+
+//-------------------------------------------------------------
+// inverting a full selection leaves nothing selected
+//-------------------------------------------------------------
+void ChartSelectionTest::select_all_and_invert()
+{
+  ChartModel chart( 10, 3 );
+  ChartSelection selection( chart );
+
+  selection.select_column( 4 );
+  QCOMPARE( selection.num_cells(), 3 );
+
+  selection.invert();
+  QCOMPARE( selection.num_cells(), 27 );
+  QVERIFY( selection.row_runs( 2 ) == runs( 0, 4, 5, 5 ) );
+
+  selection.select_all();
+  QCOMPARE( selection.num_cells(), 30 );
+
+  selection.invert();
+  QVERIFY( selection.is_empty() );
+
+  selection.select_row( 1 );
+  selection.clear();
+  QVERIFY( selection.is_empty() );
+  QVERIFY( selection.row_runs( 1 ).empty() );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,60 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef CHART_SELECTION_TEST_H
+#define CHART_SELECTION_TEST_H
+
+/* QT includes */
+#include <QObject>
+
+
+QT_BEGIN_NAMESPACE
+
+
+/***************************************************************
+ *
+ * ChartSelectionTest checks how ChartSelection combines the
+ * runs of selected cells within a row
+ *
+ ***************************************************************/
+class ChartSelectionTest
+    :
+    public QObject
+{
+
+  Q_OBJECT
+
+
+private slots:
+
+  void adjacent_runs_are_merged();
+  void overlapping_runs_are_merged();
+  void deselect_splits_run();
+  void toggle_flips_overlap();
+  void rectangles_cover_whole_chart_cells();
+  void bounding_rectangle();
+  void select_all_and_invert();
+};
+
+
+QT_END_NAMESPACE
+
+#endif
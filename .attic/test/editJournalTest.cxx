@@ -0,0 +1,257 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QtTest>
+
+/* local headers */
+#include "editJournalTest.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/**************************************************************
+ *
+ * PRIVATE SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// steps which don't change any cell never make it into the
+// history
+//-------------------------------------------------------------
+void EditJournalTest::unchanged_step_is_dropped()
+{
+  EditJournal journal;
+  QVERIFY( journal.Init() );
+
+  record_step_( journal, EditJournal::Unmergeable, 0, 2, 1, 1 );
+  QVERIFY( !journal.can_undo() );
+}
+
+
+
+//-------------------------------------------------------------
+// a quick repeat of the same kind of edit on the same cells
+// is undone together with the previous step
+//-------------------------------------------------------------
+void EditJournalTest::quick_repeats_are_merged()
+{
+  EditJournal journal;
+  record_step_( journal, EditJournal::Recolor, 0, 2, 1, 2 );
+  record_step_( journal, EditJournal::Recolor, 0, 2, 2, 3 );
+
+  QCOMPARE( num_undo_steps_( journal ), 1 );
+
+  /* the merged step goes from the state before the first
+   * to the state after the second step */
+  const JournalStep& step = journal.redo_step();
+  QCOMPARE( step.size(), 1 );
+  QCOMPARE( step.first().before.first().symbol, quint16( 1 ) );
+  QCOMPARE( step.first().after.first().symbol, quint16( 3 ) );
+}
+
+
+
+//-------------------------------------------------------------
+// steps of different kinds are kept apart
+//-------------------------------------------------------------
+void EditJournalTest::different_kinds_are_not_merged()
+{
+  EditJournal journal;
+  record_step_( journal, EditJournal::PlaceSymbol, 0, 2, 1, 2 );
+  record_step_( journal, EditJournal::Recolor, 0, 2, 2, 3 );
+
+  QCOMPARE( num_undo_steps_( journal ), 2 );
+}
+
+
+
+//-------------------------------------------------------------
+// unmergeable steps are never folded into each other
+//-------------------------------------------------------------
+void EditJournalTest::unmergeable_steps_are_not_merged()
+{
+  EditJournal journal;
+  record_step_( journal, EditJournal::Unmergeable, 0, 2, 1, 2 );
+  record_step_( journal, EditJournal::Unmergeable, 0, 2, 2, 3 );
+
+  QCOMPARE( num_undo_steps_( journal ), 2 );
+}
+
+
+
+//-------------------------------------------------------------
+// only steps touching the same cells are merged
+//-------------------------------------------------------------
+void EditJournalTest::different_cells_are_not_merged()
+{
+  EditJournal journal;
+  record_step_( journal, EditJournal::PlaceSymbol, 0, 2, 1, 2 );
+  record_step_( journal, EditJournal::PlaceSymbol, 1, 2, 1, 2 );
+  record_step_( journal, EditJournal::PlaceSymbol, 1, 3, 1, 2 );
+
+  QCOMPARE( num_undo_steps_( journal ), 3 );
+}
+
+
+
+//-------------------------------------------------------------
+// steps further apart than the merge interval are kept apart
+//-------------------------------------------------------------
+void EditJournalTest::slow_repeats_are_not_merged()
+{
+  EditJournal journal;
+  journal.set_merge_interval( -1 );
+  record_step_( journal, EditJournal::Recolor, 0, 2, 1, 2 );
+  record_step_( journal, EditJournal::Recolor, 0, 2, 2, 3 );
+
+  QCOMPARE( num_undo_steps_( journal ), 2 );
+}
+
+
+
+//-------------------------------------------------------------
+// a step following an undo/redo starts a new step
+//-------------------------------------------------------------
+void EditJournalTest::undo_stops_merging()
+{
+  EditJournal journal;
+  record_step_( journal, EditJournal::Recolor, 0, 2, 1, 2 );
+  journal.undo_step();
+  journal.redo_step();
+  record_step_( journal, EditJournal::Recolor, 0, 2, 2, 3 );
+
+  QCOMPARE( num_undo_steps_( journal ), 2 );
+}
+
+
+
+//-------------------------------------------------------------
+// recording a step after an undo invalidates the redo steps
+//-------------------------------------------------------------
+void EditJournalTest::new_step_drops_redo_steps()
+{
+  EditJournal journal;
+  record_step_( journal, EditJournal::Unmergeable, 0, 1, 1, 2 );
+  record_step_( journal, EditJournal::Unmergeable, 1, 1, 1, 2 );
+  journal.undo_step();
+  QVERIFY( journal.can_redo() );
+
+  record_step_( journal, EditJournal::Unmergeable, 2, 1, 1, 2 );
+  QVERIFY( !journal.can_redo() );
+  QCOMPARE( num_undo_steps_( journal ), 2 );
+}
+
+
+
+//-------------------------------------------------------------
+// once the budget is exceeded the oldest steps are dropped
+//-------------------------------------------------------------
+void EditJournalTest::budget_drops_oldest_steps()
+{
+  const int numCells = 100;
+  const int stepSize = sizeof( JournalOp )
+                       + 2 * numCells * sizeof( JournalCell );
+  const int budget = 8;
+
+  EditJournal journal;
+  journal.set_budget( budget );
+  for ( int row = 0; row < 10; ++row ) {
+    record_step_( journal, EditJournal::Unmergeable, row, numCells, 1, 2 );
+  }
+
+  QCOMPARE( num_undo_steps_( journal ), ( budget * 1024 ) / stepSize );
+
+  /* the most recent steps survive */
+  const JournalStep& step = journal.redo_step();
+  QCOMPARE( step.first().row, 10 - ( budget * 1024 ) / stepSize );
+}
+
+
+
+//-------------------------------------------------------------
+// a single step larger than the whole budget is still kept
+//-------------------------------------------------------------
+void EditJournalTest::budget_keeps_most_recent_step()
+{
+  EditJournal journal;
+  journal.set_budget( 1 );
+  record_step_( journal, EditJournal::Unmergeable, 0, 1000, 1, 2 );
+  record_step_( journal, EditJournal::Unmergeable, 1, 1000, 1, 2 );
+
+  QCOMPARE( num_undo_steps_( journal ), 1 );
+  QCOMPARE( journal.redo_step().first().row, 1 );
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// record a step consisting of a single cell op
+//-------------------------------------------------------------
+void EditJournalTest::record_step_( EditJournal& journal,
+                                    EditJournal::StepKind kind,
+                                    int row, int count, quint16 before,
+                                    quint16 after )
+{
+  JournalCell beforeCell = { 1, before, 0xffffffff };
+  JournalCell afterCell = { 1, after, 0xffffffff };
+
+  JournalOp op;
+  op.type = JournalOp::Cells;
+  op.row = row;
+  op.column = 0;
+  op.count = count;
+  op.before = JournalCells( count, beforeCell );
+  op.after = JournalCells( count, afterCell );
+
+  journal.begin_step( kind );
+  journal.add_op( op );
+  journal.end_step();
+}
+
+
+
+//-------------------------------------------------------------
+// undo all steps and count them. Afterwards everything can be
+// redone again.
+//-------------------------------------------------------------
+int EditJournalTest::num_undo_steps_( EditJournal& journal )
+{
+  int numSteps = 0;
+  while ( journal.can_undo() ) {
+    journal.undo_step();
+    ++numSteps;
+  }
+
+  return numSteps;
+}
+
+
+
+QT_END_NAMESPACE
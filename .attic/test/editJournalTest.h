@@ -0,0 +1,77 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef EDIT_JOURNAL_TEST_H
+#define EDIT_JOURNAL_TEST_H
+
+/* QT includes */
+#include <QObject>
+
+/* local includes */
+#include "editJournal.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/***************************************************************
+ *
+ * EditJournalTest checks when EditJournal merges steps and
+ * how it keeps the history within its memory budget
+ *
+ ***************************************************************/
+class EditJournalTest
+    :
+    public QObject
+{
+
+  Q_OBJECT
+
+
+private slots:
+
+  void unchanged_step_is_dropped();
+  void quick_repeats_are_merged();
+  void different_kinds_are_not_merged();
+  void unmergeable_steps_are_not_merged();
+  void different_cells_are_not_merged();
+  void slow_repeats_are_not_merged();
+  void undo_stops_merging();
+  void new_step_drops_redo_steps();
+  void budget_drops_oldest_steps();
+  void budget_keeps_most_recent_step();
+
+
+private:
+
+  /* record a step changing count cells of row from symbol
+   * before to symbol after */
+  void record_step_( EditJournal& journal, EditJournal::StepKind kind,
+                     int row, int count, quint16 before, quint16 after );
+
+  /* number of steps that can be undone */
+  int num_undo_steps_( EditJournal& journal );
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,131 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QGraphicsRectItem>
+#include <QPen>
+#include <QtTest>
+
+/* local headers */
+#include "floatingItemIndex.h"
+#include "floatingItemIndexTest.h"
+#include "patternGridRectangle.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/**************************************************************
+ *
+ * PRIVATE SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// items are reported topmost first, by z value and then by
+// insertion order
+//-------------------------------------------------------------
+void FloatingItemIndexTest::topmost_item_comes_first()
+{
+  QGraphicsRectItem bottom( QRectF( 0, 0, 10, 10 ) );
+  QGraphicsRectItem middle( QRectF( 0, 0, 10, 10 ) );
+  QGraphicsRectItem top( QRectF( 0, 0, 10, 10 ) );
+  top.setZValue( 1.0 );
+
+  FloatingItemIndex index;
+  index.insert( &top );
+  index.insert( &bottom );
+  index.insert( &middle );
+
+  QList<QGraphicsItem*> hits = index.items_at( QPointF( 5, 5 ) );
+  QCOMPARE( hits.size(), 3 );
+  QVERIFY( hits.at( 0 ) == &top );
+  QVERIFY( hits.at( 1 ) == &middle );
+  QVERIFY( hits.at( 2 ) == &bottom );
+  QVERIFY( index.item_at( QPointF( 5, 5 ) ) == &top );
+
+  QVERIFY( index.items_at( QPointF( 20, 5 ) ).isEmpty() );
+  QVERIFY( index.item_at( QPointF( 20, 5 ) ) == 0 );
+}
+
+
+
+//-------------------------------------------------------------
+// hidden legend items don't get in the way of anything
+//-------------------------------------------------------------
+void FloatingItemIndexTest::hidden_items_are_skipped()
+{
+  QGraphicsRectItem anItem( QRectF( 0, 0, 10, 10 ) );
+  anItem.hide();
+
+  FloatingItemIndex index;
+  index.insert( &anItem );
+  QVERIFY( index.item_at( QPointF( 5, 5 ) ) == 0 );
+
+  anItem.show();
+  QVERIFY( index.item_at( QPointF( 5, 5 ) ) == &anItem );
+}
+
+
+
+//-------------------------------------------------------------
+// only the line of a marker rectangle counts as a hit so the
+// cells inside stay clickable
+//-------------------------------------------------------------
+void FloatingItemIndexTest::rectangles_are_hit_on_their_line_only()
+{
+  PatternGridRectangle marker( QRectF( 10, 10, 100, 100 ),
+                               QPen( Qt::red, 4.0 ) );
+  QVERIFY( marker.Init() );
+
+  FloatingItemIndex index;
+  index.insert( &marker );
+
+  QVERIFY( index.item_at( QPointF( 10, 50 ) ) == &marker );
+  QVERIFY( index.item_at( QPointF( 50, 111 ) ) == &marker );
+  QVERIFY( index.item_at( QPointF( 50, 50 ) ) == 0 );
+  QVERIFY( index.item_at( QPointF( 20, 20 ) ) == 0 );
+}
+
+
+
+//-------------------------------------------------------------
+// removed items are never reported again
+//-------------------------------------------------------------
+void FloatingItemIndexTest::removed_items_are_forgotten()
+{
+  QGraphicsRectItem first( QRectF( 0, 0, 10, 10 ) );
+  QGraphicsRectItem second( QRectF( 0, 0, 10, 10 ) );
+
+  FloatingItemIndex index;
+  index.insert( &first );
+  index.insert( &second );
+
+  index.remove( &second );
+  QVERIFY( index.item_at( QPointF( 5, 5 ) ) == &first );
+
+  index.clear();
+  QVERIFY( index.item_at( QPointF( 5, 5 ) ) == 0 );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,58 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef FLOATING_ITEM_INDEX_TEST_H
+#define FLOATING_ITEM_INDEX_TEST_H
+
+/* QT includes */
+#include <QObject>
+
+
+QT_BEGIN_NAMESPACE
+
+
+/***************************************************************
+ *
+ * FloatingItemIndexTest checks the point queries of
+ * FloatingItemIndex, in particular which items count as a
+ * hit
+ *
+ ***************************************************************/
+class FloatingItemIndexTest
+    :
+    public QObject
+{
+
+  Q_OBJECT
+
+
+private slots:
+
+  void topmost_item_comes_first();
+  void hidden_items_are_skipped();
+  void rectangles_are_hit_on_their_line_only();
+  void removed_items_are_forgotten();
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,531 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QApplication>
+#include <QDialog>
+#include <QFile>
+#include <QGraphicsSceneMouseEvent>
+#include <QRectF>
+#include <QSettings>
+#include <QTimer>
+#include <QtTest>
+
+/* local headers */
+#include "basicDefs.h"
+#include "chartModel.h"
+#include "chartSelection.h"
+#include "graphicsScene.h"
+#include "graphicsSceneTest.h"
+#include "legendItem.h"
+#include "patternGridItem.h"
+#include "settings.h"
+#include "testHelpers.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/**************************************************************
+ *
+ * PUBLIC SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// accept whatever modal dialog is up
+//-------------------------------------------------------------
+void GraphicsSceneTest::accept_modal_dialog()
+{
+  QDialog* dialog =
+    qobject_cast<QDialog*>( QApplication::activeModalWidget() );
+  if ( dialog != 0 ) {
+    dialog->accept();
+  }
+}
+
+
+
+/**************************************************************
+ *
+ * PRIVATE SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// set up the symbols and settings shared by all scenes
+//-------------------------------------------------------------
+void GraphicsSceneTest::initTestCase()
+{
+  load_test_symbols( catalog_ );
+  QVERIFY( catalog_.find( "basic", "knit", knit_ ) );
+  QVERIFY( catalog_.find( "basic", "purl", purl_ ) );
+  QVERIFY( catalog_.find( "3 stitch cables", "1 over 2 left", cable_ ) );
+
+  settingsFile_ = scratch_file( "scene_settings.ini" );
+  QFile::remove( settingsFile_ );
+  settings_ = new QSettings( settingsFile_, QSettings::IniFormat );
+  initialize_settings( *settings_ );
+  cellSize_ = extract_cell_dimensions_from_settings( *settings_ );
+}
+
+
+
+//-------------------------------------------------------------
+// remove everything we left behind
+//-------------------------------------------------------------
+void GraphicsSceneTest::cleanupTestCase()
+{
+  delete settings_;
+  QFile::remove( settingsFile_ );
+}
+
+
+
+//-------------------------------------------------------------
+// every test starts out with a fresh scene
+//-------------------------------------------------------------
+void GraphicsSceneTest::init()
+{
+  scene_ = new GraphicsScene( QPoint( 0, 0 ), QSize( 10, 10 ), *settings_,
+                              catalog_, knit_ );
+  QVERIFY( scene_->Init() );
+}
+
+
+
+//-------------------------------------------------------------
+// get rid of the scene of the previous test
+//-------------------------------------------------------------
+void GraphicsSceneTest::cleanup()
+{
+  delete scene_;
+  scene_ = 0;
+}
+
+
+
+//-------------------------------------------------------------
+// a plain left click toggles the cell under the mouse
+//-------------------------------------------------------------
+void GraphicsSceneTest::click_toggles_cell()
+{
+  click_( cell_center_( 2, 3 ) );
+  QVERIFY( scene_->selection().is_selected( 2, 3 ) );
+  QCOMPARE( scene_->selection().num_cells(), 1 );
+
+  click_( cell_center_( 2, 3 ) );
+  QVERIFY( scene_->selection().is_empty() );
+}
+
+
+
+//-------------------------------------------------------------
+// control and shift clicks belong to panning and the rubber
+// band
+//-------------------------------------------------------------
+void GraphicsSceneTest::modified_click_leaves_selection_alone()
+{
+  click_( cell_center_( 2, 3 ), Qt::ControlModifier );
+  click_( cell_center_( 4, 3 ), Qt::ShiftModifier );
+
+  QVERIFY( scene_->selection().is_empty() );
+}
+
+
+
+//-------------------------------------------------------------
+// the inside of a marker rectangle belongs to the cells
+// beneath
+//-------------------------------------------------------------
+void GraphicsSceneTest::click_inside_marker_rectangle_toggles_cell()
+{
+  scene_->select_region( QRectF( cell_center_( 1, 1 ),
+                                 cell_center_( 4, 4 ) ) );
+  QTimer::singleShot( 0, this, SLOT( accept_modal_dialog() ) );
+  scene_->mark_active_cells_with_rectangle();
+  QVERIFY( scene_->selection().is_empty() );
+
+  click_( cell_center_( 2, 2 ) );
+  QVERIFY( scene_->selection().is_selected( 2, 2 ) );
+
+  click_( cell_center_( 1, 4 ) );
+  QVERIFY( scene_->selection().is_selected( 1, 4 ) );
+  QCOMPARE( scene_->selection().num_cells(), 2 );
+}
+
+
+
+//-------------------------------------------------------------
+// a click on the line of a marker rectangle is meant for the
+// rectangle and leaves the cells alone
+//-------------------------------------------------------------
+void GraphicsSceneTest::click_on_marker_rectangle_line_is_left_to_rectangle()
+{
+  scene_->select_region( QRectF( cell_center_( 1, 1 ),
+                                 cell_center_( 4, 4 ) ) );
+  QTimer::singleShot( 0, this, SLOT( accept_modal_dialog() ) );
+  scene_->mark_active_cells_with_rectangle();
+  QVERIFY( scene_->selection().is_empty() );
+
+  /* left and top line of the rectangle */
+  click_( QPointF( cellSize_.width(), cell_center_( 2, 2 ).y() ) );
+  click_( QPointF( cell_center_( 3, 3 ).x(), cellSize_.height() ) );
+
+  QVERIFY( scene_->selection().is_empty() );
+}
+
+
+
+//-------------------------------------------------------------
+// legend items on top of the chart keep the click to
+// themselves
+//-------------------------------------------------------------
+void GraphicsSceneTest::click_on_legend_item_is_left_to_item()
+{
+  scene_->toggle_legend_visibility();
+  QMap<QString, LegendEntry> entries = scene_->get_legend_entries();
+  QVERIFY( !entries.isEmpty() );
+
+  LegendItem* legendItem = entries.begin().value().first;
+  legendItem->setPos( cell_center_( 6, 6 )
+                      - legendItem->boundingRect().center() );
+
+  click_( cell_center_( 6, 6 ) );
+  QVERIFY( scene_->selection().is_empty() );
+
+  /* once it moves out of the way the cell is clickable again */
+  legendItem->setPos( cell_center_( 20, 20 ) );
+  click_( cell_center_( 6, 6 ) );
+  QVERIFY( scene_->selection().is_selected( 6, 6 ) );
+}
+
+
+
+//-------------------------------------------------------------
+// placing symbols is undone and redone cell for cell
+//-------------------------------------------------------------
+void GraphicsSceneTest::undo_redo_symbol_placement()
+{
+  ChartModel before;
+  copy_chart( scene_->chart_model(), before );
+
+  place_( purl_, 2, 1, 4, 1 );
+  QVERIFY( scene_->chart_model().symbol( 3, 1 ) == purl_ );
+  ChartModel afterPurl;
+  copy_chart( scene_->chart_model(), afterPurl );
+
+  place_( cable_, 3, 2, 8, 2 );
+  QCOMPARE( scene_->chart_model().origin_column( 7, 2 ), 6 );
+  check_undo_redo_( afterPurl );
+
+  /* both placements are separate steps */
+  scene_->undo();
+  scene_->undo();
+  QVERIFY( same_chart( scene_->chart_model(), before ) );
+  scene_->redo();
+  QVERIFY( same_chart( scene_->chart_model(), afterPurl ) );
+}
+
+
+
+//-------------------------------------------------------------
+// a tiled paste is a single step
+//-------------------------------------------------------------
+void GraphicsSceneTest::undo_redo_paste()
+{
+  place_( purl_, 0, 0, 0, 0 );
+  place_( cable_, 1, 0, 3, 0 );
+
+  select_( 0, 0, 3, 0 );
+  QVERIFY( QMetaObject::invokeMethod( scene_, "copy_items_" ) );
+  scene_->deselect_all_active_items();
+
+  ChartModel before;
+  copy_chart( scene_->chart_model(), before );
+
+  select_( 0, 5, 7, 6 );
+  QVERIFY( QMetaObject::invokeMethod( scene_, "paste_items_tiled_" ) );
+
+  const ChartModel& chart = scene_->chart_model();
+  for ( int row = 5; row <= 6; ++row ) {
+    for ( int tile = 0; tile < 8; tile += 4 ) {
+      QVERIFY( chart.symbol( tile, row ) == purl_ );
+      QVERIFY( chart.symbol( tile + 2, row ) == cable_ );
+      QCOMPARE( chart.origin_column( tile + 3, row ), tile + 1 );
+    }
+  }
+  QVERIFY( chart.symbol( 8, 5 ) == knit_ );
+
+  check_undo_redo_( before );
+}
+
+
+
+//-------------------------------------------------------------
+// inserted rows go away on undo and the cells below move back
+//-------------------------------------------------------------
+void GraphicsSceneTest::undo_redo_row_insertion()
+{
+  place_( purl_, 2, 6, 2, 6 );
+  place_( cable_, 4, 8, 6, 8 );
+
+  ChartModel before;
+  copy_chart( scene_->chart_model(), before );
+
+  /* two rows above user row 5 */
+  QVERIFY( QMetaObject::invokeMethod( scene_, "insert_rows_",
+                                      Q_ARG( int, 2 ), Q_ARG( int, 5 ),
+                                      Q_ARG( int, 1 ) ) );
+  QCOMPARE( scene_->chart_model().num_rows(), 12 );
+
+  check_undo_redo_( before );
+  QCOMPARE( scene_->chart_model().num_rows(), 12 );
+}
+
+
+
+//-------------------------------------------------------------
+// undoing a column deletion brings back the deleted cells
+//-------------------------------------------------------------
+void GraphicsSceneTest::undo_redo_column_deletion()
+{
+  place_( purl_, 3, 1, 3, 1 );
+  place_( cable_, 5, 2, 7, 2 );
+
+  ChartModel before;
+  copy_chart( scene_->chart_model(), before );
+
+  /* user columns count from the right starting at 1 */
+  QVERIFY( QMetaObject::invokeMethod( scene_, "delete_column_",
+                                      Q_ARG( int, 10 - 3 ) ) );
+  QCOMPARE( scene_->chart_model().num_columns(), 9 );
+  QVERIFY( scene_->chart_model().symbol( 3, 1 ) == knit_ );
+  QCOMPARE( scene_->chart_model().origin_column( 5, 2 ), 4 );
+
+  check_undo_redo_( before );
+  QCOMPARE( scene_->chart_model().num_columns(), 9 );
+}
+
+
+
+//-------------------------------------------------------------
+// bulk edits pause the scene's item index; it has to be back
+// once they are done, whether they went through or not
+//-------------------------------------------------------------
+void GraphicsSceneTest::bulk_edits_restore_item_index()
+{
+  QGraphicsScene::ItemIndexMethod indexMethod = scene_->itemIndexMethod();
+
+  QVERIFY( QMetaObject::invokeMethod( scene_, "insert_rows_",
+                                      Q_ARG( int, 3 ), Q_ARG( int, 1 ),
+                                      Q_ARG( int, 0 ) ) );
+  QCOMPARE( scene_->itemIndexMethod(), indexMethod );
+
+  QVERIFY( QMetaObject::invokeMethod( scene_, "delete_column_",
+                                      Q_ARG( int, 4 ) ) );
+  QCOMPARE( scene_->itemIndexMethod(), indexMethod );
+
+  /* a deletion cutting through a wide cell is refused */
+  place_( cable_, 0, 0, 2, 0 );
+  QVERIFY( QMetaObject::invokeMethod( scene_, "delete_column_",
+                                      Q_ARG( int, 9 - 1 ) ) );
+  QCOMPARE( scene_->chart_model().num_columns(), 9 );
+  QCOMPARE( scene_->itemIndexMethod(), indexMethod );
+
+  scene_->undo();
+  scene_->undo();
+  QCOMPARE( scene_->itemIndexMethod(), indexMethod );
+}
+
+
+
+//-------------------------------------------------------------
+// legend updates are deferred to the end of a transaction but
+// then have to match the chart
+//-------------------------------------------------------------
+void GraphicsSceneTest::legend_follows_edits_and_undo()
+{
+  int numEntries = scene_->get_legend_entries().size();
+
+  place_( purl_, 0, 0, 9, 9 );
+  QCOMPARE( scene_->get_legend_entries().size(), 1 );
+
+  place_( cable_, 0, 3, 2, 3 );
+  QCOMPARE( scene_->get_legend_entries().size(), 2 );
+
+  scene_->undo();
+  QCOMPARE( scene_->get_legend_entries().size(), 1 );
+
+  scene_->undo();
+  QCOMPARE( scene_->get_legend_entries().size(), numEntries );
+
+  scene_->redo();
+  QCOMPARE( scene_->get_legend_entries().size(), 1 );
+}
+
+
+
+//-------------------------------------------------------------
+// cell items don't keep a color of their own but show the one
+// the chart model holds for them, through edits and undo
+//-------------------------------------------------------------
+void GraphicsSceneTest::cell_items_show_chart_colors()
+{
+  const ChartModel& chart = scene_->chart_model();
+
+  scene_->update_selected_background_color( Qt::red );
+  place_( purl_, 0, 0, 1, 0 );
+  QVERIFY( chart.item( 1, 0 ) != 0 );
+  QCOMPARE( chart.item( 1, 0 )->color(), QColor( Qt::red ) );
+
+  scene_->update_selected_background_color( Qt::blue );
+  place_( purl_, 1, 0, 1, 0 );
+  QCOMPARE( chart.item( 0, 0 )->color(), QColor( Qt::red ) );
+  QCOMPARE( chart.item( 1, 0 )->color(), QColor( Qt::blue ) );
+
+  scene_->undo();
+  QCOMPARE( chart.item( 1, 0 )->color(), QColor( Qt::red ) );
+}
+
+
+
+//-------------------------------------------------------------
+// charts above the threshold are drawn by a single grid item
+// instead of one item per cell but otherwise behave the same
+//-------------------------------------------------------------
+void GraphicsSceneTest::large_chart_uses_virtual_grid()
+{
+  const int numCols = 250;
+  const int numRows = 200;
+  QVERIFY( numCols * numRows > VIRTUAL_GRID_THRESHOLD );
+
+  scene_->reset_grid( QSize( numCols, numRows ) );
+  QCOMPARE( scene_->chart_model().num_columns(), numCols );
+  QCOMPARE( scene_->chart_model().num_rows(), numRows );
+  QVERIFY( scene_->items().size() < numCols * numRows / 10 );
+
+  click_( cell_center_( 200, 150 ) );
+  QVERIFY( scene_->selection().is_selected( 200, 150 ) );
+  scene_->deselect_all_active_items();
+
+  ChartModel before;
+  copy_chart( scene_->chart_model(), before );
+  place_( cable_, 100, 100, 108, 101 );
+  QCOMPARE( scene_->chart_model().origin_column( 107, 101 ), 106 );
+  check_undo_redo_( before );
+
+  /* back below the threshold every cell has its item again */
+  scene_->reset_grid( QSize( 10, 10 ) );
+  QVERIFY( scene_->items().size() >= 100 );
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// scene position of the center of a unit cell
+//-------------------------------------------------------------
+QPointF GraphicsSceneTest::cell_center_( int col, int row ) const
+{
+  return QPointF( ( col + 0.5 ) * cellSize_.width(),
+                  ( row + 0.5 ) * cellSize_.height() );
+}
+
+
+
+//-------------------------------------------------------------
+// select the given rectangle of cells (and nothing else)
+//-------------------------------------------------------------
+void GraphicsSceneTest::select_( int firstCol, int firstRow, int lastCol,
+                                 int lastRow )
+{
+  scene_->deselect_all_active_items();
+  scene_->select_region( QRectF( cell_center_( firstCol, firstRow ),
+                                 cell_center_( lastCol, lastRow ) ) );
+}
+
+
+
+//-------------------------------------------------------------
+// place symbol into the given rectangle of cells the way the
+// symbol selector does
+//-------------------------------------------------------------
+void GraphicsSceneTest::place_( KnittingSymbolPtr symbol, int firstCol,
+                                int firstRow, int lastCol, int lastRow )
+{
+  select_( firstCol, firstRow, lastCol, lastRow );
+  scene_->update_selected_symbol( symbol );
+  scene_->update_selected_symbol( emptyKnittingSymbol );
+  scene_->deselect_all_active_items();
+}
+
+
+
+//-------------------------------------------------------------
+// undo the most recent step, which has to restore before, and
+// redo it again, which has to restore the current chart
+//-------------------------------------------------------------
+void GraphicsSceneTest::check_undo_redo_( const ChartModel& before )
+{
+  ChartModel after;
+  copy_chart( scene_->chart_model(), after );
+
+  scene_->undo();
+  QVERIFY( same_chart( scene_->chart_model(), before ) );
+
+  scene_->redo();
+  QVERIFY( same_chart( scene_->chart_model(), after ) );
+}
+
+
+
+//-------------------------------------------------------------
+// press and release the left mouse button at pos
+//-------------------------------------------------------------
+void GraphicsSceneTest::click_( const QPointF& pos,
+                                Qt::KeyboardModifiers modifiers )
+{
+  QGraphicsSceneMouseEvent press( QEvent::GraphicsSceneMousePress );
+  press.setScenePos( pos );
+  press.setButtonDownScenePos( Qt::LeftButton, pos );
+  press.setButton( Qt::LeftButton );
+  press.setButtons( Qt::LeftButton );
+  press.setModifiers( modifiers );
+  QApplication::sendEvent( scene_, &press );
+
+  QGraphicsSceneMouseEvent release( QEvent::GraphicsSceneMouseRelease );
+  release.setScenePos( pos );
+  release.setButtonDownScenePos( Qt::LeftButton, pos );
+  release.setButton( Qt::LeftButton );
+  release.setButtons( Qt::NoButton );
+  release.setModifiers( modifiers );
+  QApplication::sendEvent( scene_, &release );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,112 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef GRAPHICS_SCENE_TEST_H
+#define GRAPHICS_SCENE_TEST_H
+
+/* QT includes */
+#include <QObject>
+#include <QPointF>
+#include <QSize>
+
+/* local includes */
+#include "knittingSymbol.h"
+#include "symbolCatalog.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* forward declarations */
+class ChartModel;
+class GraphicsScene;
+class QSettings;
+
+
+/***************************************************************
+ *
+ * GraphicsSceneTest drives a GraphicsScene the way the view
+ * does, i.e., via mouse events and the scene's slots, and
+ * checks the resulting chart and selection
+ *
+ ***************************************************************/
+class GraphicsSceneTest
+    :
+    public QObject
+{
+
+  Q_OBJECT
+
+
+public slots:
+
+  /* closes the modal dialog some scene slots open */
+  void accept_modal_dialog();
+
+
+private slots:
+
+  void initTestCase();
+  void cleanupTestCase();
+  void init();
+  void cleanup();
+  void click_toggles_cell();
+  void modified_click_leaves_selection_alone();
+  void click_inside_marker_rectangle_toggles_cell();
+  void click_on_marker_rectangle_line_is_left_to_rectangle();
+  void click_on_legend_item_is_left_to_item();
+  void undo_redo_symbol_placement();
+  void undo_redo_paste();
+  void undo_redo_row_insertion();
+  void undo_redo_column_deletion();
+  void bulk_edits_restore_item_index();
+  void legend_follows_edits_and_undo();
+  void cell_items_show_chart_colors();
+  void large_chart_uses_virtual_grid();
+
+
+private:
+
+  SymbolCatalog catalog_;
+  KnittingSymbolPtr knit_;
+  KnittingSymbolPtr purl_;
+  KnittingSymbolPtr cable_;
+  QSettings* settings_;
+  QString settingsFile_;
+  QSize cellSize_;
+
+  /* a fresh 10x10 scene for each test */
+  GraphicsScene* scene_;
+
+  /* helper functions */
+  QPointF cell_center_( int col, int row ) const;
+  void click_( const QPointF& pos,
+               Qt::KeyboardModifiers modifiers = Qt::NoModifier );
+  void select_( int firstCol, int firstRow, int lastCol, int lastRow );
+  void place_( KnittingSymbolPtr symbol, int firstCol, int firstRow,
+               int lastCol, int lastRow );
+  void check_undo_redo_( const ChartModel& before );
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,126 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QColor>
+#include <QSet>
+#include <QtTest>
+
+/* local headers */
+#include "legendKeyTable.h"
+#include "legendKeyTableTest.h"
+#include "testHelpers.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/**************************************************************
+ *
+ * PRIVATE SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// interning the same key twice returns the same id
+//-------------------------------------------------------------
+void LegendKeyTableTest::same_key_same_id()
+{
+  KnittingSymbolPtr knit = make_test_symbol( "knit" );
+  LegendKeyTable keys;
+
+  int id = keys.intern( knit, Qt::red, "chart" );
+  QCOMPARE( keys.intern( knit, Qt::red, "chart" ), id );
+  QCOMPARE( keys.intern( knit, QColor( 255, 0, 0 ), "chart" ), id );
+  QCOMPARE( keys.size(), 1 );
+}
+
+
+
+//-------------------------------------------------------------
+// changing any part of the key gives a new id
+//-------------------------------------------------------------
+void LegendKeyTableTest::keys_differ_by_symbol_color_and_tag()
+{
+  KnittingSymbolPtr knit = make_test_symbol( "knit" );
+  KnittingSymbolPtr purl = make_test_symbol( "purl" );
+  LegendKeyTable keys;
+
+  QSet<int> ids;
+  ids.insert( keys.intern( knit, Qt::red, "chart" ) );
+  ids.insert( keys.intern( purl, Qt::red, "chart" ) );
+  ids.insert( keys.intern( knit, Qt::blue, "chart" ) );
+  ids.insert( keys.intern( knit, Qt::red, "extra" ) );
+
+  QCOMPARE( ids.size(), 4 );
+  QCOMPARE( keys.size(), 4 );
+}
+
+
+
+//-------------------------------------------------------------
+// the accessors return the data an id was created from
+//-------------------------------------------------------------
+void LegendKeyTableTest::ids_map_back_to_their_key()
+{
+  KnittingSymbolPtr knit = make_test_symbol( "knit" );
+  KnittingSymbolPtr purl = make_test_symbol( "purl" );
+  LegendKeyTable keys;
+
+  int knitId = keys.intern( knit, Qt::red, "chart" );
+  int purlId = keys.intern( purl, Qt::blue, "extra" );
+
+  QVERIFY( keys.symbol( knitId ) == knit );
+  QCOMPARE( keys.color( knitId ), QColor( Qt::red ) );
+  QCOMPARE( keys.tag( knitId ), QString( "chart" ) );
+
+  QVERIFY( keys.symbol( purlId ) == purl );
+  QCOMPARE( keys.color( purlId ), QColor( Qt::blue ) );
+  QCOMPARE( keys.tag( purlId ), QString( "extra" ) );
+
+  QVERIFY( !keys.name( knitId ).isEmpty() );
+  QVERIFY( keys.name( knitId ) != keys.name( purlId ) );
+}
+
+
+
+//-------------------------------------------------------------
+// after clear() ids are handed out from scratch
+//-------------------------------------------------------------
+void LegendKeyTableTest::clear_forgets_all_ids()
+{
+  KnittingSymbolPtr knit = make_test_symbol( "knit" );
+  KnittingSymbolPtr purl = make_test_symbol( "purl" );
+  LegendKeyTable keys;
+
+  keys.intern( knit, Qt::red, "chart" );
+  keys.intern( purl, Qt::red, "chart" );
+  keys.clear();
+  QCOMPARE( keys.size(), 0 );
+
+  int purlId = keys.intern( purl, Qt::red, "chart" );
+  QCOMPARE( purlId, 0 );
+  QVERIFY( keys.symbol( purlId ) == purl );
+}
+
+
+
+QT_END_NAMESPACE
@@ -0,0 +1,57 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef LEGEND_KEY_TABLE_TEST_H
+#define LEGEND_KEY_TABLE_TEST_H
+
+/* QT includes */
+#include <QObject>
+
+
+QT_BEGIN_NAMESPACE
+
+
+/***************************************************************
+ *
+ * LegendKeyTableTest checks that LegendKeyTable hands out one
+ * id per (symbol, color, tag) combination
+ *
+ ***************************************************************/
+class LegendKeyTableTest
+    :
+    public QObject
+{
+
+  Q_OBJECT
+
+
+private slots:
+
+  void same_key_same_id();
+  void keys_differ_by_symbol_color_and_tag();
+  void ids_map_back_to_their_key();
+  void clear_forgets_all_ids();
+};
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,603 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/** boost headers */
+#include <boost/scoped_ptr.hpp>
+
+/* Qt headers */
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStringList>
+#include <QtEndian>
+#include <QtTest>
+
+/* local headers */
+#include "binaryProject.h"
+#include "chartModel.h"
+#include "graphicsScene.h"
+#include "projectFileTest.h"
+#include "projectFormat.h"
+#include "settings.h"
+#include "testConfig.h"
+#include "testHelpers.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+namespace
+{
+/* dimensions of the version 1 fixture */
+const int FIXTURE_COLUMNS = 5;
+const int FIXTURE_ROWS = 2;
+
+/* layout of the binary format as written by BinaryProjectWriter */
+const int BINARY_HEADER_SIZE = 8;
+const int BINARY_DIRECTORY_ENTRY_SIZE = 20;
+const int BINARY_CELL_RECORD_SIZE = 6;
+const int SYMBOL_FIELD = 0;
+const int WIDTH_FIELD = 4;
+
+
+//-------------------------------------------------------------
+// a version 2 project with a white color table, the given
+// symbol table entries and chart rows
+//-------------------------------------------------------------
+QByteArray v2_document( const QString& symbols, int numCols, int numRows,
+                        const QString& rows )
+{
+  return QString( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<sconcho version=\"2\">"
+                  "<cellColors><color>4294967295</color></cellColors>"
+                  "<symbolTable>%1</symbolTable>"
+                  "<chart columns=\"%2\" rows=\"%3\">%4</chart>"
+                  "</sconcho>" )
+         .arg( symbols ).arg( numCols ).arg( numRows ).arg( rows )
+         .toUtf8();
+}
+
+
+
+//-------------------------------------------------------------
+// a version 1 pattern grid item
+//-------------------------------------------------------------
+QString v1_item( int col, int row, int width, const QString& category,
+                 const QString& name )
+{
+  return QString( "<canvasItem><patternGridItem>"
+                  "<colIndex>%1</colIndex><rowIndex>%2</rowIndex>"
+                  "<width>%3</width><height>1</height>"
+                  "<backgroundColor>4294967295</backgroundColor>"
+                  "<patternCategory>%4</patternCategory>"
+                  "<patternName>%5</patternName>"
+                  "</patternGridItem></canvasItem>" )
+         .arg( col ).arg( row ).arg( width ).arg( category ).arg( name );
+}
+};
+
+
+
+/**************************************************************
+ *
+ * PRIVATE SLOTS
+ *
+ **************************************************************/
+
+//-------------------------------------------------------------
+// set up the symbols and a scene to save from
+//-------------------------------------------------------------
+void ProjectFileTest::initTestCase()
+{
+  load_test_symbols( catalog_ );
+  QVERIFY( catalog_.find( "basic", "knit", knit_ ) );
+  QVERIFY( catalog_.find( "3 stitch cables", "1 over 2 left", cable_ ) );
+
+  QString settingsFile = scratch_( "settings.ini" );
+  QFile::remove( settingsFile );
+  settings_ = new QSettings( settingsFile, QSettings::IniFormat );
+  initialize_settings( *settings_ );
+
+  scene_ = new GraphicsScene( QPoint( 0, 0 ), QSize( 10, 10 ), *settings_,
+                              catalog_, knit_ );
+  QVERIFY( scene_->Init() );
+
+  projectColors_.push_back( Qt::red );
+  projectColors_.push_back( Qt::blue );
+}
+
+
+
+//-------------------------------------------------------------
+// remove everything we left behind
+//-------------------------------------------------------------
+void ProjectFileTest::cleanupTestCase()
+{
+  delete scene_;
+  delete settings_;
+
+  foreach( QString fileName, scratchFiles_ ) {
+    QFile::remove( fileName );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// the items of version 1 files come in no particular order and
+// have to end up in the right cells
+//-------------------------------------------------------------
+void ProjectFileTest::reads_v1_fixture()
+{
+  boost::scoped_ptr<ProjectReader> reader(
+    open_( TEST_FILE_PATH + "/v1_chart.spf" ) );
+  QVERIFY( reader.get() != 0 );
+  QVERIFY( reader->read() );
+
+  const ChartModel& chart = reader->get_chart();
+  QCOMPARE( chart.num_columns(), FIXTURE_COLUMNS );
+  QCOMPARE( chart.num_rows(), FIXTURE_ROWS );
+
+  QVERIFY( chart.symbol( 0, 0 ) == knit_ );
+  for ( int col = 1; col < 4; ++col ) {
+    QVERIFY( chart.symbol( col, 0 ) == cable_ );
+    QCOMPARE( chart.origin_column( col, 0 ), 1 );
+    QCOMPARE( chart.width( col, 0 ), 3 );
+  }
+  QCOMPARE( chart.color( 4, 0 ), QColor( Qt::red ).rgb() );
+  QCOMPARE( chart.symbol( 2, 1 )->patternName(), QString( "yo" ) );
+  QCOMPARE( chart.color( 2, 1 ), QColor( Qt::blue ).rgb() );
+  QCOMPARE( chart.color( 3, 1 ), QColor( Qt::white ).rgb() );
+
+  QCOMPARE( reader->get_project_colors(), projectColors_ );
+}
+
+
+
+//-------------------------------------------------------------
+// version 1 items covering the same cell are rejected
+//-------------------------------------------------------------
+void ProjectFileTest::v1_items_must_not_overlap()
+{
+  QString fileName = scratch_( "overlap.spf" );
+  QString items = v1_item( 0, 0, 3, "3 stitch cables", "1 over 2 left" )
+                  + v1_item( 2, 0, 1, "basic", "knit" );
+  QVERIFY( write_file( fileName,
+                       QString( "<sconcho>%1</sconcho>" ).arg( items )
+                       .toUtf8() ) );
+  QVERIFY( !reads_( fileName ) );
+
+  items = v1_item( 0, 0, 3, "3 stitch cables", "1 over 2 left" )
+          + v1_item( 3, 0, 1, "basic", "knit" );
+  QVERIFY( write_file( fileName,
+                       QString( "<sconcho>%1</sconcho>" ).arg( items )
+                       .toUtf8() ) );
+  QVERIFY( reads_( fileName ) );
+}
+
+
+
+//-------------------------------------------------------------
+// version 1 items far outside any sensible chart, or items
+// spanning a chart too large to create, are rejected
+//-------------------------------------------------------------
+void ProjectFileTest::v1_rejects_oversized_charts()
+{
+  QString fileName = scratch_( "oversized.spf" );
+  QStringList badItems;
+  badItems
+    << v1_item( 2147483647, 0, 1, "basic", "knit" )
+    << v1_item( 2147483000, 0, 1000, "basic", "knit" )
+    << v1_item( 0, 2147483647, 1, "basic", "knit" )
+    << v1_item( 70000, 0, 1, "basic", "knit" )
+       + v1_item( 0, 70000, 1, "basic", "knit" );
+
+  foreach( QString items, badItems ) {
+    QVERIFY( write_file( fileName,
+                         QString( "<sconcho>%1</sconcho>" ).arg( items )
+                         .toUtf8() ) );
+    QVERIFY2( !reads_( fileName ), qPrintable( items ) );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// a version 1 chart saved again comes back as version 2 file
+// with the same cells
+//-------------------------------------------------------------
+void ProjectFileTest::xml_round_trip()
+{
+  load_v1_fixture_();
+
+  QString fileName = scratch_( "round_trip.spf" );
+  QVERIFY( save_( fileName ) );
+  QVERIFY( read_file( fileName ).contains( "<sconcho version=\"2\">" ) );
+
+  boost::scoped_ptr<ProjectReader> reader( open_( fileName ) );
+  QVERIFY( reader.get() != 0 );
+  QVERIFY( reader->read() );
+  QVERIFY( same_chart( reader->get_chart(), scene_->chart_model() ) );
+  QCOMPARE( reader->get_project_colors(), projectColors_ );
+}
+
+
+
+//-------------------------------------------------------------
+// version 2 charts have to be consistent with their symbol
+// table and dimensions; dimensions that are out of proportion
+// with the file are rejected before the chart is allocated
+//-------------------------------------------------------------
+void ProjectFileTest::xml_rejects_bad_charts()
+{
+  QString fileName = scratch_( "bad_chart.spf" );
+  QString knit( "<symbol category=\"basic\" name=\"knit\" width=\"1\"/>" );
+  QString cable( "<symbol category=\"3 stitch cables\" "
+                 "name=\"1 over 2 left\" width=\"3\"/>" );
+
+  /* the well-formed version of the documents below */
+  QVERIFY( write_file( fileName,
+                       v2_document( knit + cable, 4, 1, "<row>0 0 1 1 0 3</row>" ) ) );
+  QVERIFY( reads_( fileName ) );
+
+  QList<QByteArray> badDocuments;
+  badDocuments
+    << v2_document( "<symbol category=\"basic\" name=\"knit\" width=\"0\"/>",
+                    2, 1, "<row>0 0 2</row>" )
+    << v2_document( "<symbol category=\"basic\" name=\"nope\" width=\"1\"/>",
+                    2, 1, "<row>0 0 2</row>" )
+    << v2_document( knit, 2, 1, "<row>0 0 3</row>" )
+    << v2_document( knit, 2, 1, "<row>0 0 1</row>" )
+    << v2_document( knit, 2, 1, "<row>0 0</row>" )
+    << v2_document( knit, 2, 1, "<row>1 0 2</row>" )
+    << v2_document( knit, 2, 1, "<row>0 1 2</row>" )
+    << v2_document( knit, 2, 1, "<row>0 0 -2</row>" )
+    << v2_document( knit + cable, 4, 1, "<row>0 0 2 1 0 2</row>" )
+    << v2_document( knit, 2, 1, "<row>0 0 2</row><row>0 0 2</row>" )
+    << v2_document( knit, 2, 2, "<row>0 0 2</row>" )
+    << v2_document( knit, 0, 1, "<row></row>" )
+    << v2_document( knit, 70000, 70000, "<row>0 0 70000</row>" )
+    << v2_document( knit, 100000, 1000, "<row>0 0 100000</row>" )
+    << v2_document( knit, 1, 100000, "<row>0 0 1</row>" )
+    << QByteArray( "<sconcho version=\"2\"></sconcho>" );
+
+  foreach( QByteArray document, badDocuments ) {
+    QVERIFY( write_file( fileName, document ) );
+    QVERIFY2( !reads_( fileName ), document.constData() );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// binary files read back to the chart they were saved from
+//-------------------------------------------------------------
+void ProjectFileTest::binary_round_trip()
+{
+  load_v1_fixture_();
+
+  QString fileName = scratch_( "round_trip.sconchob" );
+  QVERIFY( save_( fileName ) );
+
+  boost::scoped_ptr<ProjectReader> reader( open_( fileName ) );
+  QVERIFY( reader.get() != 0 );
+  QVERIFY( reader->read() );
+  QVERIFY( same_chart( reader->get_chart(), scene_->chart_model() ) );
+  QCOMPARE( reader->get_project_colors(), projectColors_ );
+}
+
+
+
+//-------------------------------------------------------------
+// saving to an existing binary file with the same layout only
+// rewrites the sections that changed
+//-------------------------------------------------------------
+void ProjectFileTest::binary_rewrites_dirty_sections()
+{
+  load_v1_fixture_();
+
+  QString fileName = scratch_( "dirty.sconchob" );
+  QVERIFY( save_( fileName ) );
+  QByteArray original = read_file( fileName );
+
+  /* nothing changed, nothing to write */
+  QVERIFY( save_( fileName ) );
+  QVERIFY( read_file( fileName ) == original );
+
+  /* swapping two unit cells keeps the layout of all sections */
+  ChartModel changed;
+  copy_chart( scene_->chart_model(), changed );
+  KnittingSymbolPtr first = changed.symbol( 0, 1 );
+  KnittingSymbolPtr second = changed.symbol( 3, 1 );
+  QVERIFY( first != second );
+  changed.set_cell( 0, 1, 1, second, QColor( changed.color( 0, 1 ) ) );
+  changed.set_cell( 3, 1, 1, first, QColor( changed.color( 3, 1 ) ) );
+  scene_->load_new_canvas( changed );
+
+  QVERIFY( save_( fileName ) );
+  QByteArray updated = read_file( fileName );
+  QCOMPARE( updated.size(), original.size() );
+  QVERIFY( updated != original );
+
+  int headerSize = BINARY_HEADER_SIZE + 4 * BINARY_DIRECTORY_ENTRY_SIZE;
+  QVERIFY( updated.left( headerSize ) == original.left( headerSize ) );
+
+  boost::scoped_ptr<ProjectReader> reader( open_( fileName ) );
+  QVERIFY( reader.get() != 0 );
+  QVERIFY( reader->read() );
+  QVERIFY( same_chart( reader->get_chart(), changed ) );
+}
+
+
+
+//-------------------------------------------------------------
+// if the layout changes the file is rewritten as a whole; in
+// particular it has to shrink along with the chart
+//-------------------------------------------------------------
+void ProjectFileTest::binary_rewrites_file_on_layout_change()
+{
+  QString fileName = scratch_( "layout.sconchob" );
+
+  scene_->reset_grid( QSize( 20, 20 ) );
+  QVERIFY( save_( fileName ) );
+  qint64 largeSize = QFileInfo( fileName ).size();
+
+  load_v1_fixture_();
+  QVERIFY( save_( fileName ) );
+  QVERIFY( QFileInfo( fileName ).size() < largeSize );
+
+  boost::scoped_ptr<ProjectReader> reader( open_( fileName ) );
+  QVERIFY( reader.get() != 0 );
+  QVERIFY( reader->read() );
+  QVERIFY( same_chart( reader->get_chart(), scene_->chart_model() ) );
+}
+
+
+
+//-------------------------------------------------------------
+// cell records have to cover each row exactly once
+//-------------------------------------------------------------
+void ProjectFileTest::binary_rejects_corrupt_cells()
+{
+  load_v1_fixture_();
+
+  QString fileName = scratch_( "corrupt.sconchob" );
+  QVERIFY( save_( fileName ) );
+  QByteArray original = read_file( fileName );
+  QVERIFY( grid_records_offset_( original ) > 0 );
+
+  /* unpatched control */
+  QVERIFY( reads_patched_record_( fileName, original, 4, 0, WIDTH_FIELD,
+                                  1 ) );
+
+  /* a covered record at the start of a row */
+  QVERIFY( !reads_patched_record_( fileName, original, 0, 0, WIDTH_FIELD,
+                                   0 ) );
+
+  /* a chart cell starting inside the cable */
+  QVERIFY( !reads_patched_record_( fileName, original, 2, 0, WIDTH_FIELD,
+                                   1 ) );
+
+  /* a chart cell sticking out of the row */
+  QVERIFY( !reads_patched_record_( fileName, original, 4, 0, WIDTH_FIELD,
+                                   2 ) );
+  QVERIFY( !reads_patched_record_( fileName, original, 1, 0, WIDTH_FIELD,
+                                   0xffff ) );
+
+  /* the cable shrunk, leaving covered records behind */
+  QVERIFY( !reads_patched_record_( fileName, original, 1, 0, WIDTH_FIELD,
+                                   1 ) );
+
+  /* a symbol that isn't in the table */
+  QVERIFY( !reads_patched_record_( fileName, original, 0, 1, SYMBOL_FIELD,
+                                   0xffff ) );
+}
+
+
+
+//-------------------------------------------------------------
+// a binary file cut off anywhere is rejected
+//-------------------------------------------------------------
+void ProjectFileTest::binary_rejects_truncated_file()
+{
+  load_v1_fixture_();
+
+  QString fileName = scratch_( "truncated.sconchob" );
+  QVERIFY( save_( fileName ) );
+  QByteArray original = read_file( fileName );
+
+  for ( int size = 0; size < original.size(); ++size ) {
+    QVERIFY( write_file( fileName, original.left( size ) ) );
+    QVERIFY2( !reads_( fileName ),
+              qPrintable( QString( "accepted %1 of %2 bytes" )
+                          .arg( size ).arg( original.size() ) ) );
+  }
+}
+
+
+
+//-------------------------------------------------------------
+// the test files of the python version of sconcho are neither
+// XML nor our binary format and have to be rejected by both
+// readers
+//-------------------------------------------------------------
+void ProjectFileTest::rejects_legacy_python_files()
+{
+  QDir legacyDir( LEGACY_TEST_FILE_PATH );
+  QStringList legacyFiles =
+    legacyDir.entryList( QStringList( "*.spf" ), QDir::Files );
+  QVERIFY( !legacyFiles.isEmpty() );
+
+  QString binaryName = scratch_( "legacy.sconchob" );
+  foreach( QString name, legacyFiles ) {
+    QString fileName = legacyDir.filePath( name );
+    boost::scoped_ptr<ProjectReader> reader( open_( fileName ) );
+    QVERIFY( reader.get() != 0 );
+    QVERIFY2( !reader->read(), qPrintable( name ) );
+    QVERIFY( !reader->was_canceled() );
+
+    QVERIFY( write_file( binaryName, read_file( fileName ) ) );
+    QVERIFY2( !reads_( binaryName ), qPrintable( name ) );
+  }
+}
+
+
+
+/*************************************************************
+ *
+ * PRIVATE MEMBER FUNCTIONS
+ *
+ *************************************************************/
+
+//-------------------------------------------------------------
+// a fresh scratch file which is removed once we are done
+//-------------------------------------------------------------
+QString ProjectFileTest::scratch_( const QString& name )
+{
+  QString fileName = scratch_file( name );
+  QFile::remove( fileName );
+  if ( !scratchFiles_.contains( fileName ) ) {
+    scratchFiles_.push_back( fileName );
+  }
+
+  return fileName;
+}
+
+
+
+//-------------------------------------------------------------
+// create and initialize the reader for fileName; returns 0
+// on failure
+//-------------------------------------------------------------
+ProjectReader* ProjectFileTest::open_( const QString& fileName )
+{
+  const ProjectFormat* format = find_project_format( fileName );
+  if ( format == 0 ) {
+    return 0;
+  }
+
+  ProjectReader* reader =
+    format->create_reader( fileName, catalog_, *settings_ );
+  if ( !reader->Init() ) {
+    delete reader;
+    return 0;
+  }
+
+  return reader;
+}
+
+
+
+//-------------------------------------------------------------
+// returns true if fileName can be opened and read
+//-------------------------------------------------------------
+bool ProjectFileTest::reads_( const QString& fileName )
+{
+  boost::scoped_ptr<ProjectReader> reader( open_( fileName ) );
+  return reader.get() != 0 && reader->read();
+}
+
+
+
+//-------------------------------------------------------------
+// save the scene in the format matching the suffix of fileName
+//-------------------------------------------------------------
+bool ProjectFileTest::save_( const QString& fileName )
+{
+  const ProjectFormat* format = find_project_format( fileName );
+  if ( format == 0 ) {
+    return false;
+  }
+
+  boost::scoped_ptr<ProjectWriter> writer(
+    format->create_writer( scene_, projectColors_, *settings_, fileName ) );
+  return writer->Init() && writer->save();
+}
+
+
+
+//-------------------------------------------------------------
+// load the version 1 fixture into our scene
+//-------------------------------------------------------------
+void ProjectFileTest::load_v1_fixture_()
+{
+  boost::scoped_ptr<ProjectReader> reader(
+    open_( TEST_FILE_PATH + "/v1_chart.spf" ) );
+  QVERIFY( reader.get() != 0 );
+  QVERIFY( reader->read() );
+
+  scene_->load_new_canvas( reader->get_chart() );
+}
+
+
+
+//-------------------------------------------------------------
+// locate the cell records of the fixture chart in a binary
+// project; they make up the end of the grid section
+//-------------------------------------------------------------
+qint64 ProjectFileTest::grid_records_offset_( const QByteArray& data ) const
+{
+  QDataStream in( data );
+  in.setVersion( QDataStream::Qt_4_5 );
+
+  quint32 magic;
+  quint16 version;
+  quint16 numSections;
+  in >> magic >> version >> numSections;
+  for ( int index = 0; index < numSections; ++index ) {
+    quint32 id;
+    qint64 offset;
+    qint64 length;
+    in >> id >> offset >> length;
+    if ( in.status() == QDataStream::Ok && id == GRID_SECTION ) {
+      return offset + length
+             - FIXTURE_COLUMNS * FIXTURE_ROWS * BINARY_CELL_RECORD_SIZE;
+    }
+  }
+
+  return -1;
+}
+
+
+
+//-------------------------------------------------------------
+// write original with one field of the cell record at col, row
+// replaced by value to fileName and try to read it
+//-------------------------------------------------------------
+bool ProjectFileTest::reads_patched_record_( const QString& fileName,
+    const QByteArray& original, int col, int row, int field,
+    quint16 value )
+{
+  QByteArray data( original );
+  qint64 position = grid_records_offset_( data )
+                    + ( row * FIXTURE_COLUMNS + col ) * BINARY_CELL_RECORD_SIZE
+                    + field;
+  qToBigEndian<quint16>( value,
+                         reinterpret_cast<uchar*>( data.data() + position ) );
+
+  return write_file( fileName, data ) && reads_( fileName );
+}
+
+
+
+QT_END_NAMESPACE
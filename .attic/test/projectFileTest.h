@@ -0,0 +1,107 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef PROJECT_FILE_TEST_H
+#define PROJECT_FILE_TEST_H
+
+/* QT includes */
+#include <QByteArray>
+#include <QColor>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+/* local includes */
+#include "knittingSymbol.h"
+#include "symbolCatalog.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* forward declarations */
+class GraphicsScene;
+class ProjectReader;
+class QSettings;
+
+
+/***************************************************************
+ *
+ * ProjectFileTest saves and reads back charts in all project
+ * formats and feeds the readers corrupt and foreign files.
+ * The version 1 fixture lives in test/test_files, the files
+ * of the python version of sconcho in the top level
+ * test/test_files serve as foreign input.
+ *
+ ***************************************************************/
+class ProjectFileTest
+    :
+    public QObject
+{
+
+  Q_OBJECT
+
+
+private slots:
+
+  void initTestCase();
+  void cleanupTestCase();
+  void reads_v1_fixture();
+  void v1_items_must_not_overlap();
+  void v1_rejects_oversized_charts();
+  void xml_round_trip();
+  void xml_rejects_bad_charts();
+  void binary_round_trip();
+  void binary_rewrites_dirty_sections();
+  void binary_rewrites_file_on_layout_change();
+  void binary_rejects_corrupt_cells();
+  void binary_rejects_truncated_file();
+  void rejects_legacy_python_files();
+
+
+private:
+
+  SymbolCatalog catalog_;
+  KnittingSymbolPtr knit_;
+  KnittingSymbolPtr cable_;
+  QSettings* settings_;
+  GraphicsScene* scene_;
+  QList<QColor> projectColors_;
+
+  /* the scratch files we created */
+  QList<QString> scratchFiles_;
+
+  /* helper functions */
+  QString scratch_( const QString& name );
+  ProjectReader* open_( const QString& fileName );
+  bool reads_( const QString& fileName );
+  bool save_( const QString& fileName );
+  void load_v1_fixture_();
+  qint64 grid_records_offset_( const QByteArray& data ) const;
+  bool reads_patched_record_( const QString& fileName,
+                              const QByteArray& original, int col,
+                              int row, int field, quint16 value );
+};
+
+
+QT_END_NAMESPACE
+
+#endif
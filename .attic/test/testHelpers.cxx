@@ -0,0 +1,148 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QSize>
+
+/* local headers */
+#include "chartModel.h"
+#include "io.h"
+#include "symbolCatalog.h"
+#include "testConfig.h"
+#include "testHelpers.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+//---------------------------------------------------------------
+// create a knitting symbol that is not backed by an svg file
+//---------------------------------------------------------------
+KnittingSymbolPtr make_test_symbol( const QString& name, int width )
+{
+  return KnittingSymbolPtr( new KnittingSymbol( "", name, "test",
+                                                QSize( width, 1 ), "",
+                                                "" ) );
+}
+
+
+
+//---------------------------------------------------------------
+// load the knitting symbols shipped with sconcho
+//---------------------------------------------------------------
+void load_test_symbols( SymbolCatalog& catalog )
+{
+  foreach( ParsedSymbol symbol, load_symbols_from_path( TEST_SYMBOL_PATH ) ) {
+    catalog.insert( symbol.first );
+  }
+}
+
+
+
+//---------------------------------------------------------------
+// compare two charts cell by cell
+//---------------------------------------------------------------
+bool same_chart( const ChartModel& first, const ChartModel& second )
+{
+  if ( first.num_columns() != second.num_columns()
+       || first.num_rows() != second.num_rows() ) {
+    return false;
+  }
+
+  for ( int row = 0; row < first.num_rows(); ++row ) {
+    for ( int col = 0; col < first.num_columns(); ++col ) {
+      if ( first.origin_column( col, row ) != second.origin_column( col, row )
+           || first.width( col, row ) != second.width( col, row )
+           || first.symbol( col, row ) != second.symbol( col, row )
+           || first.color( col, row ) != second.color( col, row ) ) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+
+
+//---------------------------------------------------------------
+// copy all chart cells of source into target
+//---------------------------------------------------------------
+void copy_chart( const ChartModel& source, ChartModel& target )
+{
+  target.reset( source.num_columns(), source.num_rows() );
+  for ( int row = 0; row < source.num_rows(); ++row ) {
+    int col = 0;
+    while ( col < source.num_columns() ) {
+      int cellWidth = source.width( col, row );
+      target.set_cell( col, row, cellWidth, source.symbol( col, row ),
+                       QColor( source.color( col, row ) ) );
+      col += cellWidth;
+    }
+  }
+}
+
+
+
+//---------------------------------------------------------------
+// path of a scratch file in the temp directory
+//---------------------------------------------------------------
+QString scratch_file( const QString& name )
+{
+  return QDir::temp().filePath( "sconcho_test_" + name );
+}
+
+
+
+//---------------------------------------------------------------
+// read the whole content of a file
+//---------------------------------------------------------------
+QByteArray read_file( const QString& fileName )
+{
+  QFile file( fileName );
+  if ( !file.open( QFile::ReadOnly ) ) {
+    return QByteArray();
+  }
+
+  return file.readAll();
+}
+
+
+
+//---------------------------------------------------------------
+// replace the content of a file
+//---------------------------------------------------------------
+bool write_file( const QString& fileName, const QByteArray& data )
+{
+  QFile file( fileName );
+  if ( !file.open( QFile::WriteOnly | QFile::Truncate ) ) {
+    return false;
+  }
+
+  return file.write( data ) == data.size();
+}
+
+
+
+QT_END_NAMESPACE
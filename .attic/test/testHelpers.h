@@ -0,0 +1,90 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+/* QT includes */
+#include <QByteArray>
+#include <QString>
+
+/* local includes */
+#include "knittingSymbol.h"
+
+
+QT_BEGIN_NAMESPACE
+
+
+/* forward declarations */
+class ChartModel;
+class SymbolCatalog;
+
+
+
+//---------------------------------------------------------------
+// create a knitting symbol of the given width which is not
+// backed by an svg file; good enough for everything that
+// doesn't draw
+//---------------------------------------------------------------
+KnittingSymbolPtr make_test_symbol( const QString& name, int width = 1 );
+
+
+
+//---------------------------------------------------------------
+// load the knitting symbols shipped with sconcho
+//---------------------------------------------------------------
+void load_test_symbols( SymbolCatalog& catalog );
+
+
+
+//---------------------------------------------------------------
+// returns true if both charts have the same dimensions and
+// every unit cell belongs to a chart cell with the same origin,
+// width, symbol and color
+//---------------------------------------------------------------
+bool same_chart( const ChartModel& first, const ChartModel& second );
+
+
+
+//---------------------------------------------------------------
+// replace target by a cell for cell copy of source
+//---------------------------------------------------------------
+void copy_chart( const ChartModel& source, ChartModel& target );
+
+
+
+//---------------------------------------------------------------
+// path of a scratch file called name in the temp directory
+//---------------------------------------------------------------
+QString scratch_file( const QString& name );
+
+
+
+//---------------------------------------------------------------
+// read or replace the content of a file
+//---------------------------------------------------------------
+QByteArray read_file( const QString& fileName );
+bool write_file( const QString& fileName, const QByteArray& data );
+
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,76 @@
+/***************************************************************
+*
+* (c) 2009-2010 Markus Dittrich
+*
+* This program is free software; you can redistribute it
+* and/or modify it under the terms of the GNU General Public
+* License Version 3 as published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License Version 3 for more details.
+*
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the Free
+* Software Foundation, Inc., 59 Temple Place - Suite 330,
+* Boston, MA 02111-1307, USA.
+*
+****************************************************************/
+
+
+/* Qt headers */
+#include <QApplication>
+#include <QtTest>
+
+/* local headers */
+#include "chartClipboardTest.h"
+#include "chartModelTest.h"
+#include "chartSelectionTest.h"
+#include "editJournalTest.h"
+#include "floatingItemIndexTest.h"
+#include "graphicsSceneTest.h"
+#include "legendKeyTableTest.h"
+#include "projectFileTest.h"
+#include "symbolPixmapCache.h"
+
+
+//-------------------------------------------------------------
+// run all test classes and return the number of failures
+//-------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  QApplication app( argc, argv );
+
+  int failures = 0;
+  {
+    ChartModelTest chartModelTest;
+    failures += QTest::qExec( &chartModelTest, argc, argv );
+
+    LegendKeyTableTest legendKeyTableTest;
+    failures += QTest::qExec( &legendKeyTableTest, argc, argv );
+
+    ChartSelectionTest chartSelectionTest;
+    failures += QTest::qExec( &chartSelectionTest, argc, argv );
+
+    GraphicsSceneTest graphicsSceneTest;
+    failures += QTest::qExec( &graphicsSceneTest, argc, argv );
+
+    ChartClipboardTest chartClipboardTest;
+    failures += QTest::qExec( &chartClipboardTest, argc, argv );
+
+    EditJournalTest editJournalTest;
+    failures += QTest::qExec( &editJournalTest, argc, argv );
+
+    FloatingItemIndexTest floatingItemIndexTest;
+    failures += QTest::qExec( &floatingItemIndexTest, argc, argv );
+
+    ProjectFileTest projectFileTest;
+    failures += QTest::qExec( &projectFileTest, argc, argv );
+  }
+
+  /** pixmaps must not outlive the application object */
+  SymbolPixmapCache::instance().clear();
+
+  return failures;
+}